@@ -0,0 +1,94 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <array>
+#include "base58.hpp"
+
+namespace turbo::base58 {
+    namespace {
+        static constexpr std::string_view digits { "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz" };
+
+        // 0xFF marks the characters outside of the alphabet
+        static constexpr auto decode_map = [] {
+            std::array<uint8_t, 256> map {};
+            map.fill(0xFF);
+            for (uint8_t i = 0; i < 58; ++i)
+                map[static_cast<uint8_t>(digits[i])] = i;
+            return map;
+        }();
+    }
+
+    size_t encode_to(const std::span<char> out, const buffer data)
+    {
+        if (out.size() < max_encoded_size(data.size())) [[unlikely]]
+            throw error(fmt::format("base58 encoding of {} bytes needs {} characters but the output has only {}", data.size(), max_encoded_size(data.size()), out.size()));
+        size_t num_zeros = 0;
+        while (num_zeros < data.size() && data[num_zeros] == 0)
+            ++num_zeros;
+        // the digits are accumulated in place in the little-endian order, so that the number grows without shifts
+        auto *num = reinterpret_cast<uint8_t *>(out.data() + num_zeros);
+        size_t num_size = 0;
+        for (const auto b: data.subspan(num_zeros)) {
+            uint32_t carry = b;
+            for (size_t j = 0; j < num_size; ++j) {
+                carry += static_cast<uint32_t>(num[j]) << 8U;
+                num[j] = static_cast<uint8_t>(carry % 58);
+                carry /= 58;
+            }
+            for (; carry; carry /= 58)
+                num[num_size++] = static_cast<uint8_t>(carry % 58);
+        }
+        std::fill_n(out.data(), num_zeros, digits[0]);
+        std::reverse(num, num + num_size);
+        for (size_t j = 0; j < num_size; ++j)
+            num[j] = static_cast<uint8_t>(digits[num[j]]);
+        return num_zeros + num_size;
+    }
+
+    std::string encode(const buffer data)
+    {
+        std::string res(max_encoded_size(data.size()), '\0');
+        res.resize(encode_to(res, data));
+        return res;
+    }
+
+    size_t decode_to(const std::span<uint8_t> out, const std::string_view text)
+    {
+        const auto too_small = [&] {
+            return error(fmt::format("the output of {} bytes is too small for the decoded base58 text: {}", out.size(), text));
+        };
+        size_t num_zeros = 0;
+        while (num_zeros < text.size() && text[num_zeros] == digits[0])
+            ++num_zeros;
+        if (num_zeros > out.size()) [[unlikely]]
+            throw too_small();
+        auto *num = out.data() + num_zeros;
+        const auto max_num_size = out.size() - num_zeros;
+        size_t num_size = 0;
+        for (size_t i = num_zeros; i < text.size(); ++i) {
+            uint32_t carry = decode_map[static_cast<uint8_t>(text[i])];
+            if (carry == 0xFF) [[unlikely]]
+                throw error(fmt::format("invalid base58 character with code {} at position {}", static_cast<int>(static_cast<uint8_t>(text[i])), i));
+            for (size_t j = 0; j < num_size; ++j) {
+                carry += static_cast<uint32_t>(num[j]) * 58;
+                num[j] = static_cast<uint8_t>(carry);
+                carry >>= 8U;
+            }
+            for (; carry; carry >>= 8U) {
+                if (num_size == max_num_size) [[unlikely]]
+                    throw too_small();
+                num[num_size++] = static_cast<uint8_t>(carry);
+            }
+        }
+        std::fill_n(out.data(), num_zeros, uint8_t { 0 });
+        std::reverse(num, num + num_size);
+        return num_zeros + num_size;
+    }
+
+    uint8_vector decode(const std::string_view text)
+    {
+        uint8_vector res(max_decoded_size(text.size()));
+        res.resize(decode_to(res, text));
+        return res;
+    }
+}
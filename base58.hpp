@@ -0,0 +1,30 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <string>
+#include "bytes.hpp"
+
+// The Bitcoin alphabet, in which each leading zero byte becomes a leading '1'.
+// The conversion is quadratic in the input size, so the encoding suits short values such as keys and addresses.
+namespace turbo::base58 {
+    // an upper bound since log(256) / log(58) is less than 1.38
+    constexpr size_t max_encoded_size(const size_t num_bytes) noexcept
+    {
+        return num_bytes * 138 / 100 + 1;
+    }
+
+    // an upper bound reached by a text of only leading '1's; other texts decode to about 0.733 bytes per character
+    constexpr size_t max_decoded_size(const size_t num_chars) noexcept
+    {
+        return num_chars;
+    }
+
+    // out must have at least max_encoded_size(data.size()) characters; returns the number of characters written
+    extern size_t encode_to(std::span<char> out, buffer data);
+    extern std::string encode(buffer data);
+
+    // throws if out has too few bytes for the decoded value; returns the number of bytes written
+    extern size_t decode_to(std::span<uint8_t> out, std::string_view text);
+    extern uint8_vector decode(std::string_view text);
+}
@@ -0,0 +1,52 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <random>
+#include <turbo/common/test.hpp>
+#include "base58.hpp"
+
+namespace {
+    using namespace turbo;
+}
+
+suite turbo_common_base58_suite = [] {
+    "turbo::common::base58"_test = [] {
+        "vectors"_test = [] {
+            for (const auto &[hex, encoded]: std::initializer_list<std::pair<std::string_view, std::string_view>> {
+                { "", "" },
+                { "00", "1" },
+                { "000000287FB4CD", "111233QC4" },
+                { "48656C6C6F20576F726C6421", "2NEpo7TZRRrLZSi2U" },
+                { "00EB15231DFCEB60925886B67D065299925915AEB172C06647", "1NS17iag9jJgTHD1VXjvLCEnZuQ3rJDE9L" } })
+            {
+                const auto data = uint8_vector::from_hex(hex);
+                expect_equal(encoded, base58::encode(data), hex);
+                expect_equal(data, base58::decode(encoded), hex);
+            }
+        };
+        "round trip"_test = [] {
+            std::mt19937_64 gen { 58 };
+            for (size_t sz = 0; sz <= 100; ++sz) {
+                uint8_vector data(sz);
+                for (auto &b: data)
+                    b = static_cast<uint8_t>(gen());
+                // leading zeros take a separate path
+                for (size_t z = 0; z < std::min(sz, size_t { 3 }); ++z)
+                    data[z] = gen() % 2 ? 0 : data[z];
+                const auto text = base58::encode(data);
+                expect(text.size() <= base58::max_encoded_size(sz));
+                expect_equal(data, base58::decode(text), fmt::format("size {}", sz));
+            }
+            expect_equal(uint8_vector(4), base58::decode("1111"));
+        };
+        "invalid input"_test = [] {
+            for (const auto bad: { "0", "O", "I", "l", "abc+", " 1" })
+                expect(throws([&] { base58::decode(bad); })) << bad;
+            uint8_vector small(2);
+            expect(throws([&] { base58::decode_to(small, "2NEpo7TZRRrLZSi2U"); }));
+            expect(throws([&] { base58::decode_to(small, "111"); }));
+            std::string small_text(3, '?');
+            expect(throws([&] { base58::encode_to(small_text, uint8_vector(10, 0xFF)); }));
+        };
+    };
+};
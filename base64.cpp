@@ -0,0 +1,334 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <array>
+#include <cstring>
+#include "base64.hpp"
+
+#ifdef TURBO_SIMD_X86
+#   include <immintrin.h>
+#endif
+
+namespace turbo::base64 {
+    namespace {
+        static constexpr std::string_view standard_digits { "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/" };
+        static constexpr std::string_view url_digits { "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_" };
+
+        // 0xFF marks the characters outside of the alphabet
+        static constexpr auto make_decode_map(const std::string_view digits)
+        {
+            std::array<uint8_t, 256> map {};
+            map.fill(0xFF);
+            for (uint8_t i = 0; i < 64; ++i)
+                map[static_cast<uint8_t>(digits[i])] = i;
+            return map;
+        }
+
+        static constexpr auto standard_map = make_decode_map(standard_digits);
+        static constexpr auto url_map = make_decode_map(url_digits);
+
+        std::string_view digits_of(const alphabet a) noexcept
+        {
+            return a == alphabet::url ? url_digits : standard_digits;
+        }
+
+        void encode_scalar(char *out, const uint8_t *data, const size_t size, const alphabet a) noexcept
+        {
+            const auto *digits = digits_of(a).data();
+            size_t i = 0;
+            for (; i + 3 <= size; i += 3, out += 4) {
+                const uint32_t v = (uint32_t { data[i] } << 16U) | (uint32_t { data[i + 1] } << 8U) | data[i + 2];
+                out[0] = digits[v >> 18U];
+                out[1] = digits[(v >> 12U) & 0x3FU];
+                out[2] = digits[(v >> 6U) & 0x3FU];
+                out[3] = digits[v & 0x3FU];
+            }
+            if (i == size)
+                return;
+            const uint32_t v = (uint32_t { data[i] } << 16U) | (i + 1 < size ? uint32_t { data[i + 1] } << 8U : 0U);
+            out[0] = digits[v >> 18U];
+            out[1] = digits[(v >> 12U) & 0x3FU];
+            if (i + 1 < size)
+                out[2] = digits[(v >> 6U) & 0x3FU];
+            if (a == alphabet::standard) {
+                if (i + 1 == size)
+                    out[2] = '=';
+                out[3] = '=';
+            }
+        }
+
+        // text must be without padding; returns the number of bytes written
+        size_t decode_scalar(uint8_t *out, const std::string_view text, const size_t start, const alphabet a)
+        {
+            const auto &map = a == alphabet::url ? url_map : standard_map;
+            const auto bad_char = [&](const size_t pos) {
+                for (size_t j = pos; j < text.size(); ++j) {
+                    if (map[static_cast<uint8_t>(text[j])] == 0xFF)
+                        return error(fmt::format("invalid base64 character with code {} at position {}", static_cast<int>(static_cast<uint8_t>(text[j])), j));
+                }
+                return error(fmt::format("invalid base64 data at position {}", pos));
+            };
+            size_t i = start, o = 0;
+            for (; i + 4 <= text.size(); i += 4, o += 3) {
+                const auto d0 = map[static_cast<uint8_t>(text[i])];
+                const auto d1 = map[static_cast<uint8_t>(text[i + 1])];
+                const auto d2 = map[static_cast<uint8_t>(text[i + 2])];
+                const auto d3 = map[static_cast<uint8_t>(text[i + 3])];
+                if ((d0 | d1 | d2 | d3) & 0x80U) [[unlikely]]
+                    throw bad_char(i);
+                const uint32_t v = (uint32_t { d0 } << 18U) | (uint32_t { d1 } << 12U) | (uint32_t { d2 } << 6U) | d3;
+                out[o] = static_cast<uint8_t>(v >> 16U);
+                out[o + 1] = static_cast<uint8_t>(v >> 8U);
+                out[o + 2] = static_cast<uint8_t>(v);
+            }
+            switch (text.size() - i) {
+                case 0:
+                    break;
+                case 1:
+                    throw error(fmt::format("base64 text cannot have {} characters", text.size()));
+                case 2: {
+                    const auto d0 = map[static_cast<uint8_t>(text[i])];
+                    const auto d1 = map[static_cast<uint8_t>(text[i + 1])];
+                    if ((d0 | d1) & 0x80U) [[unlikely]]
+                        throw bad_char(i);
+                    if (d1 & 0x0FU) [[unlikely]]
+                        throw error(fmt::format("base64 text has non-zero trailing bits at position {}", i + 1));
+                    out[o++] = static_cast<uint8_t>((d0 << 2U) | (d1 >> 4U));
+                    break;
+                }
+                case 3: {
+                    const auto d0 = map[static_cast<uint8_t>(text[i])];
+                    const auto d1 = map[static_cast<uint8_t>(text[i + 1])];
+                    const auto d2 = map[static_cast<uint8_t>(text[i + 2])];
+                    if ((d0 | d1 | d2) & 0x80U) [[unlikely]]
+                        throw bad_char(i);
+                    if (d2 & 0x03U) [[unlikely]]
+                        throw error(fmt::format("base64 text has non-zero trailing bits at position {}", i + 2));
+                    out[o++] = static_cast<uint8_t>((d0 << 2U) | (d1 >> 4U));
+                    out[o++] = static_cast<uint8_t>((d1 << 4U) | (d2 >> 2U));
+                    break;
+                }
+                default: std::unreachable();
+            }
+            return o;
+        }
+
+#ifdef TURBO_SIMD_X86
+        // The kernels process whole blocks and leave the tails and the error reporting to the scalar code.
+        // The 16-character steps are always inlined for the same reason as in hex.cpp: to stay in VEX encoding
+        // when called from the AVX2 kernel.
+
+        // the 6-bit indices in the bytes of each 32-bit word; the method is by Wojciech Muła
+        __attribute__((target("sse4.1"), always_inline))
+        inline __m128i encode_unpack_sse41(const __m128i in) noexcept
+        {
+            const auto x = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+            const auto t0 = _mm_mulhi_epu16(_mm_and_si128(x, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+            const auto t1 = _mm_mullo_epi16(_mm_and_si128(x, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+            return _mm_or_si128(t0, t1);
+        }
+
+        // maps the ranges 0-25, 26-51, 52-61, 62 and 63 to the offsets of their characters
+        __attribute__((target("sse4.1"), always_inline))
+        inline __m128i encode_translate_sse41(const __m128i idx, const __m128i offsets) noexcept
+        {
+            auto range = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+            range = _mm_sub_epi8(range, _mm_cmpgt_epi8(idx, _mm_set1_epi8(25)));
+            return _mm_add_epi8(idx, _mm_shuffle_epi8(offsets, range));
+        }
+
+        __attribute__((target("sse4.1"), always_inline))
+        inline size_t encode_sse41_steps(char *out, const uint8_t *data, const size_t size, const __m128i offsets) noexcept
+        {
+            // each step reads 16 bytes and encodes the first 12 of them
+            size_t i = 0;
+            for (; i + 16 <= size; i += 12, out += 16) {
+                const auto idx = encode_unpack_sse41(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out), encode_translate_sse41(idx, offsets));
+            }
+            return i;
+        }
+
+        __attribute__((target("sse4.1"), always_inline))
+        inline __m128i encode_offsets_sse41(const alphabet a) noexcept
+        {
+            const auto d = digits_of(a);
+            return _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4,
+                static_cast<char>(d[62] - 62), static_cast<char>(d[63] - 63), 0, 0);
+        }
+
+        __attribute__((target("sse4.1")))
+        size_t encode_sse41(char *out, const uint8_t *data, const size_t size, const alphabet a) noexcept
+        {
+            return encode_sse41_steps(out, data, size, encode_offsets_sse41(a));
+        }
+
+        __attribute__((target("sse4.1"), always_inline))
+        inline bool decode16_sse41(uint8_t *out, const char *text, const char c62, const char c63) noexcept
+        {
+            const auto c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text));
+            const auto upper = _mm_sub_epi8(c, _mm_set1_epi8('A'));
+            const auto lower = _mm_sub_epi8(c, _mm_set1_epi8('a'));
+            const auto digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+            const auto is_upper = _mm_cmpeq_epi8(_mm_min_epu8(upper, _mm_set1_epi8(25)), upper);
+            const auto is_lower = _mm_cmpeq_epi8(_mm_min_epu8(lower, _mm_set1_epi8(25)), lower);
+            const auto is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+            const auto is_62 = _mm_cmpeq_epi8(c, _mm_set1_epi8(c62));
+            const auto is_63 = _mm_cmpeq_epi8(c, _mm_set1_epi8(c63));
+            const auto valid = _mm_or_si128(_mm_or_si128(_mm_or_si128(is_upper, is_lower), _mm_or_si128(is_digit, is_62)), is_63);
+            if (_mm_movemask_epi8(valid) != 0xFFFF) [[unlikely]]
+                return false;
+            auto v = _mm_and_si128(is_upper, upper);
+            v = _mm_or_si128(v, _mm_and_si128(is_lower, _mm_add_epi8(lower, _mm_set1_epi8(26))));
+            v = _mm_or_si128(v, _mm_and_si128(is_digit, _mm_add_epi8(digit, _mm_set1_epi8(52))));
+            v = _mm_or_si128(v, _mm_and_si128(is_62, _mm_set1_epi8(62)));
+            v = _mm_or_si128(v, _mm_and_si128(is_63, _mm_set1_epi8(63)));
+            // merges the 6-bit values into 24-bit words and then compacts them into 12 bytes
+            const auto pairs = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+            const auto words = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+            const auto packed = _mm_shuffle_epi8(words, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(out), packed);
+            const auto last = static_cast<uint32_t>(_mm_extract_epi32(packed, 2));
+            memcpy(out + 8, &last, sizeof(last));
+            return true;
+        }
+
+        // returns the number of characters decoded, which stops at the first block with an invalid character
+        __attribute__((target("sse4.1")))
+        size_t decode_sse41(uint8_t *out, const char *text, const size_t size, const alphabet a) noexcept
+        {
+            const auto d = digits_of(a);
+            size_t i = 0;
+            for (; i + 16 <= size && decode16_sse41(out, text + i, d[62], d[63]); i += 16, out += 12) {
+            }
+            return i;
+        }
+
+        __attribute__((target("avx2")))
+        size_t encode_avx2(char *out, const uint8_t *data, const size_t size, const alphabet a) noexcept
+        {
+            const auto offsets128 = encode_offsets_sse41(a);
+            const auto offsets = _mm256_broadcastsi128_si256(offsets128);
+            const auto shuffle = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+                10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+            size_t i = 0;
+            // each step reads 28 bytes and encodes 24 of them, 12 per lane
+            for (; i + 28 <= size; i += 24, out += 32) {
+                const auto lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+                const auto hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 12));
+                const auto x = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), shuffle);
+                const auto t0 = _mm256_mulhi_epu16(_mm256_and_si256(x, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+                const auto t1 = _mm256_mullo_epi16(_mm256_and_si256(x, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+                const auto idx = _mm256_or_si256(t0, t1);
+                auto range = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+                range = _mm256_sub_epi8(range, _mm256_cmpgt_epi8(idx, _mm256_set1_epi8(25)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_add_epi8(idx, _mm256_shuffle_epi8(offsets, range)));
+            }
+            return i + encode_sse41_steps(out, data + i, size - i, offsets128);
+        }
+
+        __attribute__((target("avx2")))
+        size_t decode_avx2(uint8_t *out, const char *text, const size_t size, const alphabet a) noexcept
+        {
+            const auto d = digits_of(a);
+            const auto c62 = _mm256_set1_epi8(d[62]);
+            const auto c63 = _mm256_set1_epi8(d[63]);
+            size_t i = 0;
+            for (; i + 32 <= size; i += 32, out += 24) {
+                const auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + i));
+                const auto upper = _mm256_sub_epi8(c, _mm256_set1_epi8('A'));
+                const auto lower = _mm256_sub_epi8(c, _mm256_set1_epi8('a'));
+                const auto digit = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+                const auto is_upper = _mm256_cmpeq_epi8(_mm256_min_epu8(upper, _mm256_set1_epi8(25)), upper);
+                const auto is_lower = _mm256_cmpeq_epi8(_mm256_min_epu8(lower, _mm256_set1_epi8(25)), lower);
+                const auto is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+                const auto is_62 = _mm256_cmpeq_epi8(c, c62);
+                const auto is_63 = _mm256_cmpeq_epi8(c, c63);
+                const auto valid = _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(is_upper, is_lower), _mm256_or_si256(is_digit, is_62)), is_63);
+                if (_mm256_movemask_epi8(valid) != -1) [[unlikely]]
+                    return i;
+                auto v = _mm256_and_si256(is_upper, upper);
+                v = _mm256_or_si256(v, _mm256_and_si256(is_lower, _mm256_add_epi8(lower, _mm256_set1_epi8(26))));
+                v = _mm256_or_si256(v, _mm256_and_si256(is_digit, _mm256_add_epi8(digit, _mm256_set1_epi8(52))));
+                v = _mm256_or_si256(v, _mm256_and_si256(is_62, _mm256_set1_epi8(62)));
+                v = _mm256_or_si256(v, _mm256_and_si256(is_63, _mm256_set1_epi8(63)));
+                const auto pairs = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+                const auto words = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+                const auto lanes = _mm256_shuffle_epi8(words, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                    2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+                const auto packed = _mm256_permutevar8x32_epi32(lanes, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm256_castsi256_si128(packed));
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(out + 16), _mm256_extracti128_si256(packed, 1));
+            }
+            for (; i + 16 <= size && decode16_sse41(out, text + i, d[62], d[63]); i += 16, out += 12) {
+            }
+            return i;
+        }
+#endif
+    }
+
+    size_t encode_to(const std::span<char> out, const buffer data, const alphabet a, const isa i)
+    {
+        const auto num_chars = encoded_size(data.size(), a);
+        if (out.size() < num_chars) [[unlikely]]
+            throw error(fmt::format("base64 encoding of {} bytes needs {} characters but the output has only {}", data.size(), num_chars, out.size()));
+        size_t done = 0;
+        switch (i) {
+#ifdef TURBO_SIMD_X86
+            // 512-bit registers bring no gain over AVX2 here since the kernels are bound by the shuffles
+            case isa::avx512:
+            case isa::avx2: done = encode_avx2(out.data(), data.data(), data.size(), a); break;
+            case isa::sse41: done = encode_sse41(out.data(), data.data(), data.size(), a); break;
+#endif
+            default: break;
+        }
+        encode_scalar(out.data() + done / 3 * 4, data.data() + done, data.size() - done, a);
+        return num_chars;
+    }
+
+    size_t encode_to(const std::span<char> out, const buffer data, const alphabet a)
+    {
+        return encode_to(out, data, a, simd::best_isa());
+    }
+
+    std::string encode(const buffer data, const alphabet a)
+    {
+        std::string res(encoded_size(data.size(), a), '\0');
+        encode_to(res, data, a);
+        return res;
+    }
+
+    size_t decode_to(const std::span<uint8_t> out, std::string_view text, const alphabet a, const isa i)
+    {
+        if (text.ends_with('=')) {
+            if (text.size() % 4 != 0) [[unlikely]]
+                throw error(fmt::format("padded base64 text must have a multiple of four characters but has {}", text.size()));
+            text.remove_suffix(text.ends_with("==") ? 2 : 1);
+        }
+        const auto num_bytes = max_decoded_size(text.size());
+        if (out.size() < num_bytes) [[unlikely]]
+            throw error(fmt::format("base64 text of {} characters needs {} bytes but the output has only {}", text.size(), num_bytes, out.size()));
+        size_t done = 0;
+        switch (i) {
+#ifdef TURBO_SIMD_X86
+            case isa::avx512:
+            case isa::avx2: done = decode_avx2(out.data(), text.data(), text.size(), a); break;
+            case isa::sse41: done = decode_sse41(out.data(), text.data(), text.size(), a); break;
+#endif
+            default: break;
+        }
+        return done / 4 * 3 + decode_scalar(out.data() + done / 4 * 3, text, done, a);
+    }
+
+    size_t decode_to(const std::span<uint8_t> out, const std::string_view text, const alphabet a)
+    {
+        return decode_to(out, text, a, simd::best_isa());
+    }
+
+    uint8_vector decode(const std::string_view text, const alphabet a)
+    {
+        uint8_vector res(max_decoded_size(text.size()));
+        res.resize(decode_to(res, text, a));
+        return res;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <string>
+#include "bytes.hpp"
+#include "simd.hpp"
+
+namespace turbo::base64 {
+    using simd::isa;
+
+    enum class alphabet {
+        standard, // RFC 4648 section 4, padded with '='
+        url       // RFC 4648 section 5, unpadded as in JWT and URLs
+    };
+
+    constexpr size_t encoded_size(const size_t num_bytes, const alphabet a=alphabet::standard) noexcept
+    {
+        if (a == alphabet::standard)
+            return (num_bytes + 2) / 3 * 4;
+        return num_bytes / 3 * 4 + (num_bytes % 3 * 4 + 2) / 3;
+    }
+
+    // exact for unpadded text and an upper bound for padded text
+    constexpr size_t max_decoded_size(const size_t num_chars) noexcept
+    {
+        return num_chars / 4 * 3 + num_chars % 4 * 3 / 4;
+    }
+
+    // out must have at least encoded_size(data.size(), a) characters; returns the number of characters written
+    extern size_t encode_to(std::span<char> out, buffer data, alphabet a=alphabet::standard);
+    extern size_t encode_to(std::span<char> out, buffer data, alphabet a, isa i);
+    extern std::string encode(buffer data, alphabet a=alphabet::standard);
+
+    // Accepts text with or without padding in either alphabet variant selected by a. Throws on characters
+    // outside of the alphabet, on a broken padding and on non-zero trailing bits, so that each byte sequence
+    // has exactly one accepted encoding. out must have at least max_decoded_size(text.size()) bytes.
+    // Returns the number of bytes written.
+    extern size_t decode_to(std::span<uint8_t> out, std::string_view text, alphabet a=alphabet::standard);
+    extern size_t decode_to(std::span<uint8_t> out, std::string_view text, alphabet a, isa i);
+    extern uint8_vector decode(std::string_view text, alphabet a=alphabet::standard);
+}
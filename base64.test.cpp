@@ -0,0 +1,86 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <random>
+#include <turbo/common/test.hpp>
+#include "base64.hpp"
+
+namespace {
+    using namespace turbo;
+}
+
+suite turbo_common_base64_suite = [] {
+    "turbo::common::base64"_test = [] {
+        const auto isas = { base64::isa::scalar, base64::isa::sse41, base64::isa::avx2, base64::isa::avx512 };
+        const auto alphabets = { base64::alphabet::standard, base64::alphabet::url };
+        "RFC 4648 vectors"_test = [] {
+            for (const auto &[plain, encoded]: std::initializer_list<std::pair<std::string_view, std::string_view>> {
+                { "", "" }, { "f", "Zg==" }, { "fo", "Zm8=" }, { "foo", "Zm9v" },
+                { "foob", "Zm9vYg==" }, { "fooba", "Zm9vYmE=" }, { "foobar", "Zm9vYmFy" } })
+            {
+                const buffer data { reinterpret_cast<const uint8_t *>(plain.data()), plain.size() };
+                expect_equal(encoded, base64::encode(data), plain);
+                expect_equal(uint8_vector { data }, base64::decode(encoded), plain);
+                auto unpadded = std::string { encoded };
+                while (unpadded.ends_with('='))
+                    unpadded.pop_back();
+                expect_equal(unpadded, base64::encode(data, base64::alphabet::url), plain);
+                expect_equal(uint8_vector { data }, base64::decode(unpadded), plain);
+            }
+            const auto bytes = uint8_vector::from_hex("FBFF3E");
+            expect_equal(std::string_view { "+/8+" }, base64::encode(bytes));
+            expect_equal(std::string_view { "-_8-" }, base64::encode(bytes, base64::alphabet::url));
+            expect_equal(bytes, base64::decode("-_8-", base64::alphabet::url));
+            expect(throws([] { base64::decode("-_8-"); }));
+        };
+        "round trip"_test = [&] {
+            std::mt19937_64 gen { 42 };
+            uint8_vector data(1000);
+            for (auto &b: data)
+                b = static_cast<uint8_t>(gen());
+            for (const auto a: alphabets) {
+                // sizes around the block boundaries of every kernel
+                for (size_t sz = 0; sz <= 200; ++sz) {
+                    const auto in = static_cast<buffer>(data).subbuf(sz, sz);
+                    const auto reference = base64::encode(in, a);
+                    for (const auto i: isas) {
+                        if (!simd::supported(i))
+                            continue;
+                        std::string text(base64::encoded_size(sz, a), '?');
+                        expect_equal(text.size(), base64::encode_to(text, in, a, i));
+                        expect_equal(reference, text, fmt::format("encode isa {} size {}", static_cast<int>(i), sz));
+                        uint8_vector out(base64::max_decoded_size(text.size()));
+                        const auto num_bytes = base64::decode_to(out, text, a, i);
+                        out.resize(num_bytes);
+                        expect_equal(in, out, fmt::format("decode isa {} size {}", static_cast<int>(i), sz));
+                    }
+                }
+            }
+        };
+        "invalid input"_test = [&] {
+            std::mt19937_64 gen { 7 };
+            uint8_vector data(150);
+            for (auto &b: data)
+                b = static_cast<uint8_t>(gen());
+            const auto text = base64::encode(data);
+            for (const auto i: isas) {
+                if (!simd::supported(i))
+                    continue;
+                for (size_t pos = 0; pos < text.size() - 2; pos += 3) {
+                    for (const auto bad: { '=', '-', '_', '.', ' ', '\0', '\xFF', '@', '[', '`', '{' }) {
+                        auto broken = text;
+                        broken[pos] = bad;
+                        uint8_vector out(base64::max_decoded_size(broken.size()));
+                        expect(throws([&] { base64::decode_to(out, broken, base64::alphabet::standard, i); })) << static_cast<int>(i) << pos << static_cast<int>(bad);
+                    }
+                }
+            }
+            for (const auto bad: { "A", "AAAAA", "A===", "AA=", "AAAA====", "AB==", "AAB=", "=AAA" })
+                expect(throws([&] { base64::decode(bad); })) << bad;
+            uint8_vector small(2);
+            expect(throws([&] { base64::decode_to(small, "AAAA"); }));
+            std::string small_text(3, '?');
+            expect(throws([&] { base64::encode_to(small_text, data); }));
+        };
+    };
+};
@@ -0,0 +1,172 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <array>
+#include "bech32.hpp"
+
+namespace turbo::bech32 {
+    namespace {
+        static constexpr std::string_view charset { "qpzry9x8gf2tvdw0s3jn54khce6mua7l" };
+
+        // 0xFF marks the characters outside of the charset; the uppercase characters map to the same values
+        static constexpr auto decode_map = [] {
+            std::array<uint8_t, 256> map {};
+            map.fill(0xFF);
+            for (uint8_t i = 0; i < 32; ++i) {
+                const auto k = static_cast<uint8_t>(charset[i]);
+                map[k] = i;
+                if (k >= 'a' && k <= 'z')
+                    map[k - 'a' + 'A'] = i;
+            }
+            return map;
+        }();
+
+        constexpr uint32_t checksum_constant(const variant v) noexcept
+        {
+            return v == variant::bech32m ? 0x2BC830A3U : 1U;
+        }
+
+        constexpr char lower(const char k) noexcept
+        {
+            return k >= 'A' && k <= 'Z' ? static_cast<char>(k - 'A' + 'a') : k;
+        }
+
+        // the BCH code computed incrementally, so that no expanded copy of the input is needed
+        struct polymod {
+            void add(const uint8_t v) noexcept
+            {
+                const auto top = _chk >> 25U;
+                _chk = ((_chk & 0x1FFFFFFU) << 5U) ^ v;
+                for (size_t i = 0; i < gen.size(); ++i) {
+                    if ((top >> i) & 1U)
+                        _chk ^= gen[i];
+                }
+            }
+
+            void add_hrp(const std::string_view hrp) noexcept
+            {
+                for (const auto k: hrp)
+                    add(static_cast<uint8_t>(lower(k)) >> 5U);
+                add(0);
+                for (const auto k: hrp)
+                    add(static_cast<uint8_t>(lower(k)) & 0x1FU);
+            }
+
+            [[nodiscard]] uint32_t value() const noexcept
+            {
+                return _chk;
+            }
+        private:
+            static constexpr std::array<uint32_t, 5> gen { 0x3B6A57B2U, 0x26508E6DU, 0x1EA119FAU, 0x3D4233DDU, 0x2A1462B3U };
+            uint32_t _chk = 1;
+        };
+
+        void validate_hrp(const std::string_view hrp)
+        {
+            if (hrp.empty() || hrp.size() > max_hrp_size) [[unlikely]]
+                throw error(fmt::format("the human-readable part of bech32 must have from 1 to {} characters but has {}", max_hrp_size, hrp.size()));
+            for (const auto k: hrp) {
+                if (k < 33 || k > 126) [[unlikely]]
+                    throw error(fmt::format("invalid character with code {} in the human-readable part of bech32", static_cast<int>(static_cast<uint8_t>(k))));
+            }
+        }
+    }
+
+    size_t encode_to(const std::span<char> out, const std::string_view hrp, const buffer data, const variant v)
+    {
+        validate_hrp(hrp);
+        const auto num_chars = encoded_size(hrp.size(), data.size());
+        if (out.size() < num_chars) [[unlikely]]
+            throw error(fmt::format("bech32 encoding of {} bytes needs {} characters but the output has only {}", data.size(), num_chars, out.size()));
+        polymod chk {};
+        chk.add_hrp(hrp);
+        auto *o = std::transform(hrp.begin(), hrp.end(), out.data(), lower);
+        *o++ = '1';
+        const auto emit = [&](const uint8_t d) {
+            chk.add(d);
+            *o++ = charset[d];
+        };
+        uint32_t acc = 0;
+        uint32_t num_bits = 0;
+        for (const auto b: data) {
+            acc = (acc << 8U) | b;
+            num_bits += 8;
+            for (; num_bits >= 5; num_bits -= 5)
+                emit(static_cast<uint8_t>((acc >> (num_bits - 5)) & 0x1FU));
+        }
+        if (num_bits)
+            emit(static_cast<uint8_t>((acc << (5 - num_bits)) & 0x1FU));
+        for (size_t i = 0; i < checksum_size; ++i)
+            chk.add(0);
+        const auto mod = chk.value() ^ checksum_constant(v);
+        for (size_t i = 0; i < checksum_size; ++i)
+            *o++ = charset[(mod >> (5 * (checksum_size - 1 - i))) & 0x1FU];
+        return num_chars;
+    }
+
+    std::string encode(const std::string_view hrp, const buffer data, const variant v)
+    {
+        std::string res(encoded_size(hrp.size(), data.size()), '\0');
+        encode_to(res, hrp, data, v);
+        return res;
+    }
+
+    decode_result decode_to(const std::span<uint8_t> out, const std::string_view text)
+    {
+        const auto sep_pos = text.rfind('1');
+        if (sep_pos == std::string_view::npos) [[unlikely]]
+            throw error(fmt::format("bech32 text has no separator: {}", text));
+        const auto hrp = text.substr(0, sep_pos);
+        validate_hrp(hrp);
+        const auto payload = text.substr(sep_pos + 1);
+        if (payload.size() < checksum_size) [[unlikely]]
+            throw error(fmt::format("bech32 text is too short to contain a checksum: {}", text));
+        if (out.size() < max_decoded_size(payload.size() - checksum_size)) [[unlikely]]
+            throw error(fmt::format("bech32 text needs {} bytes but the output has only {}", max_decoded_size(payload.size() - checksum_size), out.size()));
+        bool has_lower = false, has_upper = false;
+        for (const auto k: text) {
+            has_lower |= k >= 'a' && k <= 'z';
+            has_upper |= k >= 'A' && k <= 'Z';
+        }
+        if (has_lower && has_upper) [[unlikely]]
+            throw error(fmt::format("bech32 text must not mix upper and lower case: {}", text));
+        polymod chk {};
+        chk.add_hrp(hrp);
+        size_t num_bytes = 0;
+        uint32_t acc = 0;
+        uint32_t num_bits = 0;
+        for (size_t i = 0; i < payload.size(); ++i) {
+            const auto d = decode_map[static_cast<uint8_t>(payload[i])];
+            if (d == 0xFF) [[unlikely]]
+                throw error(fmt::format("invalid bech32 character with code {} at position {}", static_cast<int>(static_cast<uint8_t>(payload[i])), sep_pos + 1 + i));
+            chk.add(d);
+            if (i + checksum_size < payload.size()) {
+                acc = ((acc << 5U) | d) & 0xFFFU;
+                num_bits += 5;
+                if (num_bits >= 8) {
+                    num_bits -= 8;
+                    out[num_bytes++] = static_cast<uint8_t>(acc >> num_bits);
+                }
+            }
+        }
+        if (num_bits >= 5 || (acc & ((1U << num_bits) - 1U))) [[unlikely]]
+            throw error(fmt::format("bech32 text has invalid padding bits: {}", text));
+        for (const auto v: { variant::bech32, variant::bech32m }) {
+            if (chk.value() == checksum_constant(v))
+                return { hrp, num_bytes, v };
+        }
+        throw error(fmt::format("bech32 text has an invalid checksum: {}", text));
+    }
+
+    decoded decode(const std::string_view text)
+    {
+        decoded res {};
+        res.data.resize_uninitialized(max_decoded_size(text.size()));
+        const auto r = decode_to(res.data, text);
+        res.data.resize_uninitialized(r.size);
+        res.hrp.resize(r.hrp.size());
+        std::transform(r.hrp.begin(), r.hrp.end(), res.hrp.begin(), lower);
+        res.v = r.v;
+        return res;
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <string>
+#include "inline-bytes.hpp"
+
+// BIP-173 bech32 and BIP-350 bech32m with 8-bit payloads as used for Cardano addresses and keys.
+// The 90-character limit of BIP-173 is not enforced since Cardano addresses routinely exceed it.
+namespace turbo::bech32 {
+    enum class variant {
+        bech32,
+        bech32m
+    };
+
+    static constexpr size_t checksum_size = 6;
+    static constexpr size_t max_hrp_size = 83;
+
+    constexpr size_t encoded_size(const size_t hrp_size, const size_t num_bytes) noexcept
+    {
+        return hrp_size + 1 + (num_bytes * 8 + 4) / 5 + checksum_size;
+    }
+
+    // an upper bound for a text with the given number of characters
+    constexpr size_t max_decoded_size(const size_t num_chars) noexcept
+    {
+        return num_chars * 5 / 8;
+    }
+
+    // The human-readable part is written in lowercase. out must have at least
+    // encoded_size(hrp.size(), data.size()) characters. Returns the number of characters written.
+    extern size_t encode_to(std::span<char> out, std::string_view hrp, buffer data, variant v=variant::bech32);
+    extern std::string encode(std::string_view hrp, buffer data, variant v=variant::bech32);
+
+    struct decode_result {
+        // refers to the decoded text, so it is in uppercase if the text is
+        std::string_view hrp;
+        size_t size;
+        variant v;
+    };
+
+    // Accepts either variant and reports the one whose checksum matched. Throws on invalid characters,
+    // mixed case, a wrong checksum and non-zero padding bits. out must have at least max_decoded_size(text.size()) bytes.
+    extern decode_result decode_to(std::span<uint8_t> out, std::string_view text);
+
+    struct decoded {
+        std::string hrp;
+        // fits the 57-byte Cardano base addresses, so decoding an address does not allocate
+        inline_bytes<64> data;
+        variant v;
+    };
+
+    // the human-readable part is returned in lowercase
+    extern decoded decode(std::string_view text);
+}
@@ -0,0 +1,79 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <random>
+#include <turbo/common/test.hpp>
+#include "bech32.hpp"
+
+namespace {
+    using namespace turbo;
+}
+
+suite turbo_common_bech32_suite = [] {
+    "turbo::common::bech32"_test = [] {
+        "vectors"_test = [] {
+            for (const auto &[text, hrp, hex, v]: std::initializer_list<std::tuple<std::string_view, std::string_view, std::string_view, bech32::variant>> {
+                { "a12uel5l", "a", "", bech32::variant::bech32 },
+                { "abcdef1qpzry9x8gf2tvdw0s3jn54khce6mua7lmqqqxw", "abcdef", "00443214C74254B635CF84653A56D7C675BE77DF", bech32::variant::bech32 },
+                { "a1lqfn3a", "a", "", bech32::variant::bech32m },
+                { "abcdef1l7aum6echk45nj3s0wdvt2fg8x9yrzpqzd3ryx", "abcdef", "FFBBCDEB38BDAB49CA307B9AC5A928398A418820", bech32::variant::bech32m },
+                // a Cardano stake address from CIP-19
+                { "stake1uyehkck0lajq8gr28t9uxnuvgcqrc6070x3k9r8048z8y5gh6ffgw", "stake", "E1337B62CFFF6403A06A3ACBC34F8C46003C69FE79A3628CEFA9C47251", bech32::variant::bech32 } })
+            {
+                const auto data = uint8_vector::from_hex(hex);
+                const auto res = bech32::decode(text);
+                expect_equal(hrp, res.hrp, text);
+                expect_equal(buffer { data }, buffer { res.data }, text);
+                expect(res.data.is_inline());
+                expect(res.v == v) << text;
+                expect_equal(text, bech32::encode(hrp, data, v), text);
+            }
+            const auto upper = bech32::decode("A12UEL5L");
+            expect_equal(std::string_view { "a" }, upper.hrp);
+            expect(upper.data.empty());
+            expect_equal(std::string_view { "a12uel5l" }, bech32::encode("A", buffer {}));
+        };
+        "round trip"_test = [] {
+            std::mt19937_64 gen { 32 };
+            for (size_t sz = 0; sz <= 100; ++sz) {
+                uint8_vector data(sz);
+                for (auto &b: data)
+                    b = static_cast<uint8_t>(gen());
+                for (const auto v: { bech32::variant::bech32, bech32::variant::bech32m }) {
+                    std::string text(bech32::encoded_size(4, sz), '?');
+                    expect_equal(text.size(), bech32::encode_to(text, "addr", data, v));
+                    uint8_vector out(bech32::max_decoded_size(text.size()));
+                    const auto res = bech32::decode_to(out, text);
+                    out.resize(res.size);
+                    expect_equal(data, out, fmt::format("size {}", sz));
+                    expect_equal(std::string_view { "addr" }, res.hrp);
+                    expect(res.v == v);
+                    // a single substituted character is always detected
+                    if (sz > 0 && sz <= 50) {
+                        auto broken = text;
+                        const auto pos = 5 + gen() % (broken.size() - 5);
+                        broken[pos] = broken[pos] == 'q' ? 'p' : 'q';
+                        expect(throws([&] { bech32::decode(broken); })) << broken;
+                    }
+                }
+            }
+        };
+        "invalid input"_test = [] {
+            for (const auto bad: {
+                "a12uEL5L",                 // mixed case
+                "a12uel5m",                 // wrong checksum
+                "12uel5l",                  // empty human-readable part
+                "a1uel5l",                  // too short for a checksum
+                "a12ubl5l",                 // invalid character
+                "a12uel5l\x7f",             // invalid character
+                "pzry9x0s0muk",             // no separator
+                "a\x1f" "12uel5l"           // invalid character in the human-readable part
+            }) {
+                expect(throws([&] { bech32::decode(bad); })) << bad;
+            }
+            uint8_vector small(2);
+            expect(throws([&] { bech32::decode_to(small, "abcdef1qpzry9x8gf2tvdw0s3jn54khce6mua7lmqqqxw"); }));
+            expect(throws([&] { bech32::encode("", buffer {}); }));
+        };
+    };
+};
@@ -1,8 +1,9 @@
 #pragma once
 /* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
- * Copyright (c) 2024-2025 R2 Rationality OÜ (info at r2rationality dot com) */
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
 
 #include <nanobench.h>
+#include "memory.hpp"
 #include "test.hpp"
 
 namespace turbo {
@@ -15,8 +16,30 @@ namespace turbo {
             .performanceCounters(true)
             .relative(true)
             .batch(batch_size);
+        const auto run_action = [&] {
+            if constexpr (std::is_void_v<decltype(action())>) {
+                action();
+            } else {
+                ankerl::nanobench::doNotOptimizeAway(action());
+            }
+        };
+        memory::alloc_stats allocs {};
+        size_t num_runs = 0;
+        // the allocation bookkeeping is compiled in only with tracking, so that it does not distort the timings otherwise
         b.run("benchmark",[&] {
-            ankerl::nanobench::doNotOptimizeAway(action);
+            if constexpr (memory::tracking_enabled) {
+                const auto before = memory::thread_stats();
+                run_action();
+                allocs += memory::thread_stats() - before;
+                ++num_runs;
+            } else {
+                run_action();
+            }
         });
+        if constexpr (memory::tracking_enabled) {
+            const auto num_items = static_cast<double>(num_runs) * static_cast<double>(batch_size);
+            std::cerr << fmt::format("{}: {:0.3f} allocations and {:0.1f} allocated bytes per item\n", name,
+                static_cast<double>(allocs.alloc_calls) / num_items, static_cast<double>(allocs.alloc_bytes) / num_items);
+        }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,157 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <cstring>
+#include "buffer-chain.hpp"
+
+namespace turbo {
+    buffer_chain &buffer_chain::append(const buffer data)
+    {
+        if (data.empty())
+            return *this;
+        // extends the last segment when it ends where the free space of the current chunk begins
+        if (_tail && !_segments.empty() && _tail->capacity() - _tail->size() >= data.size()
+                && _segments.back().data.data() + _segments.back().data.size() == _tail->data() + _tail->size()) {
+            auto &last = _segments.back();
+            _tail->insert(_tail->end(), data.begin(), data.end());
+            last.data = buffer { last.data.data(), last.data.size() + data.size() };
+        } else {
+            _tail = std::make_shared<uint8_vector>();
+            _tail->reserve(std::max(_chunk_size, data.size()));
+            _tail->insert(_tail->end(), data.begin(), data.end());
+            _segments.emplace_back(_tail, buffer { _tail->data(), _tail->size() });
+        }
+        _size += data.size();
+        return *this;
+    }
+
+    buffer_chain &buffer_chain::append(uint8_vector &&data)
+    {
+        auto owner = std::make_shared<const uint8_vector>(std::move(data));
+        const buffer view { owner->data(), owner->size() };
+        return append(std::move(owner), view);
+    }
+
+    buffer_chain &buffer_chain::append(owner_ptr owner, const buffer data)
+    {
+        if (!data.empty()) {
+            _segments.emplace_back(std::move(owner), data);
+            _size += data.size();
+        }
+        return *this;
+    }
+
+    buffer_chain &buffer_chain::append(const shared_bytes &data)
+    {
+        return append(data.owner(), data);
+    }
+
+    buffer_chain &buffer_chain::append(const buffer_chain &o)
+    {
+        // a copy of the segments first, since o may be this chain
+        const auto segs = o._segments;
+        _segments.insert(_segments.end(), segs.begin(), segs.end());
+        _size += o._size;
+        return *this;
+    }
+
+    buffer_chain &buffer_chain::prepend(const buffer data)
+    {
+        return prepend(uint8_vector { data });
+    }
+
+    buffer_chain &buffer_chain::prepend(uint8_vector &&data)
+    {
+        auto owner = std::make_shared<const uint8_vector>(std::move(data));
+        const buffer view { owner->data(), owner->size() };
+        return prepend(std::move(owner), view);
+    }
+
+    buffer_chain &buffer_chain::prepend(owner_ptr owner, const buffer data)
+    {
+        if (!data.empty()) {
+            _segments.emplace_front(std::move(owner), data);
+            _size += data.size();
+        }
+        return *this;
+    }
+
+    buffer_chain &buffer_chain::prepend(const shared_bytes &data)
+    {
+        return prepend(data.owner(), data);
+    }
+
+    buffer_chain &buffer_chain::prepend(const buffer_chain &o)
+    {
+        const auto segs = o._segments;
+        _segments.insert(_segments.begin(), segs.begin(), segs.end());
+        _size += o._size;
+        return *this;
+    }
+
+    buffer_chain buffer_chain::slice(size_t offset, size_t size) const
+    {
+        if (offset > _size || size > _size - offset) [[unlikely]]
+            throw error(fmt::format("a slice at offset {} of {} bytes is outside of a chain of {} bytes", offset, size, _size));
+        buffer_chain res { _chunk_size };
+        for (auto it = _segments.begin(); it != _segments.end() && size > 0; ++it) {
+            if (offset >= it->data.size()) {
+                offset -= it->data.size();
+                continue;
+            }
+            const auto num = std::min(size, it->data.size() - offset);
+            res.append(it->owner, it->data.subbuf(offset, num));
+            offset = 0;
+            size -= num;
+        }
+        return res;
+    }
+
+    void buffer_chain::clear() noexcept
+    {
+        _segments.clear();
+        _size = 0;
+        _tail.reset();
+    }
+
+    void buffer_chain::copy_to(const write_buffer out) const
+    {
+        if (out.size() != _size) [[unlikely]]
+            throw error(fmt::format("the output must have {} bytes but has {}", _size, out.size()));
+        size_t off = 0;
+        for (const auto &s: _segments) {
+            memcpy(out.data() + off, s.data.data(), s.data.size());
+            off += s.data.size();
+        }
+    }
+
+    uint8_vector buffer_chain::flatten() const
+    {
+        uint8_vector res {};
+        res.reserve(_size);
+        for (const auto &s: _segments)
+            res.insert(res.end(), s.data.begin(), s.data.end());
+        return res;
+    }
+
+    void buffer_chain::write(file::write_stream &os) const
+    {
+        const auto bufs = _buffers();
+        os.write(std::span<const buffer> { bufs });
+    }
+
+    void buffer_chain::write(const std::string &path, const file::durability dur) const
+    {
+        const auto bufs = _buffers();
+        file::atomic_writer { dur }.write(path, bufs);
+    }
+
+    std::vector<buffer> buffer_chain::_buffers() const
+    {
+        std::vector<buffer> bufs {};
+        bufs.reserve(_segments.size());
+        for (const auto &s: _segments)
+            bufs.emplace_back(s.data);
+        return bufs;
+    }
+}
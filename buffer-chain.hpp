@@ -0,0 +1,139 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <deque>
+#include <memory>
+#include "shared-bytes.hpp"
+
+namespace turbo {
+    // A byte sequence assembled from ref-counted segments, so that large outputs are built without
+    // reallocations and without a final concatenating copy. Appends and prepends of owned data,
+    // copies and slices share the segments instead of copying the bytes. Small copied appends
+    // are packed into chunks of chunk_size bytes to keep the number of segments low.
+    // Copies of a chain share its segments but never append into the same chunk, so they can be
+    // modified independently.
+    struct buffer_chain {
+        static constexpr size_t default_chunk_size = 0x10000;
+
+        using owner_ptr = std::shared_ptr<const void>;
+
+        struct segment {
+            // keeps the memory of data alive
+            owner_ptr owner;
+            buffer data;
+        };
+
+        using const_iterator = std::deque<segment>::const_iterator;
+
+        explicit buffer_chain(const size_t chunk_size=default_chunk_size):
+            _chunk_size { chunk_size }
+        {
+        }
+
+        buffer_chain(const buffer_chain &o):
+            _segments { o._segments }, _size { o._size }, _chunk_size { o._chunk_size }
+        {
+        }
+
+        buffer_chain(buffer_chain &&o) noexcept:
+            _segments { std::move(o._segments) }, _size { std::exchange(o._size, 0) },
+            _chunk_size { o._chunk_size }, _tail { std::move(o._tail) }
+        {
+        }
+
+        buffer_chain &operator=(const buffer_chain &o)
+        {
+            if (this != &o) [[likely]] {
+                _segments = o._segments;
+                _size = o._size;
+                _chunk_size = o._chunk_size;
+                _tail.reset();
+            }
+            return *this;
+        }
+
+        buffer_chain &operator=(buffer_chain &&o) noexcept
+        {
+            if (this != &o) [[likely]] {
+                _segments = std::move(o._segments);
+                _size = std::exchange(o._size, 0);
+                _chunk_size = o._chunk_size;
+                _tail = std::move(o._tail);
+            }
+            return *this;
+        }
+
+        [[nodiscard]] size_t size() const noexcept
+        {
+            return _size;
+        }
+
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return _size == 0;
+        }
+
+        [[nodiscard]] size_t num_segments() const noexcept
+        {
+            return _segments.size();
+        }
+
+        // iterates over the segments in order
+        const_iterator begin() const noexcept
+        {
+            return _segments.begin();
+        }
+
+        const_iterator end() const noexcept
+        {
+            return _segments.end();
+        }
+
+        // copies the data
+        buffer_chain &append(buffer data);
+        // takes over the memory of the data
+        buffer_chain &append(uint8_vector &&data);
+        // shares the memory owned by owner, such as a memory-mapped file
+        buffer_chain &append(owner_ptr owner, buffer data);
+        buffer_chain &append(const shared_bytes &data);
+        // shares the segments of the other chain
+        buffer_chain &append(const buffer_chain &o);
+
+        buffer_chain &prepend(buffer data);
+        buffer_chain &prepend(uint8_vector &&data);
+        buffer_chain &prepend(owner_ptr owner, buffer data);
+        buffer_chain &prepend(const shared_bytes &data);
+        buffer_chain &prepend(const buffer_chain &o);
+
+        // a chain sharing the segments of the requested range; the search for the range is linear in the number of segments
+        buffer_chain slice(size_t offset, size_t size) const;
+        void clear() noexcept;
+
+        // out must have exactly size() bytes
+        void copy_to(write_buffer out) const;
+        [[nodiscard]] uint8_vector flatten() const;
+        // writes all segments with scatter-gather I/O
+        void write(file::write_stream &os) const;
+        // writes the chain to a file that is replaced atomically
+        void write(const std::string &path, file::durability dur=file::durability::none) const;
+    private:
+        std::deque<segment> _segments {};
+        size_t _size = 0;
+        size_t _chunk_size;
+        // the chunk that receives the copied appends; it is never reallocated, so the existing views stay valid
+        std::shared_ptr<uint8_vector> _tail {};
+
+        [[nodiscard]] std::vector<buffer> _buffers() const;
+    };
+
+    inline buffer_chain &operator<<(buffer_chain &c, const buffer data)
+    {
+        return c.append(data);
+    }
+
+    inline buffer_chain &operator<<(buffer_chain &c, const uint8_t b)
+    {
+        return c.append(buffer { &b, 1 });
+    }
+}
@@ -0,0 +1,132 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <turbo/common/test.hpp>
+#include "buffer-chain.hpp"
+#include "zstd-stream.hpp"
+
+using namespace turbo;
+
+suite turbo_common_buffer_chain_suite = [] {
+    "turbo::common::buffer_chain"_test = [] {
+        "append and prepend"_test = [] {
+            buffer_chain c { 64 };
+            uint8_vector expected {};
+            // the small copies are packed into shared chunks
+            for (size_t i = 0; i < 100; ++i) {
+                const auto part = test_data(i % 7, i);
+                c << buffer { part };
+                expected << buffer { part };
+            }
+            expect_equal(expected.size(), c.size());
+            expect(c.num_segments() < 20);
+            const auto big = test_data(1000, 1);
+            c.append(uint8_vector { big });
+            expected << buffer { big };
+            // owned data is not copied
+            auto moved = test_data(500, 2);
+            const auto *moved_data = moved.data();
+            c.append(std::move(moved));
+            expect((c.end() - 1)->data.data() == moved_data);
+            expected << buffer { test_data(500, 2) };
+            const auto head = test_data(33, 3);
+            c.prepend(buffer { head });
+            expected.insert(expected.begin(), head.begin(), head.end());
+            expect_equal(expected, c.flatten());
+            c << uint8_t { 0xAB };
+            expected << uint8_t { 0xAB };
+            expect_equal(expected, c.flatten());
+            c.append(c);
+            expected << buffer { uint8_vector { expected } };
+            expect_equal(expected, c.flatten());
+        };
+        "slice"_test = [] {
+            buffer_chain c { 16 };
+            uint8_vector expected {};
+            for (size_t i = 0; i < 20; ++i) {
+                c.append(test_data(i * 3 + 1, i));
+                expected << buffer { test_data(i * 3 + 1, i) };
+            }
+            for (const auto &[off, sz]: std::initializer_list<std::pair<size_t, size_t>> { { 0, 0 }, { 0, 10 }, { 5, 100 }, { 123, 321 }, { 0, expected.size() }, { expected.size(), 0 } }) {
+                const auto s = c.slice(off, sz);
+                expect_equal(sz, s.size());
+                expect_equal(static_cast<buffer>(expected).subbuf(off, sz), buffer { s.flatten() }, fmt::format("slice {} {}", off, sz));
+            }
+            expect(throws([&] { c.slice(expected.size(), 1); }));
+            expect(throws([&] { c.slice(1, expected.size()); }));
+        };
+        "copies are independent"_test = [] {
+            buffer_chain a {};
+            a << buffer { test_data(10, 1) };
+            buffer_chain b { a };
+            a << buffer { test_data(10, 2) };
+            b << buffer { test_data(10, 3) };
+            uint8_vector exp_a {}, exp_b {};
+            exp_a << buffer { test_data(10, 1) } << buffer { test_data(10, 2) };
+            exp_b << buffer { test_data(10, 1) } << buffer { test_data(10, 3) };
+            expect_equal(exp_a, a.flatten());
+            expect_equal(exp_b, b.flatten());
+            // the segments outlive the chain that created them
+            const auto s = a.slice(5, 10);
+            a.clear();
+            expect(a.empty());
+            expect_equal(static_cast<buffer>(exp_a).subbuf(5, 10), buffer { s.flatten() });
+        };
+        "write"_test = [] {
+            buffer_chain c {};
+            uint8_vector expected {};
+            // more segments than a single writev accepts
+            for (size_t i = 0; i < 3000; ++i) {
+                c.append(test_data(i % 50 + 1, i));
+                expected << buffer { test_data(i % 50 + 1, i) };
+            }
+            const file::tmp tmp_f { "turbo-buffer-chain-write.bin" };
+            {
+                file::write_stream os { tmp_f.path() };
+                os.write(buffer { test_data(7, 7) });
+                c.write(os);
+                os.write(buffer { test_data(7, 8) });
+            }
+            uint8_vector exp_file {};
+            exp_file << buffer { test_data(7, 7) } << buffer { expected } << buffer { test_data(7, 8) };
+            expect_equal(exp_file, file::read(tmp_f.path()));
+            c.write(tmp_f.path());
+            expect_equal(expected, file::read(tmp_f.path()));
+            uint8_vector out(c.size());
+            c.copy_to(out);
+            expect_equal(expected, out);
+            expect(throws([&] { c.copy_to(write_buffer { out.data(), out.size() - 1 }); }));
+        };
+        "memory-mapped files"_test = [] {
+            const file::tmp tmp_a { "turbo-buffer-chain-a.bin" };
+            const file::tmp tmp_b { "turbo-buffer-chain-b.bin" };
+            file::write(tmp_a.path(), test_data(5000, 1));
+            file::write(tmp_b.path(), test_data(3000, 2));
+            // concatenates the files without copying them
+            buffer_chain c {};
+            for (const auto &p: { tmp_a.path(), tmp_b.path() }) {
+                const auto view = std::make_shared<const file::mmap_view>(p);
+                c.append(view, *view);
+            }
+            uint8_vector expected {};
+            expected << buffer { test_data(5000, 1) } << buffer { test_data(3000, 2) };
+            expect_equal(expected, c.flatten());
+            buffer_chain moved { std::move(c) };
+            expect(c.empty());
+            expect_equal(expected.size(), moved.size());
+        };
+        "zstd"_test = [] {
+            buffer_chain c {};
+            uint8_vector expected {};
+            for (size_t i = 0; i < 100; ++i) {
+                c.append(test_data(1000, i % 3));
+                expected << buffer { test_data(1000, i % 3) };
+            }
+            uint8_vector compressed {};
+            zstd::compress_stream cs { [&](const buffer chunk) { compressed << chunk; } };
+            cs.write(c);
+            cs.finish();
+            expect_equal(expected, zstd::decompress_all(compressed));
+        };
+    };
+};
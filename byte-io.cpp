@@ -0,0 +1,132 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include "byte-io.hpp"
+
+#ifdef TURBO_SIMD_X86
+#   include <immintrin.h>
+#endif
+
+namespace turbo::varint {
+    uint64_t _decode_slow(const buffer data, size_t &pos)
+    {
+        uint64_t val = 0;
+        for (size_t i = 0; i < max_size; ++i) {
+            if (pos + i >= data.size()) [[unlikely]]
+                throw error(fmt::format("the data of {} bytes ends within a varint at offset {}", data.size(), pos));
+            const auto b = data[pos + i];
+            // only the lowest bit of the tenth byte fits into 64 bits
+            if (i == max_size - 1 && b > 1) [[unlikely]]
+                break;
+            val |= static_cast<uint64_t>(b & 0x7FU) << (i * 7);
+            if (!(b & 0x80U)) {
+                pos += i + 1;
+                return val;
+            }
+        }
+        throw error(fmt::format("a varint at offset {} does not fit into 64 bits", pos));
+    }
+
+    namespace {
+        size_t decode_scalar(uint64_t *out, const size_t num, const buffer data, size_t pos)
+        {
+            for (size_t k = 0; k < num; ++k)
+                out[k] = decode(data, pos);
+            return pos;
+        }
+
+#ifdef TURBO_SIMD_X86
+        // Decodes the values ending within a block whose continuation bits are in mask. The value boundaries come
+        // from the mask, so the decoding of a value does not wait for the end of the previous one.
+        // Returns the offset of the first value that does not end within the block.
+        inline size_t decode_block(uint64_t *out, size_t &k, const buffer data, const size_t pos, uint32_t ends)
+        {
+            // a block with no last byte has an overlong value, which decode reports
+            if (!ends) [[unlikely]] {
+                size_t p = pos;
+                out[k++] = decode(data, p);
+                return p;
+            }
+            size_t start = pos;
+            for (; ends; ends &= ends - 1) {
+                const auto end = pos + static_cast<size_t>(std::countr_zero(ends)) + 1;
+                if (end - start <= sizeof(uint64_t) && start + sizeof(uint64_t) <= data.size()) [[likely]] {
+                    (void)_decode_swar(data.data() + start, out[k++]);
+                } else {
+                    size_t p = start;
+                    out[k++] = decode(data, p);
+                }
+                start = end;
+            }
+            return start;
+        }
+
+        // Blocks of single-byte values, which dominate the columns of small integers, are widened without looking
+        // at the individual bytes.
+        __attribute__((target("sse4.1")))
+        size_t decode_sse41(uint64_t *out, const size_t num, const buffer data, size_t &k)
+        {
+            const auto *p = data.data();
+            size_t pos = 0;
+            while (k + 16 <= num && pos + 16 <= data.size()) {
+                const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + pos))));
+                if (!mask) {
+                    for (size_t j = 0; j < 16; j += 2) {
+                        uint16_t pair;
+                        memcpy(&pair, p + pos + j, sizeof(pair));
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + k + j), _mm_cvtepu8_epi64(_mm_cvtsi32_si128(pair)));
+                    }
+                    k += 16;
+                    pos += 16;
+                } else {
+                    pos = decode_block(out, k, data, pos, ~mask & 0xFFFFU);
+                }
+            }
+            return pos;
+        }
+
+        __attribute__((target("avx2")))
+        size_t decode_avx2(uint64_t *out, const size_t num, const buffer data, size_t &k)
+        {
+            const auto *p = data.data();
+            size_t pos = 0;
+            while (k + 32 <= num && pos + 32 <= data.size()) {
+                const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + pos))));
+                if (!mask) {
+                    for (size_t j = 0; j < 32; j += 4) {
+                        uint32_t quad;
+                        memcpy(&quad, p + pos + j, sizeof(quad));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + k + j), _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(static_cast<int>(quad))));
+                    }
+                    k += 32;
+                    pos += 32;
+                } else {
+                    pos = decode_block(out, k, data, pos, ~mask);
+                }
+            }
+            return pos;
+        }
+#endif
+    }
+
+    size_t decode(const std::span<uint64_t> out, const buffer data, const isa i)
+    {
+        size_t k = 0;
+        size_t pos = 0;
+        switch (i) {
+#ifdef TURBO_SIMD_X86
+            // 512-bit registers bring no gain over AVX2 here since the blocks with multi-byte values are decoded one by one
+            case isa::avx512:
+            case isa::avx2: pos = decode_avx2(out.data(), out.size(), data, k); break;
+            case isa::sse41: pos = decode_sse41(out.data(), out.size(), data, k); break;
+#endif
+            default: break;
+        }
+        return decode_scalar(out.data() + k, out.size() - k, data, pos);
+    }
+
+    size_t decode(const std::span<uint64_t> out, const buffer data)
+    {
+        return decode(out, data, simd::best_isa());
+    }
+}
@@ -0,0 +1,308 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <bit>
+#include <cstring>
+#include "bytes.hpp"
+#include "simd.hpp"
+
+namespace turbo {
+    template<std::integral T>
+    [[nodiscard]] constexpr T host_to_le(const T value) noexcept
+    {
+        if constexpr (std::endian::native == std::endian::big)
+            return std::byteswap(value);
+        return value;
+    }
+
+    template<std::integral T>
+    [[nodiscard]] constexpr T le_to_host(const T value) noexcept
+    {
+        return host_to_le(value);
+    }
+
+    // The LEB128 encoding of unsigned integers: 7 bits per byte starting from the least significant ones,
+    // with the top bit set in all bytes but the last.
+    namespace varint {
+        using simd::isa;
+
+        static constexpr size_t max_size = 10;
+
+        [[nodiscard]] constexpr size_t encoded_size(const uint64_t val) noexcept
+        {
+            return val ? (static_cast<size_t>(std::bit_width(val)) + 6) / 7 : 1;
+        }
+
+        // maps the signed values with small magnitudes to small unsigned ones
+        [[nodiscard]] constexpr uint64_t zigzag_encode(const int64_t val) noexcept
+        {
+            return (static_cast<uint64_t>(val) << 1U) ^ static_cast<uint64_t>(val >> 63U);
+        }
+
+        [[nodiscard]] constexpr int64_t zigzag_decode(const uint64_t val) noexcept
+        {
+            return static_cast<int64_t>(val >> 1U) ^ -static_cast<int64_t>(val & 1U);
+        }
+
+        // out must have at least encoded_size(val) bytes; returns the number of the written bytes
+        inline size_t encode(uint8_t *out, uint64_t val) noexcept
+        {
+            size_t num = 0;
+            while (val >= 0x80) {
+                out[num++] = static_cast<uint8_t>(val | 0x80U);
+                val >>= 7U;
+            }
+            out[num++] = static_cast<uint8_t>(val);
+            return num;
+        }
+
+        [[nodiscard]] extern uint64_t _decode_slow(buffer data, size_t &pos);
+
+        // Decodes the values of up to 8 bytes from a single 64-bit load: the first clear top bit marks the end of the value,
+        // and the 7-bit groups are joined pairwise in three steps. Needs at least 8 readable bytes at p.
+        // Returns 0 if the value is longer than 8 bytes.
+        [[nodiscard]] inline size_t _decode_swar(const uint8_t *p, uint64_t &val) noexcept
+        {
+            uint64_t x;
+            memcpy(&x, p, sizeof(x));
+            x = le_to_host(x);
+            const auto stops = ~x & 0x8080808080808080ULL;
+            if (!stops) [[unlikely]]
+                return 0;
+            // keeps the bytes up to and including the last one of the value
+            x &= (stops ^ (stops - 1)) & 0x7F7F7F7F7F7F7F7FULL;
+            x = (x & 0x007F007F007F007FULL) | ((x & 0x7F007F007F007F00ULL) >> 1U);
+            x = (x & 0x00003FFF00003FFFULL) | ((x & 0x3FFF00003FFF0000ULL) >> 2U);
+            x = (x & 0x000000000FFFFFFFULL) | ((x & 0x0FFFFFFF00000000ULL) >> 4U);
+            val = x;
+            return static_cast<size_t>(std::countr_zero(stops)) / 8 + 1;
+        }
+
+        // decodes the value at pos and moves pos past it; throws if the data ends within the value or it does not fit into 64 bits
+        [[nodiscard]] inline uint64_t decode(const buffer data, size_t &pos)
+        {
+            const auto avail = data.size() - pos;
+            // the single-byte values go first, since they are the most frequent and need no work
+            if (avail > 0 && data[pos] < 0x80) [[likely]]
+                return data[pos++];
+            if (avail >= sizeof(uint64_t)) [[likely]] {
+                uint64_t val;
+                if (const auto num = _decode_swar(data.data() + pos, val); num) [[likely]] {
+                    pos += num;
+                    return val;
+                }
+            }
+            return _decode_slow(data, pos);
+        }
+
+        // decodes out.size() consecutive values and returns the number of the consumed bytes
+        [[nodiscard]] extern size_t decode(std::span<uint64_t> out, buffer data);
+        [[nodiscard]] extern size_t decode(std::span<uint64_t> out, buffer data, isa i);
+    }
+
+    // A cursor for the parsing of binary records. The checked reads throw once the data ends. The unchecked ones
+    // are for the code that has checked the size of a group of reads with a single call to require().
+    struct byte_reader {
+        explicit byte_reader(const buffer data) noexcept:
+            _data { data }
+        {
+        }
+
+        [[nodiscard]] size_t pos() const noexcept
+        {
+            return _pos;
+        }
+
+        [[nodiscard]] size_t remaining() const noexcept
+        {
+            return _data.size() - _pos;
+        }
+
+        [[nodiscard]] bool eof() const noexcept
+        {
+            return _pos == _data.size();
+        }
+
+        [[nodiscard]] buffer data() const noexcept
+        {
+            return _data;
+        }
+
+        void require(const size_t num) const
+        {
+            if (num > remaining()) [[unlikely]]
+                throw error(fmt::format("a read of {} bytes at offset {} is past the end of the data of {} bytes", num, _pos, _data.size()));
+        }
+
+        void skip(const size_t num)
+        {
+            require(num);
+            _pos += num;
+        }
+
+        buffer read_bytes(const size_t num)
+        {
+            require(num);
+            return read_bytes_unchecked(num);
+        }
+
+        buffer read_bytes_unchecked(const size_t num) noexcept
+        {
+            const buffer res { _data.data() + _pos, num };
+            _pos += num;
+            return res;
+        }
+
+        template<std::integral T>
+        T read_be()
+        {
+            require(sizeof(T));
+            return read_be_unchecked<T>();
+        }
+
+        template<std::integral T>
+        T read_be_unchecked() noexcept
+        {
+            return net_to_host(_load<T>());
+        }
+
+        template<std::integral T>
+        T read_le()
+        {
+            require(sizeof(T));
+            return read_le_unchecked<T>();
+        }
+
+        template<std::integral T>
+        T read_le_unchecked() noexcept
+        {
+            return le_to_host(_load<T>());
+        }
+
+        uint64_t read_varint()
+        {
+            return varint::decode(_data, _pos);
+        }
+
+        int64_t read_zigzag()
+        {
+            return varint::zigzag_decode(read_varint());
+        }
+
+        // decodes a run of consecutive varints, such as a column of integers, with the batch decoder
+        void read_varints(const std::span<uint64_t> out)
+        {
+            _pos += varint::decode(out, _data.subbuf(_pos));
+        }
+    private:
+        buffer _data;
+        size_t _pos = 0;
+
+        template<std::integral T>
+        T _load() noexcept
+        {
+            T val;
+            memcpy(&val, _data.data() + _pos, sizeof(T));
+            _pos += sizeof(T);
+            return val;
+        }
+    };
+
+    // The counterpart of byte_reader that fills a preallocated output.
+    struct byte_writer {
+        explicit byte_writer(const write_buffer out) noexcept:
+            _out { out }
+        {
+        }
+
+        [[nodiscard]] size_t pos() const noexcept
+        {
+            return _pos;
+        }
+
+        [[nodiscard]] size_t remaining() const noexcept
+        {
+            return _out.size() - _pos;
+        }
+
+        // the bytes written so far
+        [[nodiscard]] buffer written() const noexcept
+        {
+            return { _out.data(), _pos };
+        }
+
+        void require(const size_t num) const
+        {
+            if (num > remaining()) [[unlikely]]
+                throw error(fmt::format("a write of {} bytes at offset {} is past the end of the output of {} bytes", num, _pos, _out.size()));
+        }
+
+        void write_bytes(const buffer data)
+        {
+            require(data.size());
+            write_bytes_unchecked(data);
+        }
+
+        void write_bytes_unchecked(const buffer data) noexcept
+        {
+            if (!data.empty())
+                memcpy(_out.data() + _pos, data.data(), data.size());
+            _pos += data.size();
+        }
+
+        template<std::integral T>
+        void write_be(const T val)
+        {
+            require(sizeof(T));
+            write_be_unchecked(val);
+        }
+
+        template<std::integral T>
+        void write_be_unchecked(const T val) noexcept
+        {
+            _store(host_to_net(val));
+        }
+
+        template<std::integral T>
+        void write_le(const T val)
+        {
+            require(sizeof(T));
+            write_le_unchecked(val);
+        }
+
+        template<std::integral T>
+        void write_le_unchecked(const T val) noexcept
+        {
+            _store(host_to_le(val));
+        }
+
+        void write_varint(const uint64_t val)
+        {
+            if (remaining() < varint::max_size) [[unlikely]]
+                require(varint::encoded_size(val));
+            write_varint_unchecked(val);
+        }
+
+        // needs varint::encoded_size(val) bytes, or varint::max_size per value when checked for a group of values
+        void write_varint_unchecked(const uint64_t val) noexcept
+        {
+            _pos += varint::encode(_out.data() + _pos, val);
+        }
+
+        void write_zigzag(const int64_t val)
+        {
+            write_varint(varint::zigzag_encode(val));
+        }
+    private:
+        write_buffer _out;
+        size_t _pos = 0;
+
+        template<std::integral T>
+        void _store(const T val) noexcept
+        {
+            memcpy(_out.data() + _pos, &val, sizeof(T));
+            _pos += sizeof(T);
+        }
+    };
+}
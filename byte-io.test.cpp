@@ -0,0 +1,140 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <turbo/common/test.hpp>
+#include "byte-io.hpp"
+
+namespace {
+    using namespace turbo;
+
+    // values of all encoded sizes from 1 to 10 bytes
+    std::vector<uint64_t> make_values(const size_t num, const size_t seed)
+    {
+        std::vector<uint64_t> vals(num);
+        uint64_t x = seed * 0x9E3779B97F4A7C15ULL + 1;
+        for (size_t i = 0; i < num; ++i) {
+            x ^= x << 13U;
+            x ^= x >> 7U;
+            x ^= x << 17U;
+            vals[i] = x >> (x % 64);
+        }
+        return vals;
+    }
+
+    uint8_vector encode_values(const std::vector<uint64_t> &vals)
+    {
+        uint8_vector out(vals.size() * varint::max_size);
+        byte_writer w { out };
+        for (const auto v: vals)
+            w.write_varint(v);
+        out.resize(w.pos());
+        return out;
+    }
+}
+
+suite turbo_common_byte_io_suite = [] {
+    "turbo::common::byte_io"_test = [] {
+        "fixed-width integers"_test = [] {
+            uint8_vector out(14);
+            byte_writer w { out };
+            w.write_be<uint32_t>(0x01020304);
+            w.write_le<uint32_t>(0x01020304);
+            w.write_be<int16_t>(-2);
+            w.write_le<uint8_t>(0xAB);
+            w.write_bytes(std::string_view { "xyz" });
+            expect_equal(0U, w.remaining());
+            expect(throws([&] { w.write_be<uint8_t>(0); }));
+            expect_equal(uint8_vector::from_hex("0102030404030201FFFEAB78797A"), uint8_vector { w.written() });
+            byte_reader r { w.written() };
+            expect_equal(0x01020304U, r.read_be<uint32_t>());
+            expect_equal(0x04030201U, r.read_be<uint32_t>());
+            expect_equal(-2, r.read_be<int16_t>());
+            r.require(4);
+            expect_equal(0xABU, r.read_le_unchecked<uint8_t>());
+            expect_equal(std::string_view { "xyz" }, static_cast<std::string_view>(r.read_bytes_unchecked(3)));
+            expect(r.eof());
+            expect(throws([&] { r.read_le<uint8_t>(); }));
+            expect(throws([&] { r.skip(1); }));
+            expect_equal(14U, r.pos());
+        };
+        "varint"_test = [] {
+            for (const uint64_t v: { 0ULL, 1ULL, 127ULL, 128ULL, 300ULL, 16383ULL, 16384ULL, 0xFFFFFFFFULL, 0x00FFFFFFFFFFFFFFULL,
+                    0x0100000000000000ULL, 0x7FFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL }) {
+                uint8_t buf[varint::max_size];
+                const auto sz = varint::encode(buf, v);
+                expect_equal(varint::encoded_size(v), sz);
+                // with and without the padding that allows the 64-bit loads
+                for (const size_t pad: { 0, 16 }) {
+                    uint8_vector data { buffer { buf, sz } };
+                    data.resize(sz + pad);
+                    size_t pos = 0;
+                    expect_equal(v, varint::decode(data, pos));
+                    expect_equal(sz, pos);
+                }
+            }
+            uint8_t buf[varint::max_size];
+            expect_equal(uint8_vector::from_hex("AC02"), uint8_vector { buffer { buf, varint::encode(buf, 300) } });
+            for (const int64_t v: std::initializer_list<int64_t> { 0, -1, 1, -64, 64, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max() })
+                expect_equal(v, varint::zigzag_decode(varint::zigzag_encode(v)));
+            expect_equal(3U, varint::zigzag_encode(-2));
+        };
+        "varint errors"_test = [] {
+            // truncated
+            const auto truncated = uint8_vector::from_hex("8080");
+            size_t truncated_pos = 0;
+            expect(throws([&] { (void)varint::decode(truncated, truncated_pos); }));
+            for (const size_t pad: { 0, 16 }) {
+                // longer than 10 bytes
+                auto data = uint8_vector(11, 0xFF);
+                data.resize(data.size() + pad);
+                size_t pos = 0;
+                expect(throws([&] { (void)varint::decode(data, pos); }));
+                // the tenth byte has more than the 64th bit
+                data = uint8_vector::from_hex("FFFFFFFFFFFFFFFFFF02");
+                data.resize(data.size() + pad);
+                pos = 0;
+                expect(throws([&] { (void)varint::decode(data, pos); }));
+            }
+        };
+        "batch decode"_test = [] {
+            const auto isas = { varint::isa::scalar, varint::isa::sse41, varint::isa::avx2, varint::isa::avx512 };
+            std::vector<std::vector<uint64_t>> inputs {};
+            inputs.emplace_back(make_values(1000, 1));
+            // runs of single-byte values mixed with longer ones
+            auto small = make_values(1000, 2);
+            for (size_t i = 0; i < small.size(); ++i) {
+                if (i % 100 < 90)
+                    small[i] &= 0x7F;
+            }
+            inputs.emplace_back(std::move(small));
+            for (const auto &vals: inputs) {
+                const auto data = encode_values(vals);
+                for (const auto i: isas) {
+                    if (!simd::supported(i))
+                        continue;
+                    for (const size_t num: { 0, 1, 15, 16, 17, 33, 100, 1000 }) {
+                        std::vector<uint64_t> out(num);
+                        const auto consumed = varint::decode(out, data, i);
+                        expect(std::equal(out.begin(), out.end(), vals.begin())) << static_cast<int>(i) << num;
+                        size_t pos = 0;
+                        for (size_t k = 0; k < num; ++k)
+                            (void)varint::decode(data, pos);
+                        expect_equal(pos, consumed);
+                    }
+                    std::vector<uint64_t> too_many(vals.size() + 1);
+                    expect(throws([&] { (void)varint::decode(too_many, data, i); }));
+                }
+            }
+            // through the reader, after a fixed-width header
+            const auto vals = make_values(500, 3);
+            uint8_vector data(4);
+            data << encode_values(vals);
+            byte_reader r { data };
+            expect_equal(0U, r.read_be<uint32_t>());
+            std::vector<uint64_t> out(vals.size());
+            r.read_varints(out);
+            expect(vals == out);
+            expect(r.eof());
+        };
+    };
+};
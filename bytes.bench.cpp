@@ -1,10 +1,63 @@
 /* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
- * Copyright (c) 2024-2025 R2 Rationality OÜ (info at r2rationality dot com) */
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
 
+#include <unordered_map>
+#include "base58.hpp"
+#include "base64.hpp"
+#include "bech32.hpp"
 #include "benchmark.hpp"
+#include "buffer-chain.hpp"
+#include "byte-io.hpp"
+#include "hex.hpp"
+#include "inline-bytes.hpp"
+#include "search.hpp"
 
 namespace {
     using namespace turbo;
+
+    // the hasher that maps keyed by byte strings had to use before
+    struct string_view_hash {
+        size_t operator()(const byte_array<32> &k) const noexcept
+        {
+            return std::hash<std::string_view> {}(static_cast<std::string_view>(k));
+        }
+    };
+
+    // the byte-by-byte decoding used before byte_reader
+    uint64_t read_varint_bytewise(const buffer data, size_t &pos)
+    {
+        uint64_t val = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (pos >= data.size()) [[unlikely]]
+                throw error("the data ends within a varint");
+            const auto b = data[pos++];
+            val |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80))
+                return val;
+        }
+        throw error("a varint does not fit into 64 bits");
+    }
+
+    template<typename H>
+    void bench_hash_map(ankerl::nanobench::Bench &b, const std::string &name, const std::vector<byte_array<32>> &keys)
+    {
+        b.run(fmt::format("{} insert", name), [&] {
+            std::unordered_map<byte_array<32>, size_t, H> map {};
+            map.reserve(keys.size());
+            for (size_t i = 0; i < keys.size(); ++i)
+                map.try_emplace(keys[i], i);
+            ankerl::nanobench::doNotOptimizeAway(map);
+        });
+        std::unordered_map<byte_array<32>, size_t, H> map {};
+        for (size_t i = 0; i < keys.size(); ++i)
+            map.try_emplace(keys[i], i);
+        b.run(fmt::format("{} lookup", name), [&] {
+            size_t sum = 0;
+            for (const auto &k: keys)
+                sum += map.find(k)->second;
+            ankerl::nanobench::doNotOptimizeAway(sum);
+        });
+    }
 }
 
 suite turbo_common_bytes_bench_suite = [] {
@@ -23,4 +76,322 @@ suite turbo_common_bytes_bench_suite = [] {
             ankerl::nanobench::doNotOptimizeAway(res);
         });
     };
-};
\ No newline at end of file
+    "turbo::common::hex"_test = [] {
+        for (const size_t size: { 32, 1 << 10, 1 << 20 }) {
+            uint8_vector data(size);
+            for (size_t i = 0; i < data.size(); ++i)
+                data[i] = static_cast<uint8_t>(i * 37);
+            std::string text(size * 2, '0');
+            ankerl::nanobench::Bench b {};
+            b.title(fmt::format("turbo::common::hex {} bytes", size))
+                .output(&std::cerr)
+                .unit("byte")
+                .performanceCounters(true)
+                .relative(true)
+                .batch(size);
+            b.run("encode fmt {:02X} per byte", [&] {
+                auto out_it = text.begin();
+                for (const auto v: data)
+                    out_it = fmt::format_to(out_it, "{:02X}", v);
+                ankerl::nanobench::doNotOptimizeAway(text);
+            });
+            for (const auto &[name, i]: std::initializer_list<std::pair<std::string_view, hex::isa>> {
+                { "scalar", hex::isa::scalar }, { "sse4.1", hex::isa::sse41 }, { "avx2", hex::isa::avx2 }, { "avx512", hex::isa::avx512 } })
+            {
+                if (!simd::supported(i))
+                    continue;
+                b.run(fmt::format("encode {}", name), [&] {
+                    hex::encode(text, data, true, i);
+                    ankerl::nanobench::doNotOptimizeAway(text);
+                });
+            }
+            b.run("decode uint_from_hex per char", [&] {
+                for (size_t j = 0; j < data.size(); ++j)
+                    data[j] = static_cast<uint8_t>(uint_from_hex(text[j * 2]) << 4U) | uint_from_hex(text[j * 2 + 1]);
+                ankerl::nanobench::doNotOptimizeAway(data);
+            });
+            for (const auto &[name, i]: std::initializer_list<std::pair<std::string_view, hex::isa>> {
+                { "scalar", hex::isa::scalar }, { "sse4.1", hex::isa::sse41 }, { "avx2", hex::isa::avx2 }, { "avx512", hex::isa::avx512 } })
+            {
+                if (!simd::supported(i))
+                    continue;
+                b.run(fmt::format("decode {}", name), [&] {
+                    ankerl::nanobench::doNotOptimizeAway(hex::decode(data, text, i));
+                });
+            }
+        }
+    };
+    "turbo::common::base64"_test = [] {
+        for (const size_t size: { 32, 1 << 10, 1 << 20 }) {
+            uint8_vector data(size);
+            for (size_t i = 0; i < data.size(); ++i)
+                data[i] = static_cast<uint8_t>(i * 37);
+            std::string text(base64::encoded_size(size), '=');
+            ankerl::nanobench::Bench b {};
+            b.title(fmt::format("turbo::common::base64 {} bytes", size))
+                .output(&std::cerr)
+                .unit("byte")
+                .performanceCounters(true)
+                .relative(true)
+                .batch(size);
+            for (const auto &[name, i]: std::initializer_list<std::pair<std::string_view, base64::isa>> {
+                { "scalar", base64::isa::scalar }, { "sse4.1", base64::isa::sse41 }, { "avx2", base64::isa::avx2 } })
+            {
+                if (!simd::supported(i))
+                    continue;
+                b.run(fmt::format("encode {}", name), [&] {
+                    ankerl::nanobench::doNotOptimizeAway(base64::encode_to(text, data, base64::alphabet::standard, i));
+                });
+            }
+            for (const auto &[name, i]: std::initializer_list<std::pair<std::string_view, base64::isa>> {
+                { "scalar", base64::isa::scalar }, { "sse4.1", base64::isa::sse41 }, { "avx2", base64::isa::avx2 } })
+            {
+                if (!simd::supported(i))
+                    continue;
+                b.run(fmt::format("decode {}", name), [&] {
+                    ankerl::nanobench::doNotOptimizeAway(base64::decode_to(data, text, base64::alphabet::standard, i));
+                });
+            }
+        }
+    };
+    "turbo::common::base58 and bech32"_test = [] {
+        // the typical sizes of a key hash and of a Cardano base address
+        for (const size_t size: { 28, 57 }) {
+            uint8_vector data(size);
+            for (size_t i = 0; i < data.size(); ++i)
+                data[i] = static_cast<uint8_t>(i * 37 + 1);
+            std::string text(std::max(base58::max_encoded_size(size), bech32::encoded_size(4, size)), '1');
+            ankerl::nanobench::Bench b {};
+            b.title(fmt::format("turbo::common::base58 and bech32 {} bytes", size))
+                .output(&std::cerr)
+                .unit("byte")
+                .performanceCounters(true)
+                .batch(size);
+            const auto b58 = base58::encode(data);
+            const auto b32 = bech32::encode("addr", data);
+            b.run("base58 encode", [&] {
+                ankerl::nanobench::doNotOptimizeAway(base58::encode_to(text, data));
+            });
+            b.run("base58 decode", [&] {
+                ankerl::nanobench::doNotOptimizeAway(base58::decode_to(data, b58));
+            });
+            b.run("bech32 encode", [&] {
+                ankerl::nanobench::doNotOptimizeAway(bech32::encode_to(text, "addr", data));
+            });
+            b.run("bech32 decode", [&] {
+                ankerl::nanobench::doNotOptimizeAway(bech32::decode_to(data, b32));
+            });
+        }
+    };
+    "turbo::common::inline_bytes"_test = [] {
+        // copies of 32-byte hashes as done by decoders of records with hash fields
+        std::vector<byte_array<32>> hashes(1000);
+        for (size_t i = 0; i < hashes.size(); ++i)
+            hashes[i].fill(static_cast<uint8_t>(i));
+        ankerl::nanobench::Bench b {};
+        b.title("turbo::common::inline_bytes 32-byte copies")
+            .output(&std::cerr)
+            .unit("copy")
+            .performanceCounters(true)
+            .relative(true)
+            .batch(hashes.size());
+        b.run("uint8_vector", [&] {
+            std::vector<uint8_vector> copies {};
+            copies.reserve(hashes.size());
+            for (const auto &h: hashes)
+                copies.emplace_back(h);
+            ankerl::nanobench::doNotOptimizeAway(copies);
+        });
+        b.run("inline_bytes<32>", [&] {
+            std::vector<inline_bytes<32>> copies {};
+            copies.reserve(hashes.size());
+            for (const auto &h: hashes)
+                copies.emplace_back(h);
+            ankerl::nanobench::doNotOptimizeAway(copies);
+        });
+    };
+    "turbo::common::buffer_chain"_test = [] {
+        // the assembly of a 256 MiB output from 4 KiB parts as done by serializers
+        static constexpr size_t part_size = 0x1000;
+        static constexpr size_t num_parts = 0x10000;
+        const uint8_vector part(part_size, 0xA5);
+        ankerl::nanobench::Bench b {};
+        b.title("turbo::common::buffer_chain 256 MiB from 4 KiB parts")
+            .output(&std::cerr)
+            .unit("byte")
+            .performanceCounters(true)
+            .relative(true)
+            .epochs(3)
+            .batch(part_size * num_parts);
+        b.run("uint8_vector append", [&] {
+            uint8_vector out {};
+            for (size_t i = 0; i < num_parts; ++i)
+                out << buffer { part };
+            ankerl::nanobench::doNotOptimizeAway(out);
+        });
+        b.run("buffer_chain append", [&] {
+            buffer_chain out {};
+            for (size_t i = 0; i < num_parts; ++i)
+                out << buffer { part };
+            ankerl::nanobench::doNotOptimizeAway(out);
+        });
+        b.run("buffer_chain append of owned parts", [&] {
+            buffer_chain out {};
+            for (size_t i = 0; i < num_parts; ++i)
+                out.append(uint8_vector(part_size));
+            ankerl::nanobench::doNotOptimizeAway(out);
+        });
+    };
+    "turbo::common::hash maps with byte_array<32> keys"_test = [] {
+        std::vector<byte_array<32>> keys(100'000);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            for (size_t j = 0; j < 32; ++j)
+                keys[i][j] = static_cast<uint8_t>((i >> (j % 4 * 8)) * (j + 1) + j);
+        }
+        ankerl::nanobench::Bench b {};
+        b.title("turbo::common::hash maps with byte_array<32> keys")
+            .output(&std::cerr)
+            .unit("key")
+            .performanceCounters(true)
+            .relative(true)
+            .batch(keys.size());
+        bench_hash_map<string_view_hash>(b, "std::hash<std::string_view>", keys);
+        bench_hash_map<std::hash<byte_array<32>>>(b, "std::hash<byte_array<32>>", keys);
+    };
+    "turbo::common::byte_array comparison"_test = [] {
+        // the equal keys are compared in full, as in hash map hits, while the different ones differ in the last word
+        std::vector<byte_array<32>> keys(1000);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            keys[i].fill(0xA5);
+            keys[i][31] = static_cast<uint8_t>(i / 2);
+        }
+        ankerl::nanobench::Bench b {};
+        b.title("turbo::common::byte_array<32> comparison")
+            .output(&std::cerr)
+            .unit("cmp")
+            .performanceCounters(true)
+            .relative(true)
+            .batch(keys.size());
+        b.run("memcmp", [&] {
+            size_t num_eq = 0;
+            for (size_t i = 1; i < keys.size(); ++i)
+                num_eq += memcmp(keys[i - 1].data(), keys[i].data(), 32) == 0;
+            ankerl::nanobench::doNotOptimizeAway(num_eq);
+        });
+        b.run("std::array operator==", [&] {
+            size_t num_eq = 0;
+            for (size_t i = 1; i < keys.size(); ++i)
+                num_eq += static_cast<const std::array<uint8_t, 32> &>(keys[i - 1]) == static_cast<const std::array<uint8_t, 32> &>(keys[i]);
+            ankerl::nanobench::doNotOptimizeAway(num_eq);
+        });
+        b.run("operator==", [&] {
+            size_t num_eq = 0;
+            for (size_t i = 1; i < keys.size(); ++i)
+                num_eq += keys[i - 1] == keys[i];
+            ankerl::nanobench::doNotOptimizeAway(num_eq);
+        });
+        b.run("std::array operator<", [&] {
+            size_t num_lt = 0;
+            for (size_t i = 1; i < keys.size(); ++i)
+                num_lt += static_cast<const std::array<uint8_t, 32> &>(keys[i - 1]) < static_cast<const std::array<uint8_t, 32> &>(keys[i]);
+            ankerl::nanobench::doNotOptimizeAway(num_lt);
+        });
+        b.run("operator<", [&] {
+            size_t num_lt = 0;
+            for (size_t i = 1; i < keys.size(); ++i)
+                num_lt += keys[i - 1] < keys[i];
+            ankerl::nanobench::doNotOptimizeAway(num_lt);
+        });
+    };
+    "turbo::common::search"_test = [] {
+        // a text with frequent partial matches of the needle and the match at the end
+        std::string text(1 << 20, 'a');
+        for (size_t i = 0; i < text.size(); i += 7)
+            text[i] = 'b';
+        static const std::string_view needle { "abaaaaaabaaaaaacx" };
+        text.replace(text.size() - needle.size(), needle.size(), needle);
+        ankerl::nanobench::Bench b {};
+        b.title("turbo::common::search 1 MiB")
+            .output(&std::cerr)
+            .unit("byte")
+            .performanceCounters(true)
+            .relative(true)
+            .batch(text.size());
+        b.run("std::string_view::find", [&] {
+            ankerl::nanobench::doNotOptimizeAway(std::string_view { text }.find(needle));
+        });
+        for (const auto &[name, i]: std::initializer_list<std::pair<std::string_view, search::isa>> {
+            { "scalar", search::isa::scalar }, { "sse4.1", search::isa::sse41 }, { "avx2", search::isa::avx2 } })
+        {
+            if (!simd::supported(i))
+                continue;
+            b.run(fmt::format("find {}", name), [&] {
+                ankerl::nanobench::doNotOptimizeAway(search::find(text, needle, i));
+            });
+        }
+        static const std::string_view set { "xyz\"\\" };
+        b.run("std::string_view::find_first_of", [&] {
+            ankerl::nanobench::doNotOptimizeAway(std::string_view { text }.find_first_of(set));
+        });
+        for (const auto &[name, i]: std::initializer_list<std::pair<std::string_view, search::isa>> {
+            { "scalar", search::isa::scalar }, { "sse4.1", search::isa::sse41 }, { "avx2", search::isa::avx2 } })
+        {
+            if (!simd::supported(i))
+                continue;
+            b.run(fmt::format("find_first_of {}", name), [&] {
+                ankerl::nanobench::doNotOptimizeAway(search::find_first_of(text, set, i));
+            });
+        }
+    };
+    "turbo::common::varint"_test = [] {
+        // a column of small counters and one of values with all encoded sizes
+        for (const bool small: { true, false }) {
+            std::vector<uint64_t> vals(1 << 20);
+            uint64_t x = 1;
+            for (auto &v: vals) {
+                x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+                v = small ? (x >> 17U) & 0x7FU : (x >> 17U) >> (x % 47);
+            }
+            uint8_vector data(vals.size() * varint::max_size);
+            byte_writer w { data };
+            for (const auto v: vals)
+                w.write_varint_unchecked(v);
+            data.resize(w.pos());
+            std::vector<uint64_t> out(vals.size());
+            ankerl::nanobench::Bench b {};
+            b.title(fmt::format("turbo::common::varint {} values", small ? "single-byte" : "mixed-size"))
+                .output(&std::cerr)
+                .unit("value")
+                .performanceCounters(true)
+                .relative(true)
+                .batch(vals.size());
+            b.run("byte by byte", [&] {
+                size_t pos = 0;
+                for (auto &v: out)
+                    v = read_varint_bytewise(data, pos);
+                ankerl::nanobench::doNotOptimizeAway(out);
+            });
+            b.run("byte_reader::read_varint", [&] {
+                byte_reader r { data };
+                for (auto &v: out)
+                    v = r.read_varint();
+                ankerl::nanobench::doNotOptimizeAway(out);
+            });
+            for (const auto &[name, i]: std::initializer_list<std::pair<std::string_view, varint::isa>> {
+                { "scalar", varint::isa::scalar }, { "sse4.1", varint::isa::sse41 }, { "avx2", varint::isa::avx2 } })
+            {
+                if (!simd::supported(i))
+                    continue;
+                b.run(fmt::format("batch {}", name), [&] {
+                    ankerl::nanobench::doNotOptimizeAway(varint::decode(out, data, i));
+                });
+            }
+            b.run("encode byte_writer::write_varint", [&] {
+                byte_writer bw { data };
+                for (const auto v: vals)
+                    bw.write_varint(v);
+                ankerl::nanobench::doNotOptimizeAway(data);
+            });
+        }
+    };
+};
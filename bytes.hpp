@@ -5,10 +5,12 @@
 #include <algorithm>
 #include <array>
 #include <concepts>
+#include <ranges>
 #include <span>
 #include <utility>
 #include "error.hpp"
 #include "format.hpp"
+#include "hash.hpp"
 
 namespace turbo {
     typedef std::span<uint8_t> write_buffer;
@@ -113,7 +115,8 @@ namespace turbo {
 
         bool operator==(const buffer &o) const noexcept
         {
-            return std::strong_ordering::equal == (*this <=> o);
+            // the sizes are checked first, so that unequal sizes do not need a memcmp
+            return size() == o.size() && (empty() || memcmp(data(), o.data(), size()) == 0);
         }
 
         uint8_t at(const size_t off) const
@@ -138,6 +141,61 @@ namespace turbo {
         }
     };
 
+    [[nodiscard]] inline uint64_t _load_u64(const uint8_t *p) noexcept
+    {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    // Comparisons of fixed-size byte strings through 64-bit words that are unrolled at compile time
+    // for the common sizes such as 28, 32 and 64 bytes. The sizes not divisible by 8 finish with an overlapping word.
+    // The order is lexicographic as with memcmp.
+    template<size_t SZ>
+    [[nodiscard]] inline bool equal_fixed(const uint8_t *a, const uint8_t *b) noexcept
+    {
+        if constexpr (SZ < sizeof(uint64_t)) {
+            return memcmp(a, b, SZ) == 0;
+        } else {
+            const auto word_diff = [&](const size_t off) {
+                return _load_u64(a + off) ^ _load_u64(b + off);
+            };
+            // 16-byte steps with early exits as in the inline expansions of memcmp, which are faster than a reduction of all words
+            const bool eq = [&]<size_t... I>(std::index_sequence<I...>) {
+                return (((word_diff(I * 16) | word_diff(I * 16 + 8)) == 0) && ...);
+            }(std::make_index_sequence<SZ / 16> {});
+            constexpr size_t rem = SZ % 16;
+            if constexpr (rem >= 8)
+                return eq && (word_diff(SZ - rem) | word_diff(SZ - 8)) == 0;
+            else if constexpr (rem > 0)
+                return eq && word_diff(SZ - 8) == 0;
+            else
+                return eq;
+        }
+    }
+
+    template<size_t SZ>
+    [[nodiscard]] inline std::strong_ordering compare_fixed(const uint8_t *a, const uint8_t *b) noexcept
+    {
+        if constexpr (SZ < sizeof(uint64_t)) {
+            return memcmp(a, b, SZ) <=> 0;
+        } else {
+            // the big-endian words compare as their bytes do
+            const auto cmp_word = [&](const size_t off) {
+                return net_to_host(_load_u64(a + off)) <=> net_to_host(_load_u64(b + off));
+            };
+            auto res = std::strong_ordering::equal;
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                (((res = cmp_word(I * 8)) != std::strong_ordering::equal) || ...);
+            }(std::make_index_sequence<SZ / 8> {});
+            if constexpr (SZ % 8 != 0) {
+                if (res == std::strong_ordering::equal)
+                    res = cmp_word(SZ - 8);
+            }
+            return res;
+        }
+    }
+
     template<size_t SZ>
     struct
     byte_array: std::array<uint8_t, SZ> {
@@ -217,6 +275,19 @@ namespace turbo {
         }
     };
 
+    // preferred over the comparisons of std::array, which go byte by byte or through a memcmp call
+    template<size_t SZ>
+    bool operator==(const byte_array<SZ> &a, const byte_array<SZ> &b) noexcept
+    {
+        return equal_fixed<SZ>(a.data(), b.data());
+    }
+
+    template<size_t SZ>
+    std::strong_ordering operator<=>(const byte_array<SZ> &a, const byte_array<SZ> &b) noexcept
+    {
+        return compare_fixed<SZ>(a.data(), b.data());
+    }
+
     extern void secure_clear(std::span<uint8_t> store);
 
     template<size_t SZ>
@@ -279,8 +350,11 @@ namespace turbo {
     {
         if (hex.size() != out.size() * 2) [[unlikely]]
             throw error(fmt::format("hex string must have {} characters but got {}: {}!", out.size() * 2, hex.size(), hex));
-        for (size_t i = 0; i < out.size(); ++i)
-            out[i] = static_cast<uint8_t>(uint_from_hex(hex[i * 2]) << 4U) | uint_from_hex(hex[i * 2 + 1]);
+        if (!turbo::hex::decode(out, hex)) [[unlikely]] {
+            // the kernels validate whole blocks, so the offending character is located only on failure
+            for (const auto k: hex)
+                uint_from_hex(static_cast<uint8_t>(k));
+        }
     }
 
     inline void init_from_hex(std::span<uint8_t> out, std::string_view hex)
@@ -365,6 +439,82 @@ namespace turbo {
     static_assert(std::is_constructible_v<buffer, uint8_vector>);
     static_assert(std::is_convertible_v<uint8_vector, buffer>);
 
+    // Turns the value-initialization of elements into a default-initialization,
+    // so that resize leaves the new elements of trivial types uninitialized.
+    template<typename T, typename A=std::allocator<T>>
+    struct default_init_allocator: A {
+        using A::A;
+
+        template<typename U>
+        struct rebind {
+            using other = default_init_allocator<U, typename std::allocator_traits<A>::template rebind_alloc<U>>;
+        };
+
+        template<typename U>
+        void construct(U *ptr) noexcept(std::is_nothrow_default_constructible_v<U>)
+        {
+            ::new(static_cast<void *>(ptr)) U;
+        }
+
+        template<typename U, typename... ARGS>
+        void construct(U *ptr, ARGS &&...args)
+        {
+            std::allocator_traits<A>::construct(static_cast<A &>(*this), ptr, std::forward<ARGS>(args)...);
+        }
+    };
+
+    // A byte vector for the outputs of reads and decompressions, which overwrite the new bytes right away.
+    // Its resize skips the zero-filling, which for large outputs is a full extra pass over the memory.
+    struct default_init_uint8_vector: std::vector<uint8_t, default_init_allocator<uint8_t>> {
+        using base_type = std::vector<uint8_t, default_init_allocator<uint8_t>>;
+        using base_type::base_type;
+
+        default_init_uint8_vector() noexcept =default;
+
+        explicit default_init_uint8_vector(const size_t sz):
+            base_type(sz)
+        {
+        }
+
+        default_init_uint8_vector(const buffer bytes):
+            base_type(bytes.begin(), bytes.end())
+        {
+        }
+
+        operator buffer() const noexcept
+        {
+            return { data(), size() };
+        }
+
+        std::string_view str() const noexcept
+        {
+            return { reinterpret_cast<const char *>(data()), size() };
+        }
+
+        std::strong_ordering operator<=>(const buffer &o) const noexcept
+        {
+            return static_cast<buffer>(*this) <=> o;
+        }
+
+        bool operator==(const buffer &o) const noexcept
+        {
+            return std::strong_ordering::equal == (*this <=> o);
+        }
+
+        // resolves the comparisons with uint8_vector, which converts to buffer as well
+        bool operator==(const uint8_vector &o) const noexcept
+        {
+            return *this == static_cast<buffer>(o);
+        }
+
+        bool operator==(const default_init_uint8_vector &o) const noexcept
+        {
+            return *this == static_cast<buffer>(o);
+        }
+    };
+
+    static_assert(std::is_convertible_v<default_init_uint8_vector, buffer>);
+
     struct uninitialized_bytes_t {
         uninitialized_bytes_t(const uninitialized_bytes_t &) = delete;
         uninitialized_bytes_t &operator=(const uninitialized_bytes_t &) = delete;
@@ -484,6 +634,10 @@ namespace fmt {
     struct formatter<turbo::uint8_vector>: formatter<turbo::buffer> {
     };
 
+    template<>
+    struct formatter<turbo::default_init_uint8_vector>: formatter<turbo::buffer> {
+    };
+
     template<>
     struct formatter<turbo::uninitialized_bytes_t>: formatter<turbo::buffer> {
     };
@@ -492,11 +646,41 @@ namespace fmt {
     struct formatter<turbo::buffer_lowercase>: formatter<int> {
         template<typename FormatContext>
         auto format(const std::span<const uint8_t> &data, FormatContext &ctx) const -> decltype(ctx.out()) {
-            auto out_it = ctx.out();
-            for (uint8_t v: data) {
-                out_it = fmt::format_to(out_it, "{:02x}", v);
-            }
-            return out_it;
+            return turbo::hex::encode_to(ctx.out(), data, false);
+        }
+    };
+}
+
+namespace std {
+    template<size_t SZ>
+    struct hash<turbo::byte_array<SZ>> {
+        size_t operator()(const turbo::byte_array<SZ> &a) const noexcept
+        {
+            return turbo::hash::bytes(a.data(), SZ);
+        }
+    };
+
+    template<>
+    struct hash<turbo::buffer> {
+        size_t operator()(const turbo::buffer b) const noexcept
+        {
+            return turbo::hash::bytes(b.data(), b.size());
+        }
+    };
+
+    template<>
+    struct hash<turbo::uint8_vector> {
+        size_t operator()(const turbo::uint8_vector &v) const noexcept
+        {
+            return turbo::hash::bytes(v.data(), v.size());
         }
     };
 }
+
+namespace std::ranges {
+    // buffers are non-owning views the same as std::span, so the bytes they refer to outlive them
+    template<>
+    inline constexpr bool enable_borrowed_range<turbo::buffer> = true;
+    template<>
+    inline constexpr bool enable_borrowed_range<turbo::buffer_lowercase> = true;
+}
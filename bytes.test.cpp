@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <numeric>
+#include <unordered_map>
 #include "bytes.hpp"
 #include "test.hpp"
 
@@ -234,6 +235,60 @@ suite turbo_common_bytes_suite = [] {
                 // a destructs; must not crash
             };
         };
+        "default_init_uint8_vector"_test = [] {
+            default_init_uint8_vector v(4);
+            memcpy(v.data(), "\x01\x02\x03\x04", 4);
+            expect(v == buffer { byte_array<4>::from_hex("01020304") });
+            v << buffer { byte_array<2>::from_hex("0506") } << uint8_t { 7 };
+            expect_equal(std::string { "01020304050607" }, fmt::format("{}", v));
+            v.resize(2);
+            const uint8_vector copy { v };
+            expect(copy == v);
+            const default_init_uint8_vector from_buf { copy };
+            expect(from_buf == copy);
+        };
+        "byte_array comparison"_test = [] {
+            const auto check = []<size_t SZ>() {
+                byte_array<SZ> a {};
+                for (size_t i = 0; i < SZ; ++i)
+                    a[i] = static_cast<uint8_t>(i * 13 + 1);
+                for (size_t i = 0; i < SZ; ++i) {
+                    for (const int delta: { -1, 1 }) {
+                        auto b = a;
+                        b[i] = static_cast<uint8_t>(b[i] + delta);
+                        expect(!(a == b)) << SZ << i;
+                        expect((memcmp(a.data(), b.data(), SZ) <=> 0) == (a <=> b)) << SZ << i;
+                    }
+                }
+                const auto c = a;
+                expect(a == c);
+                expect(std::strong_ordering::equal == (a <=> c));
+            };
+            check.template operator()<5>();
+            check.template operator()<28>();
+            check.template operator()<32>();
+            check.template operator()<33>();
+            check.template operator()<64>();
+            const secure_byte_array<4> sec { 1, 2, 3, 4 };
+            expect(sec == byte_array<4> { 1, 2, 3, 4 });
+            expect(sec < byte_array<4> { 1, 2, 3, 5 });
+            expect(byte_array<4> { 1, 2, 3, 4 } == buffer { sec });
+        };
+        "std::hash"_test = [] {
+            const auto a = byte_array<32>::from_hex("00112233445566778899AABBCCDDEEFF00112233445566778899AABBCCDDEEFF");
+            const uint8_vector v { a };
+            expect_equal(std::hash<buffer> {}(a), std::hash<byte_array<32>> {}(a));
+            expect_equal(std::hash<buffer> {}(a), std::hash<uint8_vector> {}(v));
+            std::unordered_map<byte_array<32>, size_t> map {};
+            for (size_t i = 0; i < 1000; ++i) {
+                auto k = a;
+                k[i % 32] = static_cast<uint8_t>(i);
+                k[(i / 32 + 1) % 32] ^= static_cast<uint8_t>(i >> 5U);
+                map.try_emplace(k, i);
+            }
+            expect(map.size() > 900U);
+            expect(map.contains(a));
+        };
         "secure_array"_test = [] {
             using my_sec_array_t = secure_byte_array<4>;
             const auto empty = byte_array<4>::from_hex("00000000");
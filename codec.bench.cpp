@@ -0,0 +1,245 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <turbo/common/benchmark.hpp>
+#include "codec.hpp"
+
+namespace {
+    using namespace turbo;
+
+    template<typename T, size_t MAX>
+    struct sequence_t: std::vector<T> {
+        static constexpr size_t min_size = 0;
+        static constexpr size_t max_size = MAX;
+        using std::vector<T>::vector;
+    };
+
+    struct output_t {
+        byte_array<32> address {};
+        uint64_t amount = 0;
+
+        void serialize(auto &archive)
+        {
+            archive.process("address", address);
+            archive.process("amount", amount);
+        }
+    };
+
+    // the same layouts opting into the fixed layout with a constexpr serialize(), for which the archives use the static schema
+    struct static_output_t {
+        static constexpr bool is_fixed_layout = true;
+        byte_array<32> address {};
+        uint64_t amount = 0;
+
+        constexpr void serialize(auto &archive)
+        {
+            archive.process("address", address);
+            archive.process("amount", amount);
+        }
+    };
+
+    // a fixed-size layout whose encoding differs from its memory representation due to the padding and the bool
+    template<bool STATIC>
+    struct entry_t {
+        static constexpr bool is_fixed_layout = STATIC;
+        uint64_t slot = 0;
+        uint32_t fee = 0;
+        bool valid = false;
+        uint16_t kind = 0;
+
+        constexpr void serialize(auto &archive) requires STATIC
+        {
+            _serialize(archive);
+        }
+
+        void serialize(auto &archive) requires (!STATIC)
+        {
+            _serialize(archive);
+        }
+    private:
+        constexpr void _serialize(auto &archive)
+        {
+            archive.process("slot", slot);
+            archive.process("fee", fee);
+            archive.process("valid", valid);
+            archive.process("kind", kind);
+        }
+    };
+
+    template<typename T>
+    void bench_fixed(ankerl::nanobench::Bench &b, const std::string &name, const T &vals)
+    {
+        uint8_vector encoded {};
+        b.run(fmt::format("{} encode", name), [&] {
+            codec::encoder enc {};
+            enc.encode(vals);
+            ankerl::nanobench::doNotOptimizeAway(enc.size());
+            encoded = enc.bytes();
+        });
+        T out {};
+        b.run(fmt::format("{} decode", name), [&] {
+            codec::decoder dec { encoded };
+            dec.decode(out);
+            ankerl::nanobench::doNotOptimizeAway(out);
+        });
+    }
+
+    // a transaction-like record of fixed-width fields, a short blob and nested ranges
+    struct record_t {
+        byte_array<32> hash {};
+        uint64_t slot = 0;
+        uint32_t fee = 0;
+        bool valid = false;
+        buffer memo {};
+        sequence_t<output_t, 256> outputs {};
+        sequence_t<uint64_t, 1024> amounts {};
+
+        void serialize(auto &archive)
+        {
+            archive.process("hash", hash);
+            archive.process("slot", slot);
+            archive.process("fee", fee);
+            archive.process("valid", valid);
+            archive.process("memo", memo);
+            archive.process("outputs", outputs);
+            archive.process("amounts", amounts);
+        }
+    };
+
+    // the hand-written equivalent of the encoder with the same layout
+    void encode_manual(uint8_vector &out, const record_t &r)
+    {
+        out.resize(64 + r.memo.size() + r.outputs.size() * 40 + r.amounts.size() * 8);
+        byte_writer w { out };
+        w.write_bytes(r.hash);
+        w.write_le(r.slot);
+        w.write_le(r.fee);
+        w.write_le(static_cast<uint8_t>(r.valid));
+        w.write_varint(r.memo.size());
+        w.write_bytes(r.memo);
+        w.write_varint(r.outputs.size());
+        for (const auto &o: r.outputs) {
+            w.write_bytes(o.address);
+            w.write_le(o.amount);
+        }
+        w.write_varint(r.amounts.size());
+        for (const auto a: r.amounts)
+            w.write_le(a);
+        out.resize(w.pos());
+    }
+
+    void decode_manual(record_t &r, const buffer data)
+    {
+        byte_reader rd { data };
+        r.hash = rd.read_bytes(32);
+        r.slot = rd.read_le<uint64_t>();
+        r.fee = rd.read_le<uint32_t>();
+        r.valid = rd.read_le<uint8_t>() != 0;
+        r.memo = rd.read_bytes(rd.read_varint());
+        r.outputs.resize(rd.read_varint());
+        for (auto &o: r.outputs) {
+            o.address = rd.read_bytes(32);
+            o.amount = rd.read_le<uint64_t>();
+        }
+        r.amounts.resize(rd.read_varint());
+        for (auto &a: r.amounts)
+            a = rd.read_le<uint64_t>();
+    }
+
+    std::vector<record_t> make_records(const size_t num, const buffer memo)
+    {
+        std::vector<record_t> records(num);
+        uint64_t x = 0x9E3779B97F4A7C15ULL;
+        for (size_t i = 0; i < num; ++i) {
+            auto &r = records[i];
+            r.hash.fill(static_cast<uint8_t>(i));
+            r.slot = i * 20;
+            r.fee = static_cast<uint32_t>(150'000 + i % 1000);
+            r.valid = i % 7 != 0;
+            r.memo = memo.subbuf(0, i % memo.size());
+            r.outputs.resize(1 + i % 4);
+            for (auto &o: r.outputs) {
+                o.address.fill(static_cast<uint8_t>(x));
+                o.amount = x >> 20U;
+                x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+            }
+            r.amounts.resize(i % 16);
+            for (auto &a: r.amounts)
+                a = i * 1'000'003;
+        }
+        return records;
+    }
+}
+
+suite codec_bench_suite = [] {
+    "turbo::common::codec"_test = [] {
+        const std::string memo_src(64, 'm');
+        const auto records = make_records(10'000, memo_src);
+        ankerl::nanobench::Bench b {};
+        b.title("turbo::common::codec binary archives")
+            .output(&std::cerr)
+            .unit("record")
+            .performanceCounters(true)
+            .relative(true)
+            .batch(records.size());
+        std::vector<uint8_vector> encoded(records.size());
+        b.run("encode hand-written", [&] {
+            for (size_t i = 0; i < records.size(); ++i)
+                encode_manual(encoded[i], records[i]);
+        });
+        b.run("codec::encoder", [&] {
+            codec::encoder enc {};
+            size_t total = 0;
+            for (const auto &r: records) {
+                enc.clear();
+                enc.encode(r);
+                total += enc.size();
+            }
+            ankerl::nanobench::doNotOptimizeAway(total);
+        });
+        b.run("codec::encode", [&] {
+            for (size_t i = 0; i < records.size(); ++i)
+                encoded[i] = codec::encode(records[i]);
+        });
+        record_t r {};
+        b.run("decode hand-written", [&] {
+            for (const auto &e: encoded)
+                decode_manual(r, e);
+            ankerl::nanobench::doNotOptimizeAway(r);
+        });
+        b.run("codec::decoder", [&] {
+            for (const auto &e: encoded) {
+                codec::decoder dec { e };
+                dec.decode(r);
+            }
+            ankerl::nanobench::doNotOptimizeAway(r);
+        });
+    };
+    "turbo::common::codec static schema"_test = [] {
+        static constexpr size_t num_items = 10'000;
+        sequence_t<output_t, num_items> outputs(num_items);
+        sequence_t<static_output_t, num_items> static_outputs(num_items);
+        sequence_t<entry_t<false>, num_items> entries(num_items);
+        sequence_t<entry_t<true>, num_items> static_entries(num_items);
+        for (size_t i = 0; i < num_items; ++i) {
+            outputs[i].address.fill(static_cast<uint8_t>(i));
+            outputs[i].amount = i * 1'000'003;
+            static_outputs[i].address = outputs[i].address;
+            static_outputs[i].amount = outputs[i].amount;
+            entries[i].slot = static_entries[i].slot = i * 20;
+            entries[i].fee = static_entries[i].fee = static_cast<uint32_t>(150'000 + i % 1000);
+            entries[i].valid = static_entries[i].valid = i % 7 != 0;
+            entries[i].kind = static_entries[i].kind = static_cast<uint16_t>(i % 5);
+        }
+        ankerl::nanobench::Bench b {};
+        b.title("turbo::common::codec fixed-size structs")
+            .output(&std::cerr)
+            .unit("item")
+            .performanceCounters(true)
+            .batch(num_items);
+        bench_fixed(b, "memcpy-able struct, serialize() walk", outputs);
+        bench_fixed(b, "memcpy-able struct, static schema", static_outputs);
+        bench_fixed(b, "padded struct, serialize() walk", entries);
+        bench_fixed(b, "padded struct, static schema", static_entries);
+    };
+};
@@ -0,0 +1,718 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <bit>
+#include <cstring>
+#include <ranges>
+#include <utility>
+#include "byte-io.hpp"
+#include "serializable.hpp"
+
+// The binary archives driven by the same serialize() methods as codec::formatter:
+// - integers, enums and floating-point values are fixed-width little-endian, bool is a single byte;
+// - varlen_uint_c values and all lengths are LEB128 varints;
+// - byte_array_like_c and fixed_array_like_c values have no length prefix since their size is known;
+// - an optional value is a presence byte followed by the value;
+// - an as_variant_t value is its index byte, after the overrides if any, followed by the alternative.
+namespace turbo::codec {
+    // The scalar types whose encoding is their in-memory representation. bool is excluded since not every byte is a valid bool.
+    template<typename T>
+    concept raw_scalar_c = (std::endian::native == std::endian::little && ((std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) || std::is_enum_v<T>))
+        || (byte_array_like_c<T> && std::is_trivially_copyable_v<T> && std::has_unique_object_representations_v<T>);
+
+    // The encoded layout of a serializable type
+    struct schema_t {
+        // the encoded size of every value of the type when fixed is set
+        size_t size = 0;
+        bool fixed = true;
+        // the encoding is the in-memory representation, so that a value is copied with a single memcpy
+        bool raw = true;
+    };
+
+    // A type opts into the fixed-size layout with a static is_fixed_layout member set to true.
+    // It promises that serialize() processes the same fields whatever their values are,
+    // since the schema is derived from a single run over a default-constructed value.
+    template<typename T>
+    concept fixed_layout_c = requires { { T::is_fixed_layout } -> std::convertible_to<bool>; } && static_cast<bool>(T::is_fixed_layout);
+
+    // Derives the schema by running serialize() of a default-constructed value in a constant expression.
+    // The encoding is raw when the fields are raw scalars serialized in the order of their addresses and cover the whole type.
+    struct schema_archive: archive_t {
+        constexpr void push(const std::string_view)
+        {
+        }
+
+        constexpr void pop()
+        {
+        }
+
+        template<typename T>
+        constexpr void add(T &val)
+        {
+            if constexpr (serializable_c<T>) {
+                val.serialize(*this);
+            } else if constexpr (raw_scalar_c<T>) {
+                _add_field(&val, sizeof(T));
+            } else if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>) {
+                _add_field(&val, sizeof(T));
+                _schema.raw = false;
+            } else if constexpr (byte_array_like_c<T>) {
+                _add_field(&val, val.size());
+                _schema.raw = false;
+            } else if constexpr (fixed_array_like_c<T>) {
+                for (auto &v: val)
+                    add(v);
+            } else {
+                _schema.fixed = false;
+                _schema.raw = false;
+            }
+        }
+
+        constexpr void process(auto &val)
+        {
+            add(val);
+        }
+
+        constexpr void process(const std::string_view, auto &val)
+        {
+            add(val);
+        }
+
+        template<typename T>
+        constexpr void process(as_variant_t<T>)
+        {
+            _schema.fixed = false;
+            _schema.raw = false;
+        }
+
+        template<typename T>
+        constexpr void process(const std::string_view, as_variant_t<T> av)
+        {
+            process(av);
+        }
+
+        [[nodiscard]] constexpr schema_t schema() const noexcept
+        {
+            return _schema;
+        }
+    private:
+        schema_t _schema {};
+        const void *_last = nullptr;
+
+        constexpr void _add_field(const void *p, const size_t sz)
+        {
+            if (_last && !(_last < p))
+                _schema.raw = false;
+            _last = p;
+            _schema.size += sz;
+        }
+    };
+
+    template<typename T>
+    [[nodiscard]] constexpr schema_t schema_of()
+    {
+        T val {};
+        schema_archive a {};
+        a.add(val);
+        auto s = a.schema();
+        s.raw = s.raw && s.fixed && s.size == sizeof(T) && std::is_trivially_copyable_v<T> && std::has_unique_object_representations_v<T>;
+        if (!s.fixed)
+            s.size = 0;
+        return s;
+    }
+
+    // The schema is available when the type opts into the fixed layout, serialize() is constexpr
+    // and the type can be default-constructed in a constant expression.
+    template<typename T>
+    concept static_schema_c = serializable_c<T> && fixed_layout_c<T> && std::is_default_constructible_v<T>
+        && requires { typename std::integral_constant<size_t, schema_of<T>().size>; };
+
+    // The values are encoded and decoded with a single size check and a single memcpy per value or contiguous range.
+    template<typename T>
+    concept raw_encoded_c = raw_scalar_c<T> || (static_schema_c<T> && schema_of<T>().raw);
+
+    template<typename T>
+    concept raw_encoded_range_c = std::ranges::contiguous_range<T> && raw_encoded_c<std::ranges::range_value_t<T>>;
+
+    // The values have a precomputed encoded size, so a value or a range is written and read with a single size check.
+    template<typename T>
+    concept fixed_size_c = static_schema_c<T> && schema_of<T>().fixed;
+
+    // Writes the fixed-size values into the memory reserved for them by encoder.
+    // Debug builds check every write against the reserved memory to catch a serialize() that breaks the fixed-layout promise.
+    struct fixed_writer: archive_t {
+        explicit fixed_writer(uint8_t *out, [[maybe_unused]] const size_t size) noexcept:
+            _out { out }
+#ifndef NDEBUG
+            , _end { out + size }
+#endif
+        {
+        }
+
+        // throws in debug builds when fewer bytes than reserved have been written
+        void finish() const
+        {
+#ifndef NDEBUG
+            if (_out != _end) [[unlikely]]
+                throw error(fmt::format("a fixed-layout value wrote {} bytes less than its schema size", _end - _out));
+#endif
+        }
+
+        void push(const std::string_view)
+        {
+        }
+
+        void pop()
+        {
+        }
+
+        template<typename T>
+        void encode(const T &val)
+        {
+            if constexpr (raw_encoded_c<T>) {
+                memcpy(_take(sizeof(T)), &val, sizeof(T));
+            } else if constexpr (serializable_c<T>) {
+                const_cast<T &>(val).serialize(*this);
+            } else if constexpr (fixed_array_like_c<T>) {
+                for (const auto &v: val)
+                    encode(v);
+            } else if constexpr (byte_array_like_c<T>) {
+                memcpy(_take(val.size()), val.data(), val.size());
+            } else if constexpr (std::is_same_v<T, bool>) {
+                *_take(1) = static_cast<uint8_t>(val);
+            } else if constexpr (std::is_enum_v<T>) {
+                encode(static_cast<std::underlying_type_t<T>>(val));
+            } else if constexpr (std::is_integral_v<T>) {
+                const auto le = host_to_le(val);
+                memcpy(_take(sizeof(T)), &le, sizeof(T));
+            } else if constexpr (std::is_floating_point_v<T>) {
+                if constexpr (sizeof(T) == sizeof(uint64_t))
+                    encode(std::bit_cast<uint64_t>(val));
+                else
+                    encode(std::bit_cast<uint32_t>(val));
+            } else {
+                throw error(fmt::format("type {} does not have a fixed encoded size", typeid(T).name()));
+            }
+        }
+
+        void process(const auto &val)
+        {
+            encode(val);
+        }
+
+        void process(const std::string_view, const auto &val)
+        {
+            encode(val);
+        }
+    private:
+        uint8_t *_out;
+#ifndef NDEBUG
+        uint8_t *_end;
+#endif
+
+        uint8_t *_take(const size_t num)
+        {
+#ifndef NDEBUG
+            if (num > static_cast<size_t>(_end - _out)) [[unlikely]]
+                throw error("a fixed-layout value writes past its schema size");
+#endif
+            return std::exchange(_out, _out + num);
+        }
+    };
+
+    // Reads the fixed-size values from the data whose size decoder has checked already.
+    // Debug builds check every read against that data to catch a serialize() that breaks the fixed-layout promise.
+    struct fixed_reader: archive_t {
+        explicit fixed_reader(const buffer data) noexcept:
+            _data { data.data() }
+#ifndef NDEBUG
+            , _end { data.data() + data.size() }
+#endif
+        {
+        }
+
+        // throws in debug builds when fewer bytes than checked have been read
+        void finish() const
+        {
+#ifndef NDEBUG
+            if (_data != _end) [[unlikely]]
+                throw error(fmt::format("a fixed-layout value read {} bytes less than its schema size", _end - _data));
+#endif
+        }
+
+        void push(const std::string_view)
+        {
+        }
+
+        void pop()
+        {
+        }
+
+        template<typename T>
+        void decode(T &val)
+        {
+            if constexpr (raw_encoded_c<T>) {
+                memcpy(&val, _take(sizeof(T)), sizeof(T));
+            } else if constexpr (serializable_c<T>) {
+                val.serialize(*this);
+            } else if constexpr (fixed_array_like_c<T>) {
+                for (auto &v: val)
+                    decode(v);
+            } else if constexpr (byte_array_like_c<T>) {
+                memcpy(val.data(), _take(val.size()), val.size());
+            } else if constexpr (std::is_same_v<T, bool>) {
+                const auto b = *_take(1);
+                if (b > 1) [[unlikely]]
+                    throw error(fmt::format("an invalid bool value {}", b));
+                val = b;
+            } else if constexpr (std::is_enum_v<T>) {
+                std::underlying_type_t<T> v;
+                decode(v);
+                val = static_cast<T>(v);
+            } else if constexpr (std::is_integral_v<T>) {
+                memcpy(&val, _take(sizeof(T)), sizeof(T));
+                val = le_to_host(val);
+            } else if constexpr (std::is_floating_point_v<T>) {
+                std::conditional_t<sizeof(T) == sizeof(uint64_t), uint64_t, uint32_t> v;
+                decode(v);
+                val = std::bit_cast<T>(v);
+            } else {
+                throw error(fmt::format("type {} does not have a fixed encoded size", typeid(T).name()));
+            }
+        }
+
+        void process(auto &val)
+        {
+            decode(val);
+        }
+
+        void process(const std::string_view, auto &val)
+        {
+            decode(val);
+        }
+    private:
+        const uint8_t *_data;
+#ifndef NDEBUG
+        const uint8_t *_end;
+#endif
+
+        const uint8_t *_take(const size_t num)
+        {
+#ifndef NDEBUG
+            if (num > static_cast<size_t>(_end - _data)) [[unlikely]]
+                throw error("a fixed-layout value reads past its schema size");
+#endif
+            return std::exchange(_data, _data + num);
+        }
+    };
+
+    struct encoder: archive_t {
+        explicit encoder(const size_t reserve=0x100):
+            _out(reserve)
+        {
+        }
+
+        // the bytes encoded so far; they stay valid until the next write
+        [[nodiscard]] buffer bytes() const noexcept
+        {
+            return { _out.data(), _pos };
+        }
+
+        [[nodiscard]] size_t size() const noexcept
+        {
+            return _pos;
+        }
+
+        // allows to reuse the allocated memory for the next value
+        void clear() noexcept
+        {
+            _pos = 0;
+        }
+
+        // hands over the encoded bytes without a copy and leaves the encoder empty
+        [[nodiscard]] default_init_uint8_vector take()
+        {
+            _out.resize(_pos);
+            _pos = 0;
+            return std::move(_out);
+        }
+
+        void push(const std::string_view)
+        {
+        }
+
+        void pop()
+        {
+        }
+
+        template<typename T>
+        void encode(const T &val)
+        {
+            if constexpr (serializable_c<T>) {
+                if constexpr (raw_encoded_c<T>) {
+                    write_bytes(buffer { reinterpret_cast<const uint8_t *>(&val), sizeof(T) });
+                } else if constexpr (fixed_size_c<T>) {
+                    _encode_fixed(std::span<const T> { &val, 1 });
+                } else {
+                    // serialize() is non-const since it is used for decoding as well; the encoder only reads through it
+                    const_cast<T &>(val).serialize(*this);
+                }
+            } else if constexpr (varlen_uint_c<T>) {
+                write_varint(val.value());
+            } else if constexpr (optional_like_c<T>) {
+                _write_fixed(static_cast<uint8_t>(val.has_value()));
+                if (val.has_value())
+                    encode(*val);
+            } else if constexpr (fixed_array_like_c<T>) {
+                _encode_elements(val);
+            } else if constexpr (bounded_range_c<T>) {
+                check_bounds(val);
+                write_varint(std::ranges::size(val));
+                _encode_elements(val);
+            } else if constexpr (map_like_c<T>) {
+                write_varint(val.size());
+                if constexpr (has_foreach_c<T>) {
+                    val.foreach([&](const auto &k, const auto &v) {
+                        encode(k);
+                        encode(v);
+                    });
+                } else {
+                    for (const auto &[k, v]: val) {
+                        encode(k);
+                        encode(v);
+                    }
+                }
+            } else if constexpr (byte_array_like_c<T>) {
+                write_bytes(buffer { val.data(), val.size() });
+            } else if constexpr (byte_sequence_like_c<T>) {
+                _write_sized(buffer { val.data(), val.size() });
+            } else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> || std::is_same_v<T, buffer>) {
+                _write_sized(buffer { val });
+            } else if constexpr (std::is_same_v<T, bool>) {
+                _write_fixed(static_cast<uint8_t>(val));
+            } else if constexpr (std::is_enum_v<T>) {
+                _write_fixed(static_cast<std::underlying_type_t<T>>(val));
+            } else if constexpr (std::is_integral_v<T>) {
+                _write_fixed(val);
+            } else if constexpr (std::is_floating_point_v<T>) {
+                if constexpr (sizeof(T) == sizeof(uint64_t))
+                    _write_fixed(std::bit_cast<uint64_t>(val));
+                else
+                    _write_fixed(std::bit_cast<uint32_t>(val));
+            } else {
+                throw error(fmt::format("binary serialization is not enabled for type {}", typeid(T).name()));
+            }
+        }
+
+        void process(const auto &val)
+        {
+            encode(val);
+        }
+
+        void process(const std::string_view, const auto &val)
+        {
+            encode(val);
+        }
+
+        template<typename T>
+        void process(as_variant_t<T> av)
+        {
+            const auto idx = av.val.index();
+            const auto code = av.overrides ? av.overrides->encode_index(idx) : idx;
+            if (code > std::numeric_limits<uint8_t>::max()) [[unlikely]]
+                throw error(fmt::format("the alternative {} of {} does not fit into the index byte", idx, typeid(T).name()));
+            _write_fixed(static_cast<uint8_t>(code));
+            std::visit([&](const auto &v) {
+                encode(v);
+            }, av.val);
+        }
+
+        template<typename T>
+        void process(const std::string_view, as_variant_t<T> av)
+        {
+            process(av);
+        }
+
+        void write_varint(const uint64_t val)
+        {
+            _reserve(varint::max_size);
+            _pos += varint::encode(_out.data() + _pos, val);
+        }
+
+        void write_bytes(const buffer data)
+        {
+            _reserve(data.size());
+            if (!data.empty())
+                memcpy(_out.data() + _pos, data.data(), data.size());
+            _pos += data.size();
+        }
+    private:
+        default_init_uint8_vector _out;
+        size_t _pos = 0;
+
+        void _reserve(const size_t num)
+        {
+            if (_out.size() - _pos < num) [[unlikely]]
+                _out.resize(std::max(_out.size() * 2, _pos + num));
+        }
+
+        template<std::integral T>
+        void _write_fixed(const T val)
+        {
+            _reserve(sizeof(T));
+            const auto le = host_to_le(val);
+            memcpy(_out.data() + _pos, &le, sizeof(T));
+            _pos += sizeof(T);
+        }
+
+        void _write_sized(const buffer data)
+        {
+            write_varint(data.size());
+            write_bytes(data);
+        }
+
+        template<typename T>
+        void _encode_fixed(const T &vals)
+        {
+            const auto num = std::ranges::size(vals) * schema_of<std::ranges::range_value_t<T>>().size;
+            _reserve(num);
+            fixed_writer w { _out.data() + _pos, num };
+            for (const auto &v: vals)
+                w.encode(v);
+            w.finish();
+            _pos += num;
+        }
+
+        template<typename T>
+        void _encode_elements(const T &val)
+        {
+            if constexpr (raw_encoded_range_c<T>) {
+                write_bytes(buffer { reinterpret_cast<const uint8_t *>(std::ranges::data(val)), std::ranges::size(val) * sizeof(std::ranges::range_value_t<T>) });
+            } else if constexpr (fixed_size_c<std::ranges::range_value_t<T>>) {
+                _encode_fixed(val);
+            } else {
+                for (const auto &v: val)
+                    encode(v);
+            }
+        }
+    };
+
+    // The string_view and buffer values are decoded as slices of the input without a copy,
+    // so the input must outlive them. The other values own their data.
+    struct decoder: archive_t {
+        explicit decoder(const buffer data) noexcept:
+            _r { data }
+        {
+        }
+
+        [[nodiscard]] size_t pos() const noexcept
+        {
+            return _r.pos();
+        }
+
+        [[nodiscard]] bool eof() const noexcept
+        {
+            return _r.eof();
+        }
+
+        void push(const std::string_view)
+        {
+        }
+
+        void pop()
+        {
+        }
+
+        template<typename T>
+        void decode(T &val)
+        {
+            if constexpr (serializable_c<T>) {
+                if constexpr (raw_encoded_c<T>) {
+                    const auto bytes = _r.read_bytes(sizeof(T));
+                    memcpy(&val, bytes.data(), sizeof(T));
+                } else if constexpr (fixed_size_c<T>) {
+                    fixed_reader fr { _r.read_bytes(schema_of<T>().size) };
+                    fr.decode(val);
+                    fr.finish();
+                } else {
+                    val.serialize(*this);
+                }
+            } else if constexpr (varlen_uint_c<T>) {
+                using base_type = typename T::base_type;
+                const auto v = _r.read_varint();
+                if (v > static_cast<uint64_t>(std::numeric_limits<base_type>::max())) [[unlikely]]
+                    throw error(fmt::format("a value {} at offset {} does not fit into {}", v, _r.pos(), typeid(T).name()));
+                val = static_cast<base_type>(v);
+            } else if constexpr (optional_like_c<T>) {
+                if (_read_bool()) {
+                    val.emplace();
+                    decode(*val);
+                } else {
+                    val.reset();
+                }
+            } else if constexpr (fixed_array_like_c<T>) {
+                if constexpr (raw_encoded_range_c<T>) {
+                    _read_raw(val, std::ranges::size(val));
+                } else {
+                    for (auto &v: val)
+                        decode(v);
+                }
+            } else if constexpr (bounded_range_c<T>) {
+                const auto sz = _r.read_varint();
+                check_bounds<T>(sz);
+                _decode_range(val, sz);
+            } else if constexpr (map_like_c<T>) {
+                const auto sz = _r.read_varint();
+                val.clear();
+                for (size_t i = 0; i < sz; ++i) {
+                    typename T::key_type k {};
+                    decode(k);
+                    typename T::mapped_type v {};
+                    decode(v);
+                    if constexpr (has_emplace_c<T>)
+                        val.emplace_hint_unique(val.end(), typename T::value_type { std::move(k), std::move(v) });
+                    else
+                        val.emplace_hint(val.end(), std::move(k), std::move(v));
+                }
+                _check_unique(val, sz);
+            } else if constexpr (byte_array_like_c<T>) {
+                const auto bytes = _r.read_bytes(val.size());
+                memcpy(val.data(), bytes.data(), bytes.size());
+            } else if constexpr (byte_sequence_like_c<T>) {
+                const auto bytes = _read_sized();
+                val.resize(bytes.size());
+                if (!bytes.empty())
+                    memcpy(val.data(), bytes.data(), bytes.size());
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                val = static_cast<std::string_view>(_read_sized());
+            } else if constexpr (std::is_same_v<T, std::string_view> || std::is_same_v<T, buffer>) {
+                val = T { _read_sized() };
+            } else if constexpr (std::is_same_v<T, bool>) {
+                val = _read_bool();
+            } else if constexpr (std::is_enum_v<T>) {
+                val = static_cast<T>(_r.read_le<std::underlying_type_t<T>>());
+            } else if constexpr (std::is_integral_v<T>) {
+                val = _r.read_le<T>();
+            } else if constexpr (std::is_floating_point_v<T>) {
+                if constexpr (sizeof(T) == sizeof(uint64_t))
+                    val = std::bit_cast<T>(_r.read_le<uint64_t>());
+                else
+                    val = std::bit_cast<T>(_r.read_le<uint32_t>());
+            } else {
+                throw error(fmt::format("binary serialization is not enabled for type {}", typeid(T).name()));
+            }
+        }
+
+        void process(auto &val)
+        {
+            decode(val);
+        }
+
+        void process(const std::string_view, auto &val)
+        {
+            decode(val);
+        }
+
+        template<typename T>
+        void process(as_variant_t<T> av)
+        {
+            const auto code = _r.read_le<uint8_t>();
+            variant_set_type(av.val, av.overrides ? av.overrides->decode_index(code) : code, *this);
+        }
+
+        template<typename T>
+        void process(const std::string_view, as_variant_t<T> av)
+        {
+            process(av);
+        }
+    private:
+        byte_reader _r;
+
+        bool _read_bool()
+        {
+            const auto b = _r.read_le<uint8_t>();
+            if (b > 1) [[unlikely]]
+                throw error(fmt::format("an invalid bool value {} at offset {}", b, _r.pos() - 1));
+            return b;
+        }
+
+        buffer _read_sized()
+        {
+            return _r.read_bytes(_r.read_varint());
+        }
+
+        template<typename T>
+        void _read_raw(T &val, const size_t sz)
+        {
+            using value_type = std::ranges::range_value_t<T>;
+            if (sz > _r.remaining() / sizeof(value_type)) [[unlikely]]
+                throw error(fmt::format("{} elements of {} bytes at offset {} are past the end of the data", sz, sizeof(value_type), _r.pos()));
+            if constexpr (requires { val.resize(sz); })
+                val.resize(sz);
+            const auto bytes = _r.read_bytes_unchecked(sz * sizeof(value_type));
+            if (!bytes.empty())
+                memcpy(std::ranges::data(val), bytes.data(), bytes.size());
+        }
+
+        template<typename T>
+        void _decode_range(T &val, const size_t sz)
+        {
+            using value_type = std::ranges::range_value_t<T>;
+            if constexpr (raw_encoded_range_c<T> && requires { val.resize(sz); }) {
+                _read_raw(val, sz);
+            } else if constexpr (fixed_size_c<value_type> && schema_of<value_type>().size > 0 && requires { val.resize(sz); }) {
+                static constexpr auto value_size = schema_of<value_type>().size;
+                if (sz > _r.remaining() / value_size) [[unlikely]]
+                    throw error(fmt::format("{} elements of {} bytes at offset {} are past the end of the data", sz, value_size, _r.pos()));
+                val.resize(sz);
+                fixed_reader fr { _r.read_bytes_unchecked(sz * value_size) };
+                for (auto &v: val)
+                    fr.decode(v);
+                fr.finish();
+            } else {
+                // the elements are appended one by one, so that a corrupt size cannot force a large allocation up front
+                val.clear();
+                if constexpr (requires { val.reserve(sz); })
+                    val.reserve(std::min(sz, _r.remaining()));
+                for (size_t i = 0; i < sz; ++i) {
+                    value_type v {};
+                    decode(v);
+                    if constexpr (has_emplace_c<T>)
+                        val.emplace_hint_unique(val.end(), std::move(v));
+                    else
+                        val.insert(val.end(), std::move(v));
+                }
+                _check_unique(val, sz);
+            }
+        }
+
+        // the sets and maps silently drop the repeated keys
+        void _check_unique(const auto &val, const size_t sz) const
+        {
+            if (val.size() != sz) [[unlikely]]
+                throw error(fmt::format("the {} elements before offset {} have repeated keys", sz, _r.pos()));
+        }
+    };
+
+    template<typename T>
+    [[nodiscard]] default_init_uint8_vector encode(const T &val)
+    {
+        encoder enc {};
+        enc.encode(val);
+        return enc.take();
+    }
+
+    // throws if the data has bytes past the end of the value
+    template<typename T>
+        requires std::is_default_constructible_v<T>
+    [[nodiscard]] T decode(const buffer data)
+    {
+        decoder dec { data };
+        T res;
+        dec.decode(res);
+        if (!dec.eof()) [[unlikely]]
+            throw error(fmt::format("{} bytes are left after the end of {}", data.size() - dec.pos(), typeid(T).name()));
+        return res;
+    }
+}
@@ -0,0 +1,391 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <map>
+#include <optional>
+#include <set>
+#include <turbo/common/test.hpp>
+#include "codec.hpp"
+
+namespace {
+    using namespace turbo;
+    using namespace turbo::codec;
+
+    template<typename T, size_t MAX=1000>
+    struct sequence_t: std::vector<T> {
+        static constexpr size_t min_size = 0;
+        static constexpr size_t max_size = MAX;
+        using std::vector<T>::vector;
+    };
+
+    template<typename T>
+    struct set_t: std::set<T> {
+        static constexpr size_t min_size = 0;
+        static constexpr size_t max_size = 1000;
+        using std::set<T>::set;
+    };
+
+    template<typename T, size_t SZ>
+    struct fixed_sequence_t: std::array<T, SZ> {
+        static constexpr bool is_element_sequence = true;
+    };
+
+    template<typename K, typename V>
+    struct map_t: std::map<K, V> {
+        struct config_t {
+            std::string_view key_name;
+            std::string_view val_name;
+        };
+
+        static constexpr config_t config()
+        {
+            return { "key", "value" };
+        }
+
+        using std::map<K, V>::map;
+    };
+
+    template<typename T>
+    struct varlen_t {
+        using base_type = T;
+
+        varlen_t &operator=(const base_type v)
+        {
+            _val = v;
+            return *this;
+        }
+
+        [[nodiscard]] base_type value() const
+        {
+            return _val;
+        }
+    private:
+        base_type _val = 0;
+    };
+
+    enum class kind_t: uint16_t {
+        alpha = 1,
+        beta = 0x1234
+    };
+
+    struct point_t {
+        uint32_t x = 0;
+        int16_t y = 0;
+
+        void serialize(auto &archive)
+        {
+            archive.process("x", x);
+            archive.process("y", y);
+        }
+
+        bool operator==(const point_t &) const =default;
+    };
+
+    // the types that opt into the fixed layout and have a constexpr serialize() get a schema at compile time
+    struct raw_point_t {
+        static constexpr bool is_fixed_layout = true;
+        uint32_t x = 0;
+        int32_t y = 0;
+
+        constexpr void serialize(auto &archive)
+        {
+            archive.process("x", x);
+            archive.process("y", y);
+        }
+
+        bool operator==(const raw_point_t &) const =default;
+    };
+
+    struct swapped_point_t {
+        static constexpr bool is_fixed_layout = true;
+        uint32_t x = 0;
+        int32_t y = 0;
+
+        constexpr void serialize(auto &archive)
+        {
+            archive.process("y", y);
+            archive.process("x", x);
+        }
+
+        bool operator==(const swapped_point_t &) const =default;
+    };
+
+    struct flagged_t {
+        static constexpr bool is_fixed_layout = true;
+        uint32_t x = 0;
+        bool active = false;
+        kind_t kind = kind_t::alpha;
+        byte_array<4> tag {};
+
+        constexpr void serialize(auto &archive)
+        {
+            archive.process("x", x);
+            archive.process("active", active);
+            archive.process("kind", kind);
+            archive.process("tag", tag);
+        }
+
+        bool operator==(const flagged_t &) const =default;
+    };
+
+    // the size depends on the values, so the type must not opt into the fixed layout
+    template<bool FIXED>
+    struct conditional_t {
+        static constexpr bool is_fixed_layout = FIXED;
+        uint8_t tag = 0;
+        uint64_t extra = 0;
+
+        constexpr void serialize(auto &archive)
+        {
+            archive.process("tag", tag);
+            if (tag)
+                archive.process("extra", extra);
+        }
+    };
+
+    struct named_t {
+        static constexpr bool is_fixed_layout = true;
+        uint32_t x = 0;
+        std::string name {};
+
+        constexpr void serialize(auto &archive)
+        {
+            archive.process("x", x);
+            archive.process("name", name);
+        }
+    };
+
+    static_assert(schema_of<raw_point_t>().raw && schema_of<raw_point_t>().size == 8);
+    static_assert(raw_encoded_range_c<sequence_t<raw_point_t>>);
+    static_assert(fixed_size_c<swapped_point_t> && !raw_encoded_c<swapped_point_t>);
+    static_assert(fixed_size_c<flagged_t> && !raw_encoded_c<flagged_t> && schema_of<flagged_t>().size == 11);
+    static_assert(static_schema_c<named_t> && !fixed_size_c<named_t>);
+    static_assert(!static_schema_c<point_t>);
+    static_assert(!static_schema_c<conditional_t<false>> && !fixed_size_c<conditional_t<false>>);
+
+    using value_t = std::variant<uint32_t, std::string, point_t>;
+    static const variant_names_t<value_t> value_names { "uint", "string", "point" };
+
+    struct record_t {
+        uint64_t id = 0;
+        bool active = false;
+        kind_t kind = kind_t::alpha;
+        double score = 0.0;
+        varlen_t<uint64_t> fee {};
+        std::string name {};
+        std::string_view label {};
+        buffer payload {};
+        byte_array<32> hash {};
+        uint8_vector extra {};
+        std::optional<uint32_t> ttl {};
+        std::optional<point_t> origin {};
+        fixed_sequence_t<uint16_t, 3> dims {};
+        sequence_t<uint64_t> amounts {};
+        sequence_t<point_t> points {};
+        set_t<uint32_t> tags {};
+        map_t<std::string, uint64_t> balances {};
+        value_t value {};
+
+        void serialize(auto &archive)
+        {
+            archive.process("id", id);
+            archive.process("active", active);
+            archive.process("kind", kind);
+            archive.process("score", score);
+            archive.process("fee", fee);
+            archive.process("name", name);
+            archive.process("label", label);
+            archive.process("payload", payload);
+            archive.process("hash", hash);
+            archive.process("extra", extra);
+            archive.process("ttl", ttl);
+            archive.process("origin", origin);
+            archive.process("dims", dims);
+            archive.process("amounts", amounts);
+            archive.process("points", points);
+            archive.process("tags", tags);
+            archive.process("balances", balances);
+            archive.process("value", as_variant(value, value_names));
+        }
+    };
+
+    template<typename T>
+    std::string encode_hex(const T &val)
+    {
+        return fmt::format("{}", encode(val));
+    }
+}
+
+suite turbo_common_codec_suite = [] {
+    "turbo::common::codec"_test = [] {
+        "encoding"_test = [] {
+            expect_equal(std::string { "0300000007FF" }, encode_hex(point_t { 3, -249 }));
+            expect_equal(std::string { "01" }, encode_hex(true));
+            expect_equal(std::string { "3412" }, encode_hex(kind_t::beta));
+            expect_equal(std::string { "03616263" }, encode_hex(std::string { "abc" }));
+            expect_equal(std::string { "00" }, encode_hex(std::optional<uint32_t> {}));
+            expect_equal(std::string { "0105000000" }, encode_hex(std::optional<uint32_t> { 5 }));
+            // the lengths and varlen_uint_c values are varints
+            varlen_t<uint64_t> fee {};
+            fee = 300;
+            expect_equal(std::string { "AC02" }, encode_hex(fee));
+            expect_equal(std::string { "03010002000300" }, encode_hex(sequence_t<uint16_t> { 1, 2, 3 }));
+            expect_equal(std::string { "0201000000FFFF02000000FEFF" }, encode_hex(sequence_t<point_t> { { 1, -1 }, { 2, -2 } }));
+            // no length prefix for the values of a fixed size
+            expect_equal(std::string { "010002000300" }, encode_hex(fixed_sequence_t<uint16_t, 3> { 1, 2, 3 }));
+            expect_equal(std::string(64, '0'), encode_hex(byte_array<32> {}));
+            expect_equal(std::string { "0201610A0000000000000001621400000000000000" }, encode_hex(map_t<std::string, uint64_t> { { "a", 10 }, { "b", 20 } }));
+        };
+        "round trip"_test = [] {
+            const std::string label_src { "a borrowed label" };
+            const auto payload_src = uint8_vector::from_hex("DEADBEEF");
+            record_t r {};
+            r.id = 0x0123456789ABCDEFULL;
+            r.active = true;
+            r.kind = kind_t::beta;
+            r.score = -1.5;
+            r.fee = 1'000'000;
+            r.name = "record";
+            r.label = label_src;
+            r.payload = payload_src;
+            r.hash = byte_array<32>::from_hex("00112233445566778899AABBCCDDEEFF00112233445566778899AABBCCDDEEFF");
+            r.extra = uint8_vector::from_hex("0102");
+            r.ttl = 77;
+            r.origin = point_t { 5, -5 };
+            r.dims = { 1, 2, 3 };
+            r.amounts = { 1, 0xFFFFFFFFFFFFFFFFULL, 3 };
+            r.points = { { 1, 2 }, { 3, 4 } };
+            r.tags = { 9, 3, 7 };
+            r.balances = { { "alice", 10 }, { "bob", 20 } };
+            r.value = point_t { 8, 9 };
+            const auto bytes = encode(r);
+            const auto d = decode<record_t>(bytes);
+            expect_equal(r.id, d.id);
+            expect(d.active);
+            expect(r.kind == d.kind);
+            expect_equal(r.score, d.score);
+            expect_equal(r.fee.value(), d.fee.value());
+            expect_equal(r.name, d.name);
+            expect_equal(r.label, d.label);
+            expect_equal(r.payload, d.payload);
+            expect_equal(r.hash, d.hash);
+            expect_equal(r.extra, d.extra);
+            expect(r.ttl == d.ttl);
+            expect(r.origin == d.origin);
+            expect(r.dims == d.dims);
+            expect(r.amounts == d.amounts);
+            expect(r.points == d.points);
+            expect(r.tags == d.tags);
+            expect(r.balances == d.balances);
+            expect(r.value == d.value);
+            // the views point into the encoded data instead of owning copies
+            const buffer encoded { bytes };
+            expect(d.label.data() >= reinterpret_cast<const char *>(encoded.data()) && d.label.data() < reinterpret_cast<const char *>(encoded.data() + encoded.size()));
+            expect(d.payload.data() >= encoded.data() && d.payload.data() < encoded.data() + encoded.size());
+            // an encoder is reusable
+            encoder enc { 1 };
+            enc.encode(r);
+            expect_equal(bytes, uint8_vector { enc.bytes() });
+            enc.clear();
+            enc.encode(r);
+            expect_equal(bytes, uint8_vector { enc.bytes() });
+            const auto taken = enc.take();
+            expect_equal(bytes, taken);
+            expect_equal(0U, enc.size());
+            enc.encode(r);
+            expect_equal(bytes, uint8_vector { enc.bytes() });
+        };
+        "conditional fields"_test = [] {
+            using rec_t = conditional_t<false>;
+            expect_equal(std::string { "00" }, encode_hex(rec_t {}));
+            expect_equal(std::string { "010700000000000000" }, encode_hex(rec_t { 1, 7 }));
+            expect_equal(7U, decode<rec_t>(encode(rec_t { 1, 7 })).extra);
+            // the missing field is detected instead of being read past the end of the data
+            const auto truncated = uint8_vector::from_hex("01");
+            expect(throws([&] { (void)decode<rec_t>(truncated); }));
+#ifndef NDEBUG
+            // debug builds catch the types that opt into the fixed layout without having one
+            using bad_rec_t = conditional_t<true>;
+            expect_equal(1U, schema_of<bad_rec_t>().size);
+            expect(throws([&] { (void)encode(bad_rec_t { 1, 7 }); }));
+            expect(throws([&] { (void)decode<bad_rec_t>(truncated); }));
+#endif
+        };
+        "static schema"_test = [] {
+            // the encoding does not depend on the way it is produced
+            expect_equal(std::string { "01000000FFFFFFFF" }, encode_hex(raw_point_t { 1, -1 }));
+            expect_equal(std::string { "FFFFFFFF01000000" }, encode_hex(swapped_point_t { 1, -1 }));
+            const flagged_t f { 5, true, kind_t::beta, byte_array<4>::from_hex("A1A2A3A4") };
+            expect_equal(std::string { "05000000013412A1A2A3A4" }, encode_hex(f));
+            expect_equal(std::string { "0101000000FEFFFFFF" }, encode_hex(sequence_t<raw_point_t> { { 1, -2 } }));
+            expect_equal(std::string { "0105000000013412A1A2A3A4" }, encode_hex(sequence_t<flagged_t> { f }));
+            sequence_t<raw_point_t> raw_points {};
+            sequence_t<swapped_point_t> swapped_points {};
+            sequence_t<flagged_t> flags {};
+            for (uint32_t i = 0; i < 100; ++i) {
+                raw_points.emplace_back(i, -static_cast<int32_t>(i));
+                swapped_points.emplace_back(i, static_cast<int32_t>(i * 3));
+                flags.emplace_back(i, i % 2 == 0, i % 3 == 0 ? kind_t::alpha : kind_t::beta, byte_array<4> {});
+            }
+            expect(raw_points == decode<decltype(raw_points)>(encode(raw_points)));
+            expect(swapped_points == decode<decltype(swapped_points)>(encode(swapped_points)));
+            expect(flags == decode<decltype(flags)>(encode(flags)));
+            expect(f == decode<flagged_t>(encode(f)));
+            named_t n { 7, "name" };
+            const auto d = decode<named_t>(encode(n));
+            expect_equal(n.x, d.x);
+            expect_equal(n.name, d.name);
+            // the fixed-size values are checked as a whole
+            const auto bytes = encode(flags);
+            expect(throws([&] { (void)decode<decltype(flags)>(static_cast<buffer>(bytes).subbuf(0, bytes.size() - 1)); }));
+            expect(throws([&] { (void)decode<flagged_t>(uint8_vector::from_hex("05000000013412A1A2A3")); }));
+            expect(throws([&] { (void)decode<flagged_t>(uint8_vector::from_hex("05000000023412A1A2A3A4")); }));
+            expect(throws([&] { (void)decode<sequence_t<raw_point_t>>(uint8_vector::from_hex("E807")); }));
+        };
+        "variant index overrides"_test = [] {
+            static const variant_index_overrides_t overrides { { 10, 0 }, { 11, 1 } };
+            value_t v { std::string { "x" } };
+            encoder enc {};
+            enc.process(as_variant(v, value_names, &overrides));
+            expect_equal(uint8_vector::from_hex("0B0178"), uint8_vector { enc.bytes() });
+            value_t d {};
+            decoder dec { enc.bytes() };
+            dec.process(as_variant(d, value_names, &overrides));
+            expect(v == d);
+            // the alternatives without an override keep their index
+            v = point_t { 1, 2 };
+            enc.clear();
+            enc.process(as_variant(v, value_names, &overrides));
+            decoder dec2 { enc.bytes() };
+            dec2.process(as_variant(d, value_names, &overrides));
+            expect(v == d);
+        };
+        "errors"_test = [] {
+            // truncated data
+            const auto bytes = encode(point_t { 1, 2 });
+            expect(throws([&] { (void)decode<point_t>(static_cast<buffer>(bytes).subbuf(0, bytes.size() - 1)); }));
+            // trailing data
+            auto longer = bytes;
+            longer << uint8_t { 0 };
+            expect(throws([&] { (void)decode<point_t>(longer); }));
+            // the bounds of ranges are checked on both sides
+            expect(throws([&] { (void)encode(sequence_t<uint8_t, 2> { 1, 2, 3 }); }));
+            expect(throws([&] { (void)decode<sequence_t<uint16_t, 2>>(uint8_vector::from_hex("03010002000300")); }));
+            // a corrupt size must not cause a large allocation
+            expect(throws([&] { (void)decode<sequence_t<uint64_t>>(uint8_vector::from_hex("E807")); }));
+            expect(throws([&] { (void)decode<sequence_t<point_t>>(uint8_vector::from_hex("E807")); }));
+            expect(throws([&] { (void)decode<std::string>(uint8_vector::from_hex("FFFFFFFFFFFFFFFFFF01")); }));
+            // repeated keys
+            expect(throws([&] { (void)decode<set_t<uint32_t>>(uint8_vector::from_hex("020100000001000000")); }));
+            expect(throws([&] { (void)decode<map_t<uint8_t, uint8_t>>(uint8_vector::from_hex("0201020103")); }));
+            // invalid values
+            expect(throws([&] { (void)decode<bool>(uint8_vector::from_hex("02")); }));
+            expect(throws([&] { (void)decode<std::optional<uint8_t>>(uint8_vector::from_hex("0200")); }));
+            expect(throws([&] { (void)decode<varlen_t<uint16_t>>(uint8_vector::from_hex("808004")); }));
+            const auto bad_index = uint8_vector::from_hex("03");
+            value_t v {};
+            decoder dec { bad_index };
+            expect(throws([&] { dec.process(as_variant(v, value_names)); }));
+        };
+    };
+};
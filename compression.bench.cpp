@@ -0,0 +1,62 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <random>
+#include <turbo/common/benchmark.hpp>
+#include "compression.hpp"
+
+using namespace turbo;
+
+namespace {
+    uint8_vector make_random(const size_t size)
+    {
+        uint8_vector data(size);
+        std::mt19937_64 gen { 22 };
+        for (auto &b: data)
+            b = static_cast<uint8_t>(gen());
+        return data;
+    }
+
+    uint8_vector make_records(const size_t size)
+    {
+        uint8_vector data {};
+        for (uint64_t i = 0; data.size() < size; ++i)
+            data << std::string_view { fmt::format(R"({{"slot":{},"fee":{},"amount":{}}})", i * 20, 150'000 + i % 1000, i * 1'000'003 % 45'000'000) };
+        data.resize(size);
+        return data;
+    }
+}
+
+suite compression_bench_suite = [] {
+    using namespace turbo::compression;
+    "turbo::common::compression"_test = [] {
+        static constexpr size_t data_size = size_t { 1 } << 24U;
+        const auto records = make_records(data_size);
+        const auto random = make_random(data_size);
+        const store_codec store {};
+        const zstd_codec zstd1 { 1 };
+        const zstd_codec zstd3 { 3 };
+        const lz4_codec lz4 {};
+        const lz4_frame_codec lz4_frame {};
+        for (const auto &[name, c]: std::initializer_list<std::pair<std::string_view, const compression::codec *>> {
+            { "store", &store }, { "zstd level 1", &zstd1 }, { "zstd level 3", &zstd3 }, { "lz4", &lz4 }, { "lz4 frame", &lz4_frame } })
+        {
+            uint8_vector compressed {};
+            benchmark(fmt::format("compression::compress {}", name), [&] {
+                compress(compressed, records, *c);
+            }, data_size);
+            logger::info("compression {}: ratio {:0.2f}", name, static_cast<double>(data_size) / static_cast<double>(compressed.size()));
+            benchmark(fmt::format("compression::decompress {}", name), [&] {
+                uint8_vector out {};
+                decompress(out, compressed);
+            }, data_size);
+        }
+        uint8_vector compressed {};
+        benchmark("compression::compress random zstd level 3", [&] {
+            compress(compressed, random, zstd3);
+        }, data_size);
+        benchmark("compression::compress_auto random zstd level 3", [&] {
+            compress_auto(compressed, random, zstd3);
+        }, data_size);
+    };
+};
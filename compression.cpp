@@ -0,0 +1,277 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+extern "C" {
+#   include <lz4.h>
+#   include <lz4frame.h>
+#   include <lz4hc.h>
+};
+#include <array>
+#include <cmath>
+#include <cstring>
+#include "byte-io.hpp"
+#include "compression.hpp"
+#include "zstd.hpp"
+
+namespace turbo::compression {
+    namespace {
+        static constexpr size_t sample_block_size = 256;
+        static constexpr size_t max_sample_blocks = 16;
+
+        // replaces the contents of out with the header and returns its size
+        size_t write_header(uint8_vector &out, const method m, const size_t data_size)
+        {
+            out.resize(1 + varint::max_size);
+            out[0] = static_cast<uint8_t>(m);
+            out.resize(1 + varint::encode(out.data() + 1, data_size));
+            return out.size();
+        }
+
+        int lz4_size(const size_t size)
+        {
+            if (size > LZ4_MAX_INPUT_SIZE) [[unlikely]]
+                throw error(fmt::format("lz4 supports data up to {} bytes but got {}", LZ4_MAX_INPUT_SIZE, size));
+            return static_cast<int>(size);
+        }
+
+        struct lz4f_dctx {
+            lz4f_dctx()
+            {
+                if (const auto res = LZ4F_createDecompressionContext(&_ctx, LZ4F_VERSION); LZ4F_isError(res)) [[unlikely]]
+                    throw error(fmt::format("failed to create an lz4 decompression context: {}", LZ4F_getErrorName(res)));
+            }
+
+            ~lz4f_dctx()
+            {
+                LZ4F_freeDecompressionContext(_ctx);
+            }
+
+            LZ4F_dctx *get() const
+            {
+                return _ctx;
+            }
+        private:
+            LZ4F_dctx *_ctx = nullptr;
+        };
+    }
+
+    method store_codec::id() const noexcept
+    {
+        return method::store;
+    }
+
+    void store_codec::compress(uint8_vector &out, const buffer data) const
+    {
+        out << data;
+    }
+
+    void store_codec::decompress(const write_buffer out, const buffer payload) const
+    {
+        if (payload.size() != out.size()) [[unlikely]]
+            throw error(fmt::format("stored data has {} bytes instead of {}", payload.size(), out.size()));
+        if (!out.empty())
+            memcpy(out.data(), payload.data(), out.size());
+    }
+
+    zstd_codec::zstd_codec(const int level):
+        _level { level }
+    {
+    }
+
+    method zstd_codec::id() const noexcept
+    {
+        return method::zstd;
+    }
+
+    void zstd_codec::compress(uint8_vector &out, const buffer data) const
+    {
+        const auto prev_size = out.size();
+        out.resize(prev_size + ZSTD_compressBound(data.size()));
+        const auto ctx = zstd::context_pool::get().acquire(zstd::compress_params { .level=_level });
+        const auto res = ZSTD_compress2(ctx.get(), out.data() + prev_size, out.size() - prev_size, data.data(), data.size());
+        if (ZSTD_isError(res)) [[unlikely]]
+            throw error(fmt::format("zstd compression error: {}", ZSTD_getErrorName(res)));
+        out.resize(prev_size + res);
+    }
+
+    void zstd_codec::decompress(const write_buffer out, const buffer payload) const
+    {
+        thread_local zstd::decompress_context ctx {};
+        ctx.reset();
+        const auto res = ZSTD_decompressDCtx(ctx.get(), out.data(), out.size(), payload.data(), payload.size());
+        if (ZSTD_isError(res)) [[unlikely]]
+            throw error(fmt::format("zstd decompression error: {}", ZSTD_getErrorName(res)));
+        if (res != out.size()) [[unlikely]]
+            throw error(fmt::format("zstd data decompressed into {} bytes instead of {}", res, out.size()));
+    }
+
+    lz4_codec::lz4_codec(const int level):
+        _level { level }
+    {
+    }
+
+    method lz4_codec::id() const noexcept
+    {
+        return method::lz4;
+    }
+
+    void lz4_codec::compress(uint8_vector &out, const buffer data) const
+    {
+        const auto data_size = lz4_size(data.size());
+        const auto prev_size = out.size();
+        const auto bound = LZ4_compressBound(data_size);
+        out.resize(prev_size + bound);
+        auto *dst = reinterpret_cast<char *>(out.data() + prev_size);
+        const auto *src = reinterpret_cast<const char *>(data.data());
+        const auto res = _level > 0 ? LZ4_compress_HC(src, dst, data_size, bound, _level) : LZ4_compress_default(src, dst, data_size, bound);
+        if (res <= 0 && data_size > 0) [[unlikely]]
+            throw error(fmt::format("lz4 failed to compress {} bytes", data.size()));
+        out.resize(prev_size + static_cast<size_t>(res));
+    }
+
+    void lz4_codec::decompress(const write_buffer out, const buffer payload) const
+    {
+        const auto res = LZ4_decompress_safe(reinterpret_cast<const char *>(payload.data()), reinterpret_cast<char *>(out.data()),
+            lz4_size(payload.size()), lz4_size(out.size()));
+        if (res < 0 || static_cast<size_t>(res) != out.size()) [[unlikely]]
+            throw error(fmt::format("lz4 failed to decompress {} bytes into {}", payload.size(), out.size()));
+    }
+
+    lz4_frame_codec::lz4_frame_codec(const int level):
+        _level { level }
+    {
+    }
+
+    method lz4_frame_codec::id() const noexcept
+    {
+        return method::lz4_frame;
+    }
+
+    void lz4_frame_codec::compress(uint8_vector &out, const buffer data) const
+    {
+        LZ4F_preferences_t prefs {};
+        prefs.compressionLevel = _level;
+        prefs.frameInfo.contentSize = data.size();
+        prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+        const auto prev_size = out.size();
+        out.resize(prev_size + LZ4F_compressFrameBound(data.size(), &prefs));
+        const auto res = LZ4F_compressFrame(out.data() + prev_size, out.size() - prev_size, data.data(), data.size(), &prefs);
+        if (LZ4F_isError(res)) [[unlikely]]
+            throw error(fmt::format("lz4 frame compression error: {}", LZ4F_getErrorName(res)));
+        out.resize(prev_size + res);
+    }
+
+    void lz4_frame_codec::decompress(const write_buffer out, const buffer payload) const
+    {
+        thread_local lz4f_dctx ctx {};
+        LZ4F_resetDecompressionContext(ctx.get());
+        size_t out_size = out.size();
+        size_t in_size = payload.size();
+        const auto res = LZ4F_decompress(ctx.get(), out.data(), &out_size, payload.data(), &in_size, nullptr);
+        if (LZ4F_isError(res)) [[unlikely]]
+            throw error(fmt::format("lz4 frame decompression error: {}", LZ4F_getErrorName(res)));
+        // a zero result means that the frame has been fully decoded and verified
+        if (res != 0 || out_size != out.size() || in_size != payload.size()) [[unlikely]]
+            throw error(fmt::format("lz4 frame of {} bytes did not decompress into exactly {} bytes", payload.size(), out.size()));
+    }
+
+    const codec &codec_for(const method m)
+    {
+        static const store_codec store {};
+        static const zstd_codec zstd {};
+        static const lz4_codec lz4 {};
+        static const lz4_frame_codec lz4_frame {};
+        switch (m) {
+            case method::store: return store;
+            case method::zstd: return zstd;
+            case method::lz4: return lz4;
+            case method::lz4_frame: return lz4_frame;
+            default: throw error(fmt::format("unsupported compression method: {}", static_cast<int>(m)));
+        }
+    }
+
+    double sample_entropy(const buffer data)
+    {
+        std::array<size_t, 256> counts {};
+        size_t total = 0;
+        const auto count_block = [&](const buffer block) {
+            for (const auto b: block)
+                ++counts[b];
+            total += block.size();
+        };
+        if (data.size() <= sample_block_size * max_sample_blocks) {
+            count_block(data);
+        } else {
+            const auto step = (data.size() - sample_block_size) / (max_sample_blocks - 1);
+            for (size_t i = 0; i < max_sample_blocks; ++i)
+                count_block(data.subbuf(i * step, sample_block_size));
+        }
+        if (!total)
+            return 0.0;
+        double entropy = 0.0;
+        for (const auto c: counts) {
+            if (c) {
+                const auto p = static_cast<double>(c) / static_cast<double>(total);
+                entropy -= p * std::log2(p);
+            }
+        }
+        return entropy;
+    }
+
+    void compress(uint8_vector &out, const buffer data, const codec &c)
+    {
+        write_header(out, c.id(), data.size());
+        c.compress(out, data);
+    }
+
+    uint8_vector compress(const buffer data, const codec &c)
+    {
+        uint8_vector out {};
+        compress(out, data, c);
+        return out;
+    }
+
+    void compress_auto(uint8_vector &out, const buffer data, const codec &c, const double max_entropy)
+    {
+        const auto &store = codec_for(method::store);
+        if (sample_entropy(data) > max_entropy) {
+            compress(out, data, store);
+            return;
+        }
+        const auto header_size = write_header(out, c.id(), data.size());
+        c.compress(out, data);
+        // the header is the same for all methods, so only the payloads need to be compared
+        if (out.size() - header_size >= data.size()) {
+            out[0] = static_cast<uint8_t>(method::store);
+            out.resize(header_size);
+            store.compress(out, data);
+        }
+    }
+
+    uint8_vector compress_auto(const buffer data, const codec &c, const double max_entropy)
+    {
+        uint8_vector out {};
+        compress_auto(out, data, c, max_entropy);
+        return out;
+    }
+
+    void decompress(uint8_vector &out, const buffer compressed, const size_t max_size)
+    {
+        if (compressed.empty()) [[unlikely]]
+            throw error("compressed data must have at least a header");
+        const auto &c = codec_for(static_cast<method>(compressed[0]));
+        size_t pos = 1;
+        const auto size = varint::decode(compressed, pos);
+        if (size > max_size) [[unlikely]]
+            throw error(fmt::format("recorded original data size {} is greater than the maximum allowed: {}!", size, max_size));
+        out.resize(size);
+        c.decompress(out, compressed.subbuf(pos));
+    }
+
+    uint8_vector decompress(const buffer compressed)
+    {
+        uint8_vector out {};
+        decompress(out, compressed);
+        return out;
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include "bytes.hpp"
+
+namespace turbo::compression {
+    // the values are stored in compressed data, so they must never change
+    enum class method: uint8_t {
+        store = 0,
+        zstd = 1,
+        lz4 = 2,
+        lz4_frame = 3
+    };
+
+    // A compression method with its settings. Codecs are stateless and can be shared between threads.
+    struct codec {
+        virtual ~codec() =default;
+        [[nodiscard]] virtual method id() const noexcept =0;
+        // appends the payload to out and keeps its contents, so that the payload follows the header without a copy
+        virtual void compress(uint8_vector &out, buffer data) const =0;
+        // the size of out is exactly the size of the original data
+        virtual void decompress(write_buffer out, buffer payload) const =0;
+    };
+
+    struct store_codec: codec {
+        [[nodiscard]] method id() const noexcept override;
+        void compress(uint8_vector &out, buffer data) const override;
+        void decompress(write_buffer out, buffer payload) const override;
+    };
+
+    // best ratio, decompresses at about 1 GB/s
+    struct zstd_codec: codec {
+        explicit zstd_codec(int level=3);
+        [[nodiscard]] method id() const noexcept override;
+        void compress(uint8_vector &out, buffer data) const override;
+        void decompress(write_buffer out, buffer payload) const override;
+    private:
+        const int _level;
+    };
+
+    // LZ4 blocks: the fastest decompression, for hot in-memory data; a positive level selects LZ4 HC
+    struct lz4_codec: codec {
+        explicit lz4_codec(int level=0);
+        [[nodiscard]] method id() const noexcept override;
+        void compress(uint8_vector &out, buffer data) const override;
+        void decompress(write_buffer out, buffer payload) const override;
+    private:
+        const int _level;
+    };
+
+    // LZ4 frames: the standard LZ4 format with checksums, readable by the lz4 command-line tool
+    struct lz4_frame_codec: codec {
+        explicit lz4_frame_codec(int level=0);
+        [[nodiscard]] method id() const noexcept override;
+        void compress(uint8_vector &out, buffer data) const override;
+        void decompress(write_buffer out, buffer payload) const override;
+    private:
+        const int _level;
+    };
+
+    // a codec with the default settings of the method
+    extern const codec &codec_for(method m);
+
+    // Shannon entropy in bits per byte of evenly spread samples of the data, at most 4 KiB in total
+    extern double sample_entropy(buffer data);
+    // above it, general-purpose compressors gain too little to be worth the time
+    static constexpr double default_max_entropy = 7.5;
+
+    // The compressed data is self-describing: a byte with the method, the original size as a LEB128 varint,
+    // and the payload. So decompress needs no knowledge of how the data was compressed.
+    // Unlike the codecs' methods, these functions replace the contents of out, the same as zstd::compress and decompress.
+    extern void compress(uint8_vector &out, buffer data, const codec &c);
+    extern uint8_vector compress(buffer data, const codec &c);
+    // Stores the data as is when the entropy of a sample exceeds max_entropy
+    // or when the compressed payload turns out to be no smaller than the data.
+    extern void compress_auto(uint8_vector &out, buffer data, const codec &c, double max_entropy=default_max_entropy);
+    extern uint8_vector compress_auto(buffer data, const codec &c, double max_entropy=default_max_entropy);
+    extern void decompress(uint8_vector &out, buffer compressed, size_t max_size=size_t { 1 } << 30U);
+    extern uint8_vector decompress(buffer compressed);
+}
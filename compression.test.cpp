@@ -0,0 +1,95 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <random>
+#include <turbo/common/test.hpp>
+#include "compression.hpp"
+
+namespace {
+    using namespace turbo;
+
+    uint8_vector make_random(const size_t size)
+    {
+        uint8_vector data(size);
+        std::mt19937_64 gen { 22 };
+        for (auto &b: data)
+            b = static_cast<uint8_t>(gen());
+        return data;
+    }
+}
+
+suite turbo_common_compression_suite = [] {
+    using namespace turbo::compression;
+    "turbo::common::compression"_test = [] {
+        const auto data = test_data(800'000);
+        const auto random = make_random(100'000);
+        const store_codec store {};
+        const zstd_codec zstd { 3 };
+        const lz4_codec lz4 {};
+        const lz4_codec lz4_hc { 9 };
+        const lz4_frame_codec lz4_frame {};
+        const std::initializer_list<const compression::codec *> codecs { &store, &zstd, &lz4, &lz4_hc, &lz4_frame };
+        "round trip"_test = [&] {
+            for (const auto *c: codecs) {
+                const auto compressed = compress(data, *c);
+                expect_equal(static_cast<uint8_t>(c->id()), compressed[0]);
+                expect_equal(data, decompress(compressed));
+                if (c->id() != method::store)
+                    expect(compressed.size() < data.size()) << static_cast<int>(c->id()) << compressed.size();
+                // the previous contents of the output are replaced
+                uint8_vector out(100, 0xAA);
+                compress(out, data, *c);
+                expect(out == compressed) << static_cast<int>(c->id());
+                out.assign(7, 0x55);
+                compress_auto(out, data, *c);
+                expect(out == compress_auto(data, *c)) << static_cast<int>(c->id());
+            }
+        };
+        "empty"_test = [&] {
+            for (const auto *c: codecs) {
+                const auto compressed = compress(uint8_vector {}, *c);
+                expect(decompress(compressed).empty());
+            }
+        };
+        "codec_for"_test = [&] {
+            for (const auto m: { method::store, method::zstd, method::lz4, method::lz4_frame })
+                expect(codec_for(m).id() == m);
+            expect(throws([] { codec_for(static_cast<method>(77)); }));
+        };
+        "sample_entropy"_test = [&] {
+            expect(sample_entropy(random) > 7.5);
+            expect(sample_entropy(data) < 7.0);
+            expect_equal(0.0, sample_entropy(uint8_vector(10'000, 0x11)));
+            expect_equal(0.0, sample_entropy(uint8_vector {}));
+        };
+        "compress_auto"_test = [&] {
+            const auto compressed_random = compress_auto(random, zstd);
+            expect(compressed_random[0] == static_cast<uint8_t>(method::store));
+            expect_equal(random, decompress(compressed_random));
+            const auto compressed_data = compress_auto(data, lz4);
+            expect(compressed_data[0] == static_cast<uint8_t>(method::lz4));
+            expect_equal(data, decompress(compressed_data));
+            // short data that does not compress despite its low entropy
+            const uint8_vector tiny { std::string_view { "abc" } };
+            const auto compressed_tiny = compress_auto(tiny, zstd);
+            expect(compressed_tiny[0] == static_cast<uint8_t>(method::store));
+            expect_equal(tiny, decompress(compressed_tiny));
+        };
+        "errors"_test = [&] {
+            expect(throws([] { decompress(uint8_vector {}); }));
+            for (const auto *c: codecs) {
+                auto compressed = compress(data, *c);
+                compressed.resize(compressed.size() - 1);
+                expect(throws([&] { decompress(compressed); })) << static_cast<int>(c->id());
+            }
+            auto compressed = compress(data, lz4);
+            // a different recorded size
+            compressed[1] ^= 0x01;
+            expect(throws([&] { decompress(compressed); }));
+            uint8_vector out {};
+            expect(throws([&] { decompress(out, compress(data, store), 1000); }));
+            const uint8_vector bad_varint(12, 0xFF);
+            expect(throws([&] { decompress(bad_varint); }));
+        };
+    };
+};
@@ -128,6 +128,17 @@ namespace turbo::coro {
         void return_void() { this->set_value(); }
     };
 
+    // Starts immediately and destroys its own frame once complete, so that it can finish on any thread.
+    struct detached_task_t {
+        struct promise_type {
+            detached_task_t get_return_object() noexcept { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+    };
+
     template<typename T>
     struct task_t {
         struct promise_type;
@@ -257,16 +268,24 @@ namespace turbo::coro {
         {
             std::promise<T> promise;
             auto future = promise.get_future();
-            auto wrapped_task = _notify_future(std::move(promise), *this);
-            wrapped_task.resume();
-            future.wait();
+            // when the task is resumed by another thread, the notifier finishes there after this thread wakes up,
+            // so it must not live in a frame owned by this thread
+            _notify_future(std::move(promise), *this);
             return future.get();
         }
     private:
-        task_t<void> _notify_future(std::promise<T> promise, task_t<T> &task)
+        static detached_task_t _notify_future(std::promise<T> promise, task_t<T> &task)
         {
-            auto res = co_await task;
-            promise.set_value(std::move(res));
+            try {
+                if constexpr (std::is_void_v<T>) {
+                    co_await task;
+                    promise.set_value();
+                } else {
+                    promise.set_value(co_await task);
+                }
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
         }
 
         explicit task_t(handle_type h):
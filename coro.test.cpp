@@ -1,6 +1,7 @@
 /* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
  * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
 
+#include <thread>
 #include <turbo/common/coro.hpp>
 #include <turbo/common/test.hpp>
 
@@ -143,5 +144,23 @@ suite turbo_common_coro_suite = [] {
             const auto res = my_coro.result();
             expect_equal(2, res);
         };
+
+        "task_t wait with resumption on another thread"_test = [] {
+            for (size_t i = 0; i < 1000; ++i) {
+                std::thread resumer {};
+                auto my_coro = [&] -> task_t<size_t> {
+                    co_await external_task_t { [&](auto h) { resumer = std::thread { [h] { h.resume(); } }; } };
+                    co_return i;
+                };
+                auto c = my_coro();
+                expect_equal(i, c.wait());
+                resumer.join();
+            }
+        };
+
+        "task_t wait propagates exception"_test = [] {
+            auto c = fail();
+            expect(throws<std::runtime_error>([&] { c.wait(); }));
+        };
     };
-};
\ No newline at end of file
+};
@@ -0,0 +1,575 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#   define TURBO_HAS_IO_URING 1
+#   include <linux/io_uring.h>
+#   include <sys/mman.h>
+#   include <sys/syscall.h>
+#   include <sys/uio.h>
+#   include <unistd.h>
+#endif
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <latch>
+#include <thread>
+#include "file-async.hpp"
+#include "logger.hpp"
+#include "mutex.hpp"
+
+namespace turbo::file {
+    struct async_engine::impl {
+        explicit impl(const async_backend backend, const size_t queue_depth):
+            _queue_depth { queue_depth }
+        {
+            if (_queue_depth == 0) [[unlikely]]
+                throw error("async_engine: the queue depth must be greater than zero!");
+#ifdef TURBO_HAS_IO_URING
+            if (backend != async_backend::thread_pool) {
+                try {
+                    _ring.emplace(static_cast<unsigned>(_queue_depth));
+                    _backend = async_backend::io_uring;
+                    _workers.emplace_back([this] { _ring_completion_thread(); });
+                    return;
+                } catch (const std::exception &ex) {
+                    if (backend == async_backend::io_uring)
+                        throw;
+                    logger::debug("async_engine: io_uring is not available, falling back to a thread pool: {}", ex.what());
+                }
+            }
+#else
+            if (backend == async_backend::io_uring)
+                throw error("async_engine: io_uring is not supported on this platform!");
+#endif
+            _backend = async_backend::thread_pool;
+            const size_t num_threads = std::min(_queue_depth, std::max(size_t { 4 }, size_t { std::thread::hardware_concurrency() }));
+            for (size_t i = 0; i < num_threads; ++i)
+                _workers.emplace_back([this] { _pool_thread(); });
+        }
+
+        ~impl()
+        {
+            {
+                mutex::unique_lock lk { _slots_mutex };
+                _slots_cv.wait(lk, [&] { return _num_pending == 0; });
+                _stop = true;
+            }
+#ifdef TURBO_HAS_IO_URING
+            if (_ring)
+                _ring->wake();
+#endif
+            _queue_cv.notify_all();
+            for (auto &w: _workers)
+                w.join();
+        }
+
+        async_backend backend() const noexcept
+        {
+            return _backend;
+        }
+
+        size_t queue_depth() const noexcept
+        {
+            return _queue_depth;
+        }
+
+        void register_buffers(const std::span<const write_buffer> bufs)
+        {
+#ifdef TURBO_HAS_IO_URING
+            if (_ring)
+                _ring->register_buffers(bufs);
+#endif
+        }
+
+        void unregister_buffers()
+        {
+#ifdef TURBO_HAS_IO_URING
+            if (_ring)
+                _ring->unregister_buffers();
+#endif
+        }
+
+        void submit(const handle &file, const uint64_t offset, const write_buffer target, completion_t on_done)
+        {
+            if (file.fd() < 0) [[unlikely]]
+                throw error(fmt::format("async_engine: an attempt to read from a closed file {}", file.path()));
+            auto o = std::make_unique<op>(file, offset, target, 0, std::move(on_done));
+            _acquire_slot();
+#ifdef TURBO_HAS_IO_URING
+            if (_ring) {
+                try {
+                    _ring->push(o.get());
+                    o.release();
+                } catch (...) {
+                    _release_slot();
+                    throw;
+                }
+                return;
+            }
+#endif
+            {
+                mutex::scoped_lock lk { _queue_mutex };
+                _queue.emplace_back(std::move(o));
+            }
+            _queue_cv.notify_one();
+        }
+    private:
+        struct op {
+            const handle &file;
+            uint64_t offset;
+            write_buffer target;
+            size_t done = 0;
+            completion_t on_done;
+        };
+
+#ifdef TURBO_HAS_IO_URING
+        // A minimal io_uring wrapper using the raw system calls to avoid a dependency on liburing.
+        struct ring {
+            explicit ring(const unsigned entries)
+            {
+                io_uring_params p {};
+                _fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+                if (_fd < 0) [[unlikely]]
+                    throw error_sys("io_uring_setup failed");
+                try {
+                    _probe_ops();
+                } catch (...) {
+                    ::close(_fd);
+                    throw;
+                }
+                _sq_entries = p.sq_entries;
+                _sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+                _cq_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+                const bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+                if (single_mmap)
+                    _sq_size = _cq_size = std::max(_sq_size, _cq_size);
+                _sq_ptr = ::mmap(nullptr, _sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQ_RING);
+                if (_sq_ptr == MAP_FAILED) [[unlikely]] {
+                    ::close(_fd);
+                    throw error_sys("failed to map the io_uring submission queue");
+                }
+                if (single_mmap) {
+                    _cq_ptr = _sq_ptr;
+                } else {
+                    _cq_ptr = ::mmap(nullptr, _cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_CQ_RING);
+                    if (_cq_ptr == MAP_FAILED) [[unlikely]] {
+                        ::munmap(_sq_ptr, _sq_size);
+                        ::close(_fd);
+                        throw error_sys("failed to map the io_uring completion queue");
+                    }
+                }
+                _sqes_size = p.sq_entries * sizeof(io_uring_sqe);
+                _sqes = static_cast<io_uring_sqe *>(::mmap(nullptr, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES));
+                if (_sqes == MAP_FAILED) [[unlikely]] {
+                    if (_cq_ptr != _sq_ptr)
+                        ::munmap(_cq_ptr, _cq_size);
+                    ::munmap(_sq_ptr, _sq_size);
+                    ::close(_fd);
+                    throw error_sys("failed to map the io_uring submission entries");
+                }
+                auto *sq = static_cast<uint8_t *>(_sq_ptr);
+                _sq_tail = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+                _sq_mask = *reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+                _sq_array = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+                auto *cq = static_cast<uint8_t *>(_cq_ptr);
+                _cq_head = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+                _cq_tail = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+                _cq_mask = *reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+                _cqes = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+            }
+
+            ~ring()
+            {
+                ::munmap(_sqes, _sqes_size);
+                if (_cq_ptr != _sq_ptr)
+                    ::munmap(_cq_ptr, _cq_size);
+                ::munmap(_sq_ptr, _sq_size);
+                ::close(_fd);
+            }
+
+            [[nodiscard]] unsigned capacity() const noexcept
+            {
+                return _sq_entries;
+            }
+
+            void register_buffers(const std::span<const write_buffer> bufs)
+            {
+                mutex::scoped_lock lk { _sq_mutex };
+                _unregister_buffers();
+                std::vector<iovec> iovs {};
+                iovs.reserve(bufs.size());
+                for (const auto &b: bufs)
+                    iovs.emplace_back(b.data(), b.size());
+                if (::syscall(__NR_io_uring_register, _fd, IORING_REGISTER_BUFFERS, iovs.data(), static_cast<unsigned>(iovs.size())) != 0) [[unlikely]]
+                    throw error_sys(fmt::format("failed to register {} io_uring buffers", bufs.size()));
+                _buffers.assign(bufs.begin(), bufs.end());
+            }
+
+            void unregister_buffers()
+            {
+                mutex::scoped_lock lk { _sq_mutex };
+                _unregister_buffers();
+            }
+
+            // the caller guarantees that the number of requests in flight does not exceed the capacity
+            void push(op *o)
+            {
+                mutex::scoped_lock lk { _sq_mutex };
+                const auto tail = *_sq_tail;
+                const auto idx = tail & _sq_mask;
+                auto &sqe = _sqes[idx];
+                std::memset(&sqe, 0, sizeof(sqe));
+                sqe.fd = o->file.fd();
+                sqe.off = o->offset + o->done;
+                sqe.addr = reinterpret_cast<uint64_t>(o->target.data() + o->done);
+                sqe.len = static_cast<uint32_t>(std::min(o->target.size() - o->done, size_t { 1U << 30U }));
+                sqe.user_data = reinterpret_cast<uint64_t>(o);
+                sqe.opcode = IORING_OP_READ;
+                if (const auto buf_idx = _find_buffer(o->target); buf_idx) {
+                    sqe.opcode = IORING_OP_READ_FIXED;
+                    sqe.buf_index = static_cast<uint16_t>(*buf_idx);
+                }
+                _sq_array[idx] = idx;
+                std::atomic_ref<unsigned> { *_sq_tail }.store(tail + 1, std::memory_order_release);
+                _submit();
+            }
+
+            // wakes up the completion thread with a request that has no associated op
+            void wake()
+            {
+                mutex::scoped_lock lk { _sq_mutex };
+                const auto tail = *_sq_tail;
+                const auto idx = tail & _sq_mask;
+                auto &sqe = _sqes[idx];
+                std::memset(&sqe, 0, sizeof(sqe));
+                sqe.opcode = IORING_OP_NOP;
+                sqe.user_data = 0;
+                _sq_array[idx] = idx;
+                std::atomic_ref<unsigned> { *_sq_tail }.store(tail + 1, std::memory_order_release);
+                _submit();
+            }
+
+            // submits the requests that push() has left in the queue and waits for at least one completion;
+            // returns early when the kernel needs the completions to be reaped first
+            void wait()
+            {
+                const auto to_submit = _num_unsubmitted.exchange(0, std::memory_order_acq_rel);
+                const auto res = ::syscall(__NR_io_uring_enter, _fd, to_submit, 1U, IORING_ENTER_GETEVENTS, nullptr, 0);
+                if (res >= 0) [[likely]] {
+                    if (static_cast<unsigned>(res) < to_submit)
+                        _num_unsubmitted.fetch_add(to_submit - static_cast<unsigned>(res), std::memory_order_acq_rel);
+                    return;
+                }
+                const auto err = errno;
+                _num_unsubmitted.fetch_add(to_submit, std::memory_order_acq_rel);
+                if (err != EINTR && err != EAGAIN && err != EBUSY) [[unlikely]]
+                    throw error_sys("io_uring_enter failed");
+            }
+
+            // calls the observer for every available completion; must be called from a single thread
+            template<typename F>
+            size_t reap(const F &observer)
+            {
+                auto head = *_cq_head;
+                const auto tail = std::atomic_ref<unsigned> { *_cq_tail }.load(std::memory_order_acquire);
+                size_t num_reaped = 0;
+                for (; head != tail; ++head, ++num_reaped) {
+                    const auto &cqe = _cqes[head & _cq_mask];
+                    const auto user_data = cqe.user_data;
+                    const auto res = cqe.res;
+                    std::atomic_ref<unsigned> { *_cq_head }.store(head + 1, std::memory_order_release);
+                    observer(reinterpret_cast<op *>(user_data), res);
+                }
+                return num_reaped;
+            }
+        private:
+            int _fd = -1;
+            unsigned _sq_entries = 0;
+            size_t _sq_size = 0;
+            size_t _cq_size = 0;
+            size_t _sqes_size = 0;
+            void *_sq_ptr = nullptr;
+            void *_cq_ptr = nullptr;
+            io_uring_sqe *_sqes = nullptr;
+            unsigned *_sq_tail = nullptr;
+            unsigned _sq_mask = 0;
+            unsigned *_sq_array = nullptr;
+            unsigned *_cq_head = nullptr;
+            unsigned *_cq_tail = nullptr;
+            unsigned _cq_mask = 0;
+            io_uring_cqe *_cqes = nullptr;
+            mutex::unique_lock::mutex_type _sq_mutex alignas(mutex::alignment) {};
+            std::vector<write_buffer> _buffers {};
+
+            // the number of queued requests that the kernel has refused to take yet
+            std::atomic<unsigned> _num_unsubmitted { 0 };
+
+            // io_uring_setup succeeds on kernels that predate IORING_OP_READ (5.6),
+            // so the ring is used only when the kernel reports support for all the opcodes used here
+            void _probe_ops() const
+            {
+                static constexpr size_t max_ops = 256;
+                std::vector<uint8_t> buf(sizeof(io_uring_probe) + max_ops * sizeof(io_uring_probe_op));
+                auto *probe = reinterpret_cast<io_uring_probe *>(buf.data());
+                if (::syscall(__NR_io_uring_register, _fd, IORING_REGISTER_PROBE, probe, static_cast<unsigned>(max_ops)) != 0) [[unlikely]]
+                    throw error_sys("io_uring does not support opcode probing");
+                for (const unsigned opcode: { IORING_OP_NOP, IORING_OP_READ, IORING_OP_READ_FIXED }) {
+                    if (opcode > probe->last_op || !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED)) [[unlikely]]
+                        throw error(fmt::format("io_uring does not support the opcode {}", opcode));
+                }
+            }
+
+            // called with _sq_mutex held; EBUSY means that the completions must be reaped first,
+            // so the request stays in the queue and the completion thread submits it after reaping instead of spinning here
+            void _submit()
+            {
+                for (;;) {
+                    const auto res = ::syscall(__NR_io_uring_enter, _fd, 1U, 0U, 0U, nullptr, 0);
+                    if (res > 0) [[likely]]
+                        return;
+                    if (res == 0 || errno == EBUSY) {
+                        _num_unsubmitted.fetch_add(1, std::memory_order_acq_rel);
+                        return;
+                    }
+                    if (errno != EINTR && errno != EAGAIN) [[unlikely]]
+                        throw error_sys("io_uring_enter failed");
+                }
+            }
+
+            void _unregister_buffers()
+            {
+                if (!_buffers.empty()) {
+                    if (::syscall(__NR_io_uring_register, _fd, IORING_UNREGISTER_BUFFERS, nullptr, 0) != 0) [[unlikely]]
+                        throw error_sys("failed to unregister io_uring buffers");
+                    _buffers.clear();
+                }
+            }
+
+            std::optional<size_t> _find_buffer(const write_buffer target) const noexcept
+            {
+                for (size_t i = 0; i < _buffers.size(); ++i) {
+                    const auto &b = _buffers[i];
+                    if (target.data() >= b.data() && target.data() + target.size() <= b.data() + b.size())
+                        return i;
+                }
+                return {};
+            }
+        };
+
+        std::optional<ring> _ring {};
+
+        void _ring_completion_thread()
+        {
+            for (;;) {
+                logger::run_log_errors([&] {
+                    _ring->wait();
+                });
+                _ring->reap([&](op *o, const int res) {
+                    if (!o)
+                        return;
+                    if (res == -EINTR || res == -EAGAIN) [[unlikely]] {
+                        _ring_resubmit(o);
+                        return;
+                    }
+                    if (res < 0) [[unlikely]] {
+                        _complete(o, std::make_exception_ptr(error(fmt::format("async read of {} bytes at offset {} from {} failed: {}",
+                            o->target.size() - o->done, o->offset + o->done, o->file.path(), std::strerror(-res)))));
+                        return;
+                    }
+                    o->done += static_cast<size_t>(res);
+                    // short reads are continued unless the end of the file has been reached;
+                    // an unaligned short read of a direct handle can only end at the end of the file
+                    if (res > 0 && o->done < o->target.size() && (!o->file.direct() || o->done % handle::direct_alignment == 0)) {
+                        _ring_resubmit(o);
+                        return;
+                    }
+                    _complete(o, {});
+                });
+                mutex::scoped_lock lk { _slots_mutex };
+                if (_stop && _num_pending == 0)
+                    break;
+            }
+        }
+
+        // a resubmitted request keeps its slot, so it never waits for the completion thread itself
+        void _ring_resubmit(op *o)
+        {
+            try {
+                _ring->push(o);
+            } catch (...) {
+                _complete(o, std::current_exception());
+            }
+        }
+#endif
+
+        const size_t _queue_depth;
+        async_backend _backend = async_backend::automatic;
+        std::vector<std::thread> _workers {};
+        mutex::unique_lock::mutex_type _slots_mutex alignas(mutex::alignment) {};
+        std::condition_variable_any _slots_cv {};
+        size_t _num_pending = 0;
+        bool _stop = false;
+        mutex::unique_lock::mutex_type _queue_mutex alignas(mutex::alignment) {};
+        std::condition_variable_any _queue_cv {};
+        std::deque<std::unique_ptr<op>> _queue {};
+
+        void _acquire_slot()
+        {
+            mutex::unique_lock lk { _slots_mutex };
+            const auto capacity = _capacity();
+            _slots_cv.wait(lk, [&] { return _num_pending < capacity; });
+            ++_num_pending;
+        }
+
+        void _release_slot()
+        {
+            {
+                mutex::scoped_lock lk { _slots_mutex };
+                --_num_pending;
+            }
+            _slots_cv.notify_all();
+        }
+
+        size_t _capacity() const noexcept
+        {
+#ifdef TURBO_HAS_IO_URING
+            if (_ring)
+                return std::min(_queue_depth, size_t { _ring->capacity() });
+#endif
+            return _queue_depth;
+        }
+
+        void _complete(op *o, std::exception_ptr err)
+        {
+            std::unique_ptr<op> owned { o };
+            const auto num_read = owned->done;
+            auto on_done = std::move(owned->on_done);
+            owned.reset();
+            // the slot is released first, so that the completion can submit new requests without a deadlock
+            _release_slot();
+            logger::run_log_errors([&] {
+                on_done(num_read, std::move(err));
+            });
+        }
+
+        void _pool_thread()
+        {
+            for (;;) {
+                std::unique_ptr<op> o {};
+                {
+                    mutex::unique_lock lk { _queue_mutex };
+                    _queue_cv.wait(lk, [&] { return !_queue.empty() || _stop; });
+                    if (_queue.empty())
+                        break;
+                    o = std::move(_queue.front());
+                    _queue.pop_front();
+                }
+                std::exception_ptr err {};
+                try {
+                    o->done = o->file.pread(o->target, o->offset);
+                } catch (...) {
+                    err = std::current_exception();
+                }
+                _complete(o.release(), std::move(err));
+            }
+        }
+    };
+
+    async_engine::async_engine(const async_backend backend, const size_t queue_depth):
+        _impl { std::make_unique<impl>(backend, queue_depth) }
+    {
+    }
+
+    async_engine::~async_engine() =default;
+
+    async_backend async_engine::backend() const
+    {
+        return _impl->backend();
+    }
+
+    void async_engine::register_buffers(const std::span<const write_buffer> bufs)
+    {
+        _impl->register_buffers(bufs);
+    }
+
+    void async_engine::unregister_buffers()
+    {
+        _impl->unregister_buffers();
+    }
+
+    void async_engine::submit(const handle &file, const uint64_t offset, const write_buffer target, completion_t on_done)
+    {
+        _impl->submit(file, offset, target, std::move(on_done));
+    }
+
+    void async_engine::submit(scheduler &sched, const std::string &task_group, const int64_t priority,
+        const handle &file, const uint64_t offset, const write_buffer target, completion_t on_done)
+    {
+        _impl->submit(file, offset, target, [&sched, task_group, priority, on_done=std::move(on_done)](const size_t num_read, std::exception_ptr err) {
+            sched.submit(task_group, priority, [on_done, num_read, err] {
+                on_done(num_read, err);
+            });
+        });
+    }
+
+    std::vector<size_t> async_engine::read_batch(const std::span<const async_read> reqs)
+    {
+        std::vector<size_t> res(reqs.size());
+        std::latch done { static_cast<std::ptrdiff_t>(reqs.size()) };
+        mutex::unique_lock::mutex_type err_mutex {};
+        std::exception_ptr first_err {};
+        size_t num_submitted = 0;
+        try {
+            for (size_t i = 0; i < reqs.size(); ++i) {
+                const auto &r = reqs[i];
+                _impl->submit(r.file, r.offset, r.target, [&, i](const size_t num_read, std::exception_ptr err) {
+                    res[i] = num_read;
+                    if (err) {
+                        mutex::scoped_lock lk { err_mutex };
+                        if (!first_err)
+                            first_err = std::move(err);
+                    }
+                    done.count_down();
+                });
+                ++num_submitted;
+            }
+        } catch (...) {
+            // the pending requests refer to the local state, so they must complete before the stack unwinds
+            done.count_down(static_cast<std::ptrdiff_t>(reqs.size() - num_submitted));
+            done.wait();
+            throw;
+        }
+        done.wait();
+        if (first_err) [[unlikely]]
+            std::rethrow_exception(first_err);
+        return res;
+    }
+
+    std::vector<uint8_vector> async_engine::read_files(const std::span<const std::string> paths)
+    {
+        std::vector<uint8_vector> res(paths.size());
+        // files are opened in groups of the queue depth to keep the number of open files bounded
+        const auto group_size = _impl->queue_depth();
+        for (size_t start = 0; start < paths.size(); start += group_size) {
+            const auto end = std::min(start + group_size, paths.size());
+            std::vector<handle> handles {};
+            handles.reserve(end - start);
+            std::vector<async_read> reqs {};
+            reqs.reserve(end - start);
+            for (size_t i = start; i < end; ++i) {
+                const auto &h = handles.emplace_back(paths[i]);
+                res[i].resize(h.size());
+                reqs.emplace_back(h, 0, res[i]);
+            }
+            const auto num_read = read_batch(reqs);
+            for (size_t i = start; i < end; ++i) {
+                if (num_read[i - start] != res[i].size()) [[unlikely]]
+                    throw error(fmt::format("{} has been truncated while being read: {} bytes instead of {}", paths[i], num_read[i - start], res[i].size()));
+            }
+        }
+        return res;
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <memory>
+#include "file.hpp"
+#include "scheduler.hpp"
+
+namespace turbo::file {
+    enum class async_backend {
+        automatic,
+        io_uring,
+        thread_pool
+    };
+
+    struct async_read {
+        const handle &file;
+        uint64_t offset = 0;
+        write_buffer target {};
+    };
+
+    // Asynchronous positional reads. On Linux, uses io_uring when the kernel allows it and supports IORING_OP_READ (5.6+),
+    // otherwise falls back to a pool of threads issuing blocking reads.
+    // Handles and target buffers must stay valid until the respective completion is called.
+    struct async_engine {
+        // num_read is smaller than the target size only when the end of the file has been reached.
+        // Completions are called from the engine's threads, so they must not block for long.
+        using completion_t = std::function<void(size_t num_read, std::exception_ptr err)>;
+
+        static constexpr size_t default_queue_depth = 256;
+
+        static async_engine &get()
+        {
+            static async_engine engine {};
+            return engine;
+        }
+
+        explicit async_engine(async_backend backend=async_backend::automatic, size_t queue_depth=default_queue_depth);
+        ~async_engine();
+
+        [[nodiscard]] async_backend backend() const;
+        // io_uring reads into registered buffers skip pinning the target pages on every request;
+        // the buffers must not be in use by pending requests when they are registered or unregistered.
+        void register_buffers(std::span<const write_buffer> bufs);
+        void unregister_buffers();
+        // blocks while the number of pending requests equals the queue depth
+        void submit(const handle &file, uint64_t offset, write_buffer target, completion_t on_done);
+        // delivers the completion as a task of the given scheduler instead of calling it from the engine's threads
+        void submit(scheduler &sched, const std::string &task_group, int64_t priority,
+            const handle &file, uint64_t offset, write_buffer target, completion_t on_done);
+        // submits all requests and waits for their completion; returns the number of bytes read by each
+        std::vector<size_t> read_batch(std::span<const async_read> reqs);
+        std::vector<uint8_vector> read_files(std::span<const std::string> paths);
+
+        struct read_awaitable {
+            async_engine &engine;
+            const handle &file;
+            uint64_t offset;
+            write_buffer target;
+            size_t num_read = 0;
+            std::exception_ptr err {};
+            // when set, the coroutine is resumed as a task of this scheduler instead of on the engine's thread
+            scheduler *sched = nullptr;
+            std::string task_group {};
+            int64_t priority = 0;
+
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> h)
+            {
+                auto on_done = [this, h](const size_t n, std::exception_ptr e) {
+                    num_read = n;
+                    err = std::move(e);
+                    h.resume();
+                };
+                if (sched)
+                    engine.submit(*sched, task_group, priority, file, offset, target, std::move(on_done));
+                else
+                    engine.submit(file, offset, target, std::move(on_done));
+            }
+
+            size_t await_resume()
+            {
+                if (err) [[unlikely]]
+                    std::rethrow_exception(err);
+                return num_read;
+            }
+        };
+
+        // To be used as co_await engine.read(...) from a coro::task_t. The coroutine is resumed on the engine's
+        // completion thread, so until it suspends again it must not block, in particular on this engine through
+        // read_batch, read_files or coro::task_t::wait, which would deadlock, and must not run for long,
+        // which would delay all other completions.
+        read_awaitable read(const handle &file, const uint64_t offset, const write_buffer target)
+        {
+            return { *this, file, offset, target };
+        }
+
+        // resumes the coroutine as a task of the scheduler, so that the continuation may block or run for long
+        read_awaitable read(scheduler &sched, const std::string &task_group, const int64_t priority,
+            const handle &file, const uint64_t offset, const write_buffer target)
+        {
+            return { *this, file, offset, target, 0, {}, &sched, task_group, priority };
+        }
+    private:
+        struct impl;
+        std::unique_ptr<impl> _impl;
+    };
+}
@@ -0,0 +1,112 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <latch>
+#include <turbo/common/coro.hpp>
+#include <turbo/common/test.hpp>
+#include "file-async.hpp"
+
+namespace {
+    using namespace turbo;
+
+    coro::task_t<size_t> read_coro(file::async_engine &engine, const file::handle &f, const uint64_t offset, const write_buffer target)
+    {
+        const auto num_read = co_await engine.read(f, offset, target);
+        co_return num_read;
+    }
+
+    // blocks on the same engine after the first read, which is allowed only when resumed by a scheduler
+    coro::task_t<size_t> read_twice_coro(file::async_engine &engine, scheduler &sched, const file::handle &f, const write_buffer target)
+    {
+        auto num_read = co_await engine.read(sched, "read-twice", 100, f, 0, target);
+        const std::vector<file::async_read> reqs { { f, 0, target } };
+        num_read += engine.read_batch(reqs).at(0);
+        co_return num_read;
+    }
+}
+
+suite turbo_common_file_async_suite = [] {
+    "turbo::common::file_async"_test = [] {
+        const file::tmp_directory dir { "turbo-file-async-test" };
+        std::vector<std::string> paths {};
+        std::vector<uint8_vector> datas {};
+        for (size_t i = 0; i < 16; ++i) {
+            const auto &path = paths.emplace_back(fmt::format("{}/chunk-{}.bin", dir.path(), i));
+            const auto &data = datas.emplace_back(test_data(8000 * (i + 1), i + 1));
+            file::write(path, data);
+        }
+        for (const auto backend: { file::async_backend::automatic, file::async_backend::thread_pool }) {
+            file::async_engine engine { backend, 4 };
+            const auto backend_name = engine.backend() == file::async_backend::io_uring ? "io_uring" : "thread_pool";
+            "read_files"_test = [&] {
+                const auto res = engine.read_files(paths);
+                expect_equal(paths.size(), res.size(), backend_name);
+                for (size_t i = 0; i < res.size(); ++i)
+                    expect(res[i] == datas[i]) << backend_name << i;
+            };
+            "read_batch ranges"_test = [&] {
+                const file::handle f { paths.back() };
+                const auto &data = datas.back();
+                uint8_vector a(100), b(1000), c(64);
+                const std::vector<file::async_read> reqs {
+                    { f, 0, a },
+                    { f, 4096, b },
+                    // crosses the end of the file
+                    { f, data.size() - 16, c }
+                };
+                const auto num_read = engine.read_batch(reqs);
+                expect_equal(size_t { 100 }, num_read.at(0), backend_name);
+                expect_equal(size_t { 1000 }, num_read.at(1), backend_name);
+                expect_equal(size_t { 16 }, num_read.at(2), backend_name);
+                expect(static_cast<buffer>(a) == static_cast<buffer>(data).subbuf(0, 100));
+                expect(static_cast<buffer>(b) == static_cast<buffer>(data).subbuf(4096, 1000));
+                expect(static_cast<buffer>(c).subbuf(0, 16) == static_cast<buffer>(data).subbuf(data.size() - 16));
+            };
+            "registered buffers"_test = [&] {
+                const file::handle f { paths.front() };
+                uint8_vector buf(datas.front().size());
+                const std::array<write_buffer, 1> bufs { buf };
+                engine.register_buffers(bufs);
+                const std::vector<file::async_read> reqs { { f, 0, buf } };
+                expect_equal(buf.size(), engine.read_batch(reqs).at(0), backend_name);
+                expect(buf == datas.front());
+                engine.unregister_buffers();
+            };
+            "coroutine"_test = [&] {
+                const file::handle f { paths.at(3) };
+                uint8_vector buf(datas.at(3).size());
+                auto task = read_coro(engine, f, 0, buf);
+                expect_equal(buf.size(), task.wait(), backend_name);
+                expect(buf == datas.at(3));
+            };
+            "coroutine on a scheduler"_test = [&] {
+                scheduler sched { 2 };
+                const file::handle f { paths.at(4) };
+                uint8_vector buf(datas.at(4).size());
+                auto task = read_twice_coro(engine, sched, f, buf);
+                expect_equal(buf.size() * 2, task.wait(), backend_name);
+                expect(buf == datas.at(4));
+            };
+            "completion callback"_test = [&] {
+                const file::handle f { paths.at(5) };
+                uint8_vector buf(datas.at(5).size());
+                std::latch done { 1 };
+                size_t num_read = 0;
+                engine.submit(f, 0, buf, [&](const size_t n, std::exception_ptr err) {
+                    num_read = err ? 0 : n;
+                    done.count_down();
+                });
+                done.wait();
+                expect_equal(buf.size(), num_read, backend_name);
+            };
+            "errors"_test = [&] {
+                const file::tmp tmp_f { "turbo-file-async-write-only.bin" };
+                const file::handle f { tmp_f.path(), file::open_mode::write };
+                uint8_vector buf(16);
+                const std::vector<file::async_read> reqs { { f, 0, buf } };
+                expect(throws([&] { engine.read_batch(reqs); })) << backend_name;
+                expect(throws([&] { file::async_engine { backend, 0 }; }));
+            };
+        }
+    };
+};
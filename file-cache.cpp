@@ -0,0 +1,219 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#ifndef _WIN32
+#   include <sys/resource.h>
+#endif
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include "file-cache.hpp"
+#include "mutex.hpp"
+
+namespace turbo::file {
+    struct handle_cache::state_t: std::enable_shared_from_this<state_t> {
+        explicit state_t(const size_t capacity):
+            _capacity { capacity }
+        {
+        }
+
+        handle_ptr open(const std::string &path)
+        {
+            entry_ptr e {};
+            {
+                mutex::scoped_lock lk { _mutex };
+                auto [it, created] = _index.try_emplace(path);
+                if (created) {
+                    try {
+                        it->second = std::make_shared<entry_t>(path);
+                    } catch (...) {
+                        _index.erase(it);
+                        throw;
+                    }
+                    ++_stats.misses;
+                    // makes room for the new handle before it is opened
+                    _evict_idle(_capacity);
+                } else {
+                    ++_stats.hits;
+                    if (auto h = it->second->lease.lock())
+                        return h;
+                }
+                e = it->second;
+            }
+            // concurrent users of the same path wait for a single open, the users of other paths are not affected
+            try {
+                std::call_once(e->opened, [&] {
+                    e->h.emplace(path);
+                });
+            } catch (...) {
+                mutex::scoped_lock lk { _mutex };
+                if (const auto it = _index.find(path); it != _index.end() && it->second == e) {
+                    _index.erase(it);
+                    e->cached = false;
+                }
+                throw;
+            }
+            mutex::scoped_lock lk { _mutex };
+            if (auto h = e->lease.lock())
+                return h;
+            if (e->idle) {
+                _idle.erase(e->idle_it);
+                e->idle = false;
+            }
+            // a lease is created only when the entry becomes active; the later hits share it without an allocation
+            auto lease = std::make_shared<lease_t>(shared_from_this(), e, ++e->generation);
+            handle_ptr h { lease, &*e->h };
+            e->lease = h;
+            return h;
+        }
+
+        void erase(const std::string &path)
+        {
+            mutex::scoped_lock lk { _mutex };
+            if (const auto it = _index.find(path); it != _index.end()) {
+                // the current users keep their references, so the handle is closed once they are done
+                _drop(*it->second);
+                _index.erase(it);
+            }
+        }
+
+        void clear()
+        {
+            mutex::scoped_lock lk { _mutex };
+            while (!_idle.empty())
+                _evict_lru();
+        }
+
+        stats_t stats() const
+        {
+            mutex::scoped_lock lk { _mutex };
+            auto st = _stats;
+            st.size = _index.size();
+            return st;
+        }
+    private:
+        struct entry_t {
+            const std::string path;
+            std::once_flag opened {};
+            std::optional<handle> h {};
+            std::weak_ptr<const handle> lease {};
+            // distinguishes the release of an expired lease from the release of the current one
+            uint64_t generation = 0;
+            std::list<std::shared_ptr<entry_t>>::iterator idle_it {};
+            bool idle = false;
+            bool cached = true;
+
+            explicit entry_t(const std::string &p):
+                path { p }
+            {
+            }
+        };
+        using entry_ptr = std::shared_ptr<entry_t>;
+
+        // Returns the entry to the idle list once the last user of the handle is done with it.
+        // Holds the entry, so that the handle stays open even when the entry has been evicted or erased.
+        struct lease_t {
+            std::shared_ptr<state_t> state;
+            entry_ptr e;
+            uint64_t generation;
+
+            lease_t(std::shared_ptr<state_t> st, entry_ptr en, const uint64_t gen):
+                state { std::move(st) }, e { std::move(en) }, generation { gen }
+            {
+            }
+
+            ~lease_t()
+            {
+                state->_release(e, generation);
+            }
+        };
+
+        const size_t _capacity;
+        mutable mutex::unique_lock::mutex_type _mutex alignas(mutex::alignment) {};
+        std::unordered_map<std::string, entry_ptr> _index {};
+        // the entries without users, the most recently used first
+        std::list<entry_ptr> _idle {};
+        stats_t _stats {};
+
+        void _release(const entry_ptr &e, const uint64_t generation) noexcept
+        {
+            mutex::scoped_lock lk { _mutex };
+            // a newer lease may have been created after this one expired but before its release took the lock
+            if (!e->cached || e->generation != generation)
+                return;
+            try {
+                _idle.emplace_front(e);
+            } catch (...) {
+                // without a place in the idle list, the entry is dropped and its handle closed
+                _index.erase(e->path);
+                e->cached = false;
+                return;
+            }
+            e->idle_it = _idle.begin();
+            e->idle = true;
+            // the cache could have grown beyond its capacity while all its handles were in use
+            _evict_idle(_capacity);
+        }
+
+        void _drop(entry_t &e)
+        {
+            if (e.idle) {
+                _idle.erase(e.idle_it);
+                e.idle = false;
+            }
+            e.cached = false;
+        }
+
+        void _evict_lru()
+        {
+            const auto e = _idle.back();
+            _drop(*e);
+            _index.erase(e->path);
+            ++_stats.evictions;
+        }
+
+        void _evict_idle(const size_t max_size)
+        {
+            while (_index.size() > max_size && !_idle.empty())
+                _evict_lru();
+        }
+    };
+
+    size_t handle_cache::default_capacity()
+    {
+        size_t limit = max_open_files;
+#       ifndef _WIN32
+            if (struct rlimit lim {}; getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur != RLIM_INFINITY)
+                limit = static_cast<size_t>(lim.rlim_cur);
+#       endif
+        return std::max(limit / 4 * 3, size_t { 1 });
+    }
+
+    handle_cache::handle_cache(const size_t capacity):
+        _capacity { capacity }
+    {
+        if (_capacity == 0) [[unlikely]]
+            throw error("the capacity of a handle cache must be positive");
+        _state = std::make_shared<state_t>(_capacity);
+    }
+
+    handle_cache::handle_ptr handle_cache::open(const std::string &path)
+    {
+        return _state->open(path);
+    }
+
+    void handle_cache::erase(const std::string &path)
+    {
+        _state->erase(path);
+    }
+
+    void handle_cache::clear()
+    {
+        _state->clear();
+    }
+
+    handle_cache::stats_t handle_cache::stats() const
+    {
+        return _state->stats();
+    }
+}
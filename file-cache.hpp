@@ -0,0 +1,65 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <memory>
+#include "file.hpp"
+
+namespace turbo::file {
+    // Shares read-only handles between the users of the same path, so that random-access lookups
+    // over many files do not pay for an open and a close per lookup. Once the number of cached handles
+    // reaches the capacity, the least recently used handles that are not in use are closed.
+    // A cached handle keeps referring to the file that was open at the time, so paths whose files
+    // are replaced must be erased from the cache.
+    // Files are opened outside of the cache's lock, so a slow open delays only the users of the same path.
+    // The handles may outlive the cache.
+    struct handle_cache {
+        using handle_ptr = std::shared_ptr<const handle>;
+
+        struct stats_t {
+            size_t hits = 0;
+            size_t misses = 0;
+            size_t evictions = 0;
+            size_t size = 0;
+        };
+
+        static handle_cache &get()
+        {
+            static handle_cache cache {};
+            return cache;
+        }
+
+        // three quarters of the process's limit on open files, leaving the rest to other users
+        static size_t default_capacity();
+
+        explicit handle_cache(size_t capacity=default_capacity());
+        handle_cache(const handle_cache &) =delete;
+
+        handle_ptr open(const std::string &path);
+        void erase(const std::string &path);
+        // closes all handles that are not in use
+        void clear();
+        [[nodiscard]] stats_t stats() const;
+
+        [[nodiscard]] size_t capacity() const noexcept
+        {
+            return _capacity;
+        }
+    private:
+        struct state_t;
+
+        const size_t _capacity;
+        // shared with the handed-out handles, which return their entries to the idle list once released
+        std::shared_ptr<state_t> _state;
+    };
+}
+
+namespace fmt {
+    template<>
+    struct formatter<turbo::file::handle_cache::stats_t>: formatter<int> {
+        template<typename FormatContext>
+        auto format(const auto &v, FormatContext &ctx) const -> decltype(ctx.out()) {
+            return fmt::format_to(ctx.out(), "hits: {} misses: {} evictions: {} size: {}", v.hits, v.misses, v.evictions, v.size);
+        }
+    };
+}
@@ -0,0 +1,104 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <thread>
+#include <turbo/common/test.hpp>
+#include "file-cache.hpp"
+
+namespace {
+    using namespace turbo;
+}
+
+suite turbo_common_file_cache_suite = [] {
+    "turbo::common::file_cache"_test = [] {
+        const file::tmp_directory dir { "turbo-file-cache-test" };
+        std::vector<std::string> paths {};
+        for (size_t i = 0; i < 4; ++i) {
+            const auto &p = paths.emplace_back(fmt::format("{}/f{}.bin", dir.path(), i));
+            file::write(p, buffer::from(i));
+        }
+        "hits and misses"_test = [&] {
+            file::handle_cache cache { 8 };
+            const auto h1 = cache.open(paths[0]);
+            const auto h2 = cache.open(paths[0]);
+            expect(h1 == h2);
+            uint64_t val = 0;
+            expect_equal(sizeof(val), h2->pread(std::span { reinterpret_cast<uint8_t *>(&val), sizeof(val) }, 0));
+            expect_equal(uint64_t { 0 }, val);
+            const auto st = cache.stats();
+            expect_equal(size_t { 1 }, st.hits);
+            expect_equal(size_t { 1 }, st.misses);
+            expect_equal(size_t { 1 }, st.size);
+        };
+        "lru eviction"_test = [&] {
+            file::handle_cache cache { 2 };
+            const auto h0 = cache.open(paths[0]);
+            cache.open(paths[1]);
+            cache.open(paths[2]);
+            // paths[0] is in use, so paths[1] is evicted instead
+            expect_equal(size_t { 2 }, cache.stats().size);
+            expect_equal(size_t { 1 }, cache.stats().evictions);
+            cache.open(paths[0]);
+            expect_equal(size_t { 1 }, cache.stats().hits);
+            cache.open(paths[1]);
+            expect_equal(size_t { 4 }, cache.stats().misses);
+            // when all handles are in use, the cache grows beyond its capacity
+            const auto h1 = cache.open(paths[1]);
+            const auto h3 = cache.open(paths[3]);
+            expect_equal(size_t { 3 }, cache.stats().size);
+            cache.clear();
+            expect_equal(size_t { 3 }, cache.stats().size);
+        };
+        "idle order"_test = [&] {
+            file::handle_cache cache { 3 };
+            for (size_t i = 0; i < 3; ++i)
+                cache.open(paths[i]);
+            // a released handle becomes the most recently used idle one
+            cache.open(paths[0]);
+            cache.open(paths[3]);
+            expect_equal(size_t { 1 }, cache.stats().evictions);
+            cache.open(paths[0]);
+            cache.open(paths[2]);
+            expect_equal(size_t { 5 }, cache.stats().misses + cache.stats().evictions);
+            cache.open(paths[1]);
+            expect_equal(size_t { 5 }, cache.stats().misses);
+        };
+        "concurrent users"_test = [&] {
+            file::handle_cache cache { 2 };
+            std::vector<std::thread> threads {};
+            std::atomic_size_t errors { 0 };
+            for (size_t t = 0; t < 4; ++t) {
+                threads.emplace_back([&, t] {
+                    for (size_t i = 0; i < 1000; ++i) {
+                        const auto idx = (t + i) % paths.size();
+                        const auto h = cache.open(paths[idx]);
+                        uint64_t val = 0;
+                        if (h->pread(std::span { reinterpret_cast<uint8_t *>(&val), sizeof(val) }, 0) != sizeof(val) || val != idx)
+                            ++errors;
+                    }
+                });
+            }
+            for (auto &t: threads)
+                t.join();
+            expect_equal(size_t { 0 }, errors.load());
+            const auto st = cache.stats();
+            expect_equal(size_t { 4000 }, st.hits + st.misses);
+            expect(st.size <= 2) << st.size;
+        };
+        "erase"_test = [&] {
+            file::handle_cache cache { 4 };
+            const auto h = cache.open(paths[3]);
+            cache.erase(paths[3]);
+            expect_equal(size_t { 0 }, cache.stats().size);
+            expect(h->fd() >= 0);
+            expect(h != cache.open(paths[3]));
+        };
+        "errors"_test = [&] {
+            expect(throws([] { file::handle_cache { 0 }; }));
+            file::handle_cache cache { 4 };
+            expect(throws([&] { cache.open(dir.path() + "/missing.bin"); }));
+            expect_equal(size_t { 0 }, cache.stats().size);
+            expect(file::handle_cache::default_capacity() > 0);
+        };
+    };
+};
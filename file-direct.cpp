@@ -0,0 +1,246 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#ifdef _WIN32
+#   include <io.h>
+#else
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+#include <cerrno>
+#include <cstring>
+#include "file-async.hpp"
+#include "file-direct.hpp"
+#include "logger.hpp"
+
+namespace turbo::file {
+    static void _truncate(const handle &f, const uint64_t size)
+    {
+#       ifdef _WIN32
+            if (::_chsize_s(f.fd(), static_cast<__int64>(size)) != 0) [[unlikely]]
+#       else
+            if (::ftruncate(f.fd(), static_cast<off_t>(size)) != 0) [[unlikely]]
+#       endif
+                throw error_sys(fmt::format("failed to truncate {} to {} bytes", f.path(), size));
+    }
+
+    static void _preallocate(const handle &f, const uint64_t size)
+    {
+#       ifdef __linux__
+            // FALLOC_FL_KEEP_SIZE keeps the reported size at zero, so that a crash does not leave trailing garbage
+            if (::fallocate(f.fd(), FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(size)) != 0) [[unlikely]] {
+                // preallocation is only an optimization, so file systems not supporting it are fine
+                if (errno != EOPNOTSUPP && errno != ENOSYS)
+                    throw error_sys(fmt::format("failed to preallocate {} bytes for {}", size, f.path()));
+            }
+#       else
+            // other platforms allocate the space as the data is written
+            (void)f;
+            (void)size;
+#       endif
+    }
+
+    static const std::string &_create_parent_dirs(const std::string &path)
+    {
+        const auto dir_path = std::filesystem::path { path }.parent_path();
+        if (!dir_path.empty())
+            std::filesystem::create_directories(dir_path);
+        return path;
+    }
+
+    aligned_buffer::~aligned_buffer()
+    {
+        if (_pool)
+            _pool->_release(_data);
+    }
+
+    aligned_buffer &aligned_buffer::operator=(aligned_buffer &&o) noexcept
+    {
+        if (this != &o) [[likely]] {
+            if (_pool)
+                _pool->_release(_data);
+            _pool = std::exchange(o._pool, nullptr);
+            _data = std::exchange(o._data, nullptr);
+            _size = std::exchange(o._size, 0);
+        }
+        return *this;
+    }
+
+    aligned_buffer_pool::aligned_buffer_pool(const size_t buffer_size, const size_t max_free):
+        _buffer_size { buffer_size }, _max_free { max_free }
+    {
+        if (_buffer_size == 0 || _buffer_size % handle::direct_alignment != 0) [[unlikely]]
+            throw error(fmt::format("the buffer size must be a positive multiple of {} but got {}", handle::direct_alignment, _buffer_size));
+    }
+
+    aligned_buffer_pool::~aligned_buffer_pool()
+    {
+        for (auto *data: _free)
+            operator delete[](data, std::align_val_t { handle::direct_alignment });
+    }
+
+    aligned_buffer aligned_buffer_pool::acquire()
+    {
+        {
+            mutex::scoped_lock lk { _free_mutex };
+            if (!_free.empty()) {
+                auto *data = _free.back();
+                _free.pop_back();
+                return { *this, data, _buffer_size };
+            }
+        }
+        return { *this, static_cast<uint8_t *>(operator new[](_buffer_size, std::align_val_t { handle::direct_alignment })), _buffer_size };
+    }
+
+    void aligned_buffer_pool::_release(uint8_t *data) noexcept
+    {
+        {
+            mutex::scoped_lock lk { _free_mutex };
+            if (_free.size() < _max_free) {
+                _free.emplace_back(data);
+                return;
+            }
+        }
+        operator delete[](data, std::align_val_t { handle::direct_alignment });
+    }
+
+    direct_read_stream::direct_read_stream(const std::string &path, const size_t readahead_depth, aligned_buffer_pool &pool):
+        _file { path, open_mode::read, true }, _pool { pool }, _readahead_depth { readahead_depth }, _size { _file.size() }
+    {
+        if (_readahead_depth == 0) [[unlikely]]
+            throw error(fmt::format("the readahead depth for {} must be positive", path));
+        _fill();
+    }
+
+    direct_read_stream::~direct_read_stream()
+    {
+        logger::run_log_errors([&] {
+            close();
+        });
+    }
+
+    void direct_read_stream::close()
+    {
+        _drain();
+        _chunks.clear();
+        _file.close();
+    }
+
+    void direct_read_stream::seek(const uint64_t off)
+    {
+        _drain();
+        _chunks.clear();
+        _pos = off;
+        _next_offset = off - off % handle::direct_alignment;
+        _fill();
+    }
+
+    size_t direct_read_stream::try_read(const std::span<uint8_t> buf)
+    {
+        size_t done = 0;
+        while (done < buf.size() && _pos < _size) {
+            if (_chunks.empty()) [[unlikely]]
+                throw error(fmt::format("no reads in flight at position {} of {}", _pos, _file.path()));
+            auto &c = _chunks.front();
+            if (!c.num_read)
+                c.num_read = c.pending.get();
+            const auto chunk_end = c.offset + *c.num_read;
+            if (_pos >= chunk_end) {
+                if (chunk_end < c.offset + c.buf.size() && chunk_end < _size) [[unlikely]]
+                    throw error(fmt::format("{} has been truncated while being read at position {}", _file.path(), chunk_end));
+                _chunks.pop_front();
+                _fill();
+                continue;
+            }
+            const auto n = std::min(buf.size() - done, static_cast<size_t>(chunk_end - _pos));
+            std::memcpy(buf.data() + done, c.buf.data() + (_pos - c.offset), n);
+            done += n;
+            _pos += n;
+        }
+        return done;
+    }
+
+    void direct_read_stream::read(void *data, const size_t num_bytes)
+    {
+        if (const auto num_read = try_read(std::span { reinterpret_cast<uint8_t *>(data), num_bytes }); num_read != num_bytes) [[unlikely]]
+            throw error(fmt::format("could read only {} bytes instead of {} from {}", num_read, num_bytes, _file.path()));
+    }
+
+    void direct_read_stream::_fill()
+    {
+        while (_chunks.size() < _readahead_depth && _next_offset < _size) {
+            auto &c = _chunks.emplace_back(_pool.acquire(), _next_offset);
+            _next_offset += c.buf.size();
+            auto done = std::make_shared<std::promise<size_t>>();
+            c.pending = done->get_future();
+            async_engine::get().submit(_file, c.offset, c.buf, [done](const size_t num_read, std::exception_ptr err) {
+                if (err) [[unlikely]]
+                    done->set_exception(std::move(err));
+                else
+                    done->set_value(num_read);
+            });
+        }
+    }
+
+    void direct_read_stream::_drain() noexcept
+    {
+        // the buffers must not be released while the engine may still write into them
+        for (auto &c: _chunks) {
+            if (c.pending.valid())
+                c.pending.wait();
+        }
+    }
+
+    direct_write_stream::direct_write_stream(const std::string &path, const uint64_t preallocate, aligned_buffer_pool &pool):
+        _file { _create_parent_dirs(path), open_mode::write, true }, _buf { pool.acquire() }
+    {
+        _truncate(_file, 0);
+        if (preallocate)
+            _preallocate(_file, preallocate);
+    }
+
+    direct_write_stream::~direct_write_stream()
+    {
+        logger::run_log_errors([&] {
+            close();
+        });
+    }
+
+    void direct_write_stream::close()
+    {
+        if (_file.fd() < 0)
+            return;
+        const auto logical_size = tellp();
+        if (_buf_used) {
+            const auto padded_size = (_buf_used + handle::direct_alignment - 1) / handle::direct_alignment * handle::direct_alignment;
+            std::memset(_buf.data() + _buf_used, 0, padded_size - _buf_used);
+            _flush_buffer(padded_size);
+        }
+        // drops the padding as well as any preallocated space beyond the written data
+        _truncate(_file, logical_size);
+        _file.close();
+        _buf = {};
+    }
+
+    void direct_write_stream::write(const void *data, const size_t num_bytes)
+    {
+        if (_file.fd() < 0) [[unlikely]]
+            throw error(fmt::format("write to a closed stream {}", _file.path()));
+        const auto *src = static_cast<const uint8_t *>(data);
+        for (size_t done = 0; done < num_bytes; ) {
+            const auto n = std::min(num_bytes - done, _buf.size() - _buf_used);
+            std::memcpy(_buf.data() + _buf_used, src + done, n);
+            _buf_used += n;
+            done += n;
+            if (_buf_used == _buf.size())
+                _flush_buffer(_buf_used);
+        }
+    }
+
+    void direct_write_stream::_flush_buffer(const size_t num_bytes)
+    {
+        _file.pwrite(buffer { _buf.data(), num_bytes }, _flushed);
+        _flushed += _buf_used;
+        _buf_used = 0;
+    }
+}
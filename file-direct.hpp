@@ -0,0 +1,183 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <deque>
+#include <future>
+#include <vector>
+#include "file.hpp"
+#include "mutex.hpp"
+
+namespace turbo::file {
+    struct aligned_buffer_pool;
+
+    // A buffer suitable for direct I/O that returns its memory to its pool once destroyed.
+    struct aligned_buffer {
+        aligned_buffer() =default;
+
+        aligned_buffer(aligned_buffer_pool &pool, uint8_t *data, const size_t size) noexcept:
+            _pool { &pool }, _data { data }, _size { size }
+        {
+        }
+
+        aligned_buffer(const aligned_buffer &) =delete;
+
+        aligned_buffer(aligned_buffer &&o) noexcept:
+            _pool { std::exchange(o._pool, nullptr) }, _data { std::exchange(o._data, nullptr) }, _size { std::exchange(o._size, 0) }
+        {
+        }
+
+        ~aligned_buffer();
+
+        aligned_buffer &operator=(const aligned_buffer &) =delete;
+        aligned_buffer &operator=(aligned_buffer &&o) noexcept;
+
+        [[nodiscard]] uint8_t *data() const noexcept
+        {
+            return _data;
+        }
+
+        [[nodiscard]] size_t size() const noexcept
+        {
+            return _size;
+        }
+
+        operator write_buffer() const noexcept
+        {
+            return { _data, _size };
+        }
+    private:
+        aligned_buffer_pool *_pool = nullptr;
+        uint8_t *_data = nullptr;
+        size_t _size = 0;
+    };
+
+    // A thread-safe pool of equally-sized buffers aligned to handle::direct_alignment.
+    // Keeps up to max_free released buffers for reuse, so that streams opened one after another
+    // do not pay for allocating and faulting in fresh memory.
+    struct aligned_buffer_pool {
+        static constexpr size_t default_buffer_size = size_t { 1 } << 22U;
+
+        static aligned_buffer_pool &get()
+        {
+            static aligned_buffer_pool pool {};
+            return pool;
+        }
+
+        explicit aligned_buffer_pool(size_t buffer_size=default_buffer_size, size_t max_free=64);
+        aligned_buffer_pool(const aligned_buffer_pool &) =delete;
+        ~aligned_buffer_pool();
+
+        aligned_buffer acquire();
+
+        [[nodiscard]] size_t buffer_size() const noexcept
+        {
+            return _buffer_size;
+        }
+
+        [[nodiscard]] size_t free_count() const
+        {
+            mutex::scoped_lock lk { _free_mutex };
+            return _free.size();
+        }
+    private:
+        friend aligned_buffer;
+
+        const size_t _buffer_size;
+        const size_t _max_free;
+        mutable mutex::unique_lock::mutex_type _free_mutex alignas(mutex::alignment) {};
+        std::vector<uint8_t *> _free {};
+
+        void _release(uint8_t *data) noexcept;
+    };
+
+    // Sequential reads that bypass the page cache, so that streaming through a large file once
+    // does not evict hot data. Keeps readahead_depth buffer-sized reads in flight through
+    // the async_engine and serves reads of any size and alignment from them.
+    struct direct_read_stream {
+        static constexpr size_t default_readahead_depth = 4;
+
+        explicit direct_read_stream(const std::string &path, size_t readahead_depth=default_readahead_depth,
+            aligned_buffer_pool &pool=aligned_buffer_pool::get());
+        direct_read_stream(const direct_read_stream &) =delete;
+        ~direct_read_stream();
+
+        [[nodiscard]] bool eof() const noexcept
+        {
+            return _pos >= _size;
+        }
+
+        [[nodiscard]] uint64_t size() const noexcept
+        {
+            return _size;
+        }
+
+        [[nodiscard]] uint64_t tellg() const noexcept
+        {
+            return _pos;
+        }
+
+        [[nodiscard]] bool direct() const noexcept
+        {
+            return _file.direct();
+        }
+
+        void close();
+        void seek(uint64_t off);
+        size_t try_read(std::span<uint8_t> buf);
+        void read(void *data, size_t num_bytes);
+    private:
+        struct chunk {
+            aligned_buffer buf;
+            uint64_t offset = 0;
+            std::future<size_t> pending {};
+            std::optional<size_t> num_read {};
+        };
+
+        handle _file;
+        aligned_buffer_pool &_pool;
+        const size_t _readahead_depth;
+        uint64_t _size = 0;
+        uint64_t _pos = 0;
+        uint64_t _next_offset = 0;
+        std::deque<chunk> _chunks {};
+
+        void _fill();
+        void _drain() noexcept;
+    };
+
+    // Sequential writes that bypass the page cache. Data is collected into aligned buffers and written
+    // a full buffer at a time; the unaligned tail is padded on close and the file is then truncated to its
+    // logical size. preallocate reserves disk space upfront to reduce fragmentation of large outputs.
+    struct direct_write_stream {
+        explicit direct_write_stream(const std::string &path, uint64_t preallocate=0,
+            aligned_buffer_pool &pool=aligned_buffer_pool::get());
+        direct_write_stream(const direct_write_stream &) =delete;
+        ~direct_write_stream();
+
+        [[nodiscard]] uint64_t tellp() const noexcept
+        {
+            return _flushed + _buf_used;
+        }
+
+        [[nodiscard]] bool direct() const noexcept
+        {
+            return _file.direct();
+        }
+
+        void close();
+        void write(const void *data, size_t num_bytes);
+
+        void write(const buffer data)
+        {
+            write(data.data(), data.size());
+        }
+    private:
+        handle _file;
+        aligned_buffer _buf;
+        size_t _buf_used = 0;
+        uint64_t _flushed = 0;
+
+        void _flush_buffer(size_t num_bytes);
+    };
+}
@@ -0,0 +1,78 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <turbo/common/test.hpp>
+#include "file-direct.hpp"
+
+using namespace turbo;
+
+suite turbo_common_file_direct_suite = [] {
+    "turbo::common::file_direct"_test = [] {
+        const file::tmp_directory dir { "turbo-file-direct-test" };
+        // a small buffer size to exercise the buffer boundaries
+        file::aligned_buffer_pool pool { 8192, 4 };
+        "aligned_buffer_pool"_test = [&] {
+            const uint8_t *first_data = nullptr;
+            {
+                auto buf = pool.acquire();
+                expect_equal(size_t { 8192 }, buf.size());
+                expect_equal(size_t { 0 }, reinterpret_cast<uintptr_t>(buf.data()) % file::handle::direct_alignment);
+                first_data = buf.data();
+            }
+            expect_equal(size_t { 1 }, pool.free_count());
+            const auto buf = pool.acquire();
+            expect(first_data == buf.data());
+            expect(throws([] { file::aligned_buffer_pool { 1000 }; }));
+        };
+        for (const size_t size: { size_t { 0 }, size_t { 100 }, size_t { 8192 }, size_t { 8192 * 5 + 1234 } }) {
+            const auto path = fmt::format("{}/data-{}.bin", dir.path(), size);
+            const auto data = test_data(size);
+            "write and read"_test = [&] {
+                {
+                    file::direct_write_stream ws { path, size, pool };
+                    // unaligned writes of various sizes
+                    for (size_t off = 0; off < data.size(); ) {
+                        const auto n = std::min(data.size() - off, off % 3 == 0 ? size_t { 1000 } : size_t { 9000 });
+                        ws.write(static_cast<buffer>(data).subbuf(off, n));
+                        off += n;
+                    }
+                    expect_equal(static_cast<uint64_t>(size), ws.tellp());
+                }
+                expect_equal(static_cast<uintmax_t>(size), std::filesystem::file_size(path));
+                expect(file::read(path) == data);
+                file::direct_read_stream rs { path, 2, pool };
+                expect_equal(static_cast<uint64_t>(size), rs.size());
+                uint8_vector res(size);
+                for (size_t off = 0; off < res.size(); ) {
+                    const auto n = std::min(res.size() - off, size_t { 777 });
+                    rs.read(res.data() + off, n);
+                    off += n;
+                }
+                expect(rs.eof());
+                expect(res == data) << size;
+                uint8_t extra;
+                expect_equal(size_t { 0 }, rs.try_read(std::span { &extra, 1 }));
+            };
+            if (size > 8192) {
+                "seek"_test = [&] {
+                    file::direct_read_stream rs { path, 3, pool };
+                    const size_t off = 8192 * 2 + 17;
+                    rs.seek(off);
+                    uint8_vector res(300);
+                    rs.read(res.data(), res.size());
+                    expect(static_cast<buffer>(res) == static_cast<buffer>(data).subbuf(off, res.size()));
+                    // reading past the end of the file
+                    res.resize(size);
+                    expect(throws([&] { rs.read(res.data(), res.size()); }));
+                };
+            }
+        }
+        "errors"_test = [&] {
+            expect(throws([&] { file::direct_read_stream { dir.path() + "/missing.bin", 2, pool }; }));
+            expect(throws([&] { file::direct_read_stream { dir.path() + "/data-100.bin", 0, pool }; }));
+            file::direct_write_stream ws { dir.path() + "/closed.bin", 0, pool };
+            ws.close();
+            expect(throws([&] { ws.write(buffer { reinterpret_cast<const uint8_t *>("abc"), 3 }); }));
+        };
+    };
+};
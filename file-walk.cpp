@@ -0,0 +1,277 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#ifdef __linux__
+#   include <dirent.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/stat.h>
+#   include <sys/syscall.h>
+#endif
+#include <condition_variable>
+#include <exception>
+#include <filesystem>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "error.hpp"
+#include "file-walk.hpp"
+#include "format.hpp"
+#include "mutex.hpp"
+
+namespace turbo::file {
+    namespace {
+        // reused between directories to avoid allocating per file
+        struct dir_batch {
+            std::string paths {};
+            std::vector<std::pair<size_t, uint64_t>> files {};
+            std::vector<walk_entry> entries {};
+
+            void clear()
+            {
+                paths.clear();
+                files.clear();
+                entries.clear();
+            }
+
+            void add(const std::string_view path, const uint64_t size)
+            {
+                files.emplace_back(paths.size(), size);
+                paths.append(path);
+            }
+
+            void notify(const walk_observer_t &on_files)
+            {
+                if (files.empty())
+                    return;
+                // the views are created only once all paths are appended, since appending can reallocate
+                for (size_t i = 0; i < files.size(); ++i) {
+                    const auto end = i + 1 < files.size() ? files[i + 1].first : paths.size();
+                    entries.emplace_back(std::string_view { paths }.substr(files[i].first, end - files[i].first), files[i].second);
+                }
+                on_files(entries);
+            }
+        };
+
+        struct walker {
+            walker(const std::string &root, const walk_observer_t &on_files, const walk_options &opts):
+                _root { root }, _on_files { on_files }, _opts { opts }
+            {
+                _todo.emplace_back(root);
+            }
+
+            void run()
+            {
+                _worker();
+                // every thread is added before its spawner finishes its directory, so the list is final once none is active;
+                // after an error, the calling thread can get here while others are still finishing their directories
+                std::vector<std::thread> threads {};
+                {
+                    mutex::unique_lock lk { _todo_mutex };
+                    _todo_cv.wait(lk, [&] { return _active == 0; });
+                    threads = std::move(_threads);
+                }
+                for (auto &t: threads)
+                    t.join();
+                if (_err) [[unlikely]]
+                    std::rethrow_exception(_err);
+            }
+        private:
+            const std::string &_root;
+            const walk_observer_t &_on_files;
+            const walk_options &_opts;
+            const size_t _max_threads = _opts.num_threads ? _opts.num_threads : std::max(std::thread::hardware_concurrency(), 1U);
+            mutex::unique_lock::mutex_type _todo_mutex alignas(mutex::alignment) {};
+            std::condition_variable_any _todo_cv {};
+            std::vector<std::string> _todo {};
+            std::vector<std::thread> _threads {};
+            size_t _num_threads = 1;
+            size_t _idle = 0;
+            size_t _active = 0;
+            std::exception_ptr _err {};
+
+            // most walks cover a few directories, so helper threads are started only once
+            // more directories are queued than the current threads can take
+            size_t _num_to_spawn() const noexcept
+            {
+                const auto takers = _idle + 1;
+                if (_todo.size() <= takers || _num_threads >= _max_threads)
+                    return 0;
+                return std::min(_todo.size() - takers, _max_threads - _num_threads);
+            }
+
+            void _spawn(const size_t num_threads)
+            {
+                std::vector<std::thread> threads {};
+                threads.reserve(num_threads);
+                try {
+                    for (size_t i = 0; i < num_threads; ++i)
+                        threads.emplace_back([this] { _worker(); });
+                } catch (const std::system_error &) {
+                    // the walk continues with the threads that have been started
+                }
+                mutex::scoped_lock lk { _todo_mutex };
+                _num_threads -= num_threads - threads.size();
+                for (auto &t: threads)
+                    _threads.emplace_back(std::move(t));
+            }
+
+            void _worker()
+            {
+                dir_batch batch {};
+                std::vector<std::string> subdirs {};
+                std::vector<char> dents(size_t { 1 } << 16U);
+                for (;;) {
+                    std::string dir {};
+                    {
+                        mutex::unique_lock lk { _todo_mutex };
+                        ++_idle;
+                        _todo_cv.wait(lk, [&] { return !_todo.empty() || _active == 0 || _err; });
+                        --_idle;
+                        // the walk is over once there is nothing queued and nobody can add more
+                        if (_err || _todo.empty())
+                            break;
+                        dir = std::move(_todo.back());
+                        _todo.pop_back();
+                        ++_active;
+                    }
+                    try {
+                        batch.clear();
+                        _scan(dir, batch, subdirs, dents);
+                        batch.notify(_on_files);
+                    } catch (...) {
+                        mutex::scoped_lock lk { _todo_mutex };
+                        if (!_err)
+                            _err = std::current_exception();
+                    }
+                    size_t num_to_spawn = 0;
+                    {
+                        mutex::scoped_lock lk { _todo_mutex };
+                        for (auto &d: subdirs)
+                            _todo.emplace_back(std::move(d));
+                        if (!_err) {
+                            num_to_spawn = _num_to_spawn();
+                            _num_threads += num_to_spawn;
+                        }
+                    }
+                    subdirs.clear();
+                    // spawned while still active, so that the walk cannot end before the new threads are recorded
+                    if (num_to_spawn)
+                        _spawn(num_to_spawn);
+                    {
+                        mutex::scoped_lock lk { _todo_mutex };
+                        --_active;
+                    }
+                    _todo_cv.notify_all();
+                }
+                _todo_cv.notify_all();
+            }
+
+#ifdef __linux__
+            // returns false when the entry has been removed since the directory was read, which is expected
+            // when walking directories that are being written
+            static bool _stat(const int dir_fd, const char *name, const int flags, const unsigned mask, struct statx &stx, const std::string &dir)
+            {
+                if (::statx(dir_fd, name, flags | AT_STATX_DONT_SYNC, mask, &stx) != 0) [[unlikely]] {
+                    if (errno == ENOENT)
+                        return false;
+                    throw error_sys(fmt::format("failed to stat {}/{}", dir, name));
+                }
+                return true;
+            }
+
+            void _scan(const std::string &dir, dir_batch &batch, std::vector<std::string> &subdirs, std::vector<char> &dents) const
+            {
+                const auto fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                if (fd < 0) [[unlikely]] {
+                    // a subdirectory removed since its parent was read is skipped, but a missing root is an error
+                    if (errno == ENOENT && dir != _root)
+                        return;
+                    throw error_sys(fmt::format("failed to open directory {}", dir));
+                }
+                try {
+                    std::string path { dir };
+                    if (!path.empty() && path.back() != '/')
+                        path.push_back('/');
+                    const auto dir_prefix_size = path.size();
+                    for (;;) {
+                        const auto num_read = ::syscall(SYS_getdents64, fd, dents.data(), dents.size());
+                        if (num_read < 0) [[unlikely]] {
+                            // the directory has been removed after it was opened
+                            if (errno == ENOENT)
+                                break;
+                            throw error_sys(fmt::format("failed to read directory {}", dir));
+                        }
+                        if (num_read == 0)
+                            break;
+                        for (long off = 0; off < num_read; ) {
+                            const auto *d = reinterpret_cast<const dirent64 *>(dents.data() + off);
+                            off += d->d_reclen;
+                            const std::string_view name { d->d_name };
+                            if (name == "." || name == "..")
+                                continue;
+                            auto type = d->d_type;
+                            uint64_t size = 0;
+                            struct statx stx {};
+                            if (type == DT_UNKNOWN) {
+                                // some file systems do not report the type in directory entries
+                                if (!_stat(fd, d->d_name, AT_SYMLINK_NOFOLLOW, STATX_TYPE | (_opts.sizes ? STATX_SIZE : 0U), stx, dir))
+                                    continue;
+                                type = S_ISDIR(stx.stx_mode) ? DT_DIR : S_ISREG(stx.stx_mode) ? DT_REG : S_ISLNK(stx.stx_mode) ? DT_LNK : DT_UNKNOWN;
+                                size = stx.stx_size;
+                            } else if (type == DT_REG && _opts.sizes) {
+                                if (!_stat(fd, d->d_name, AT_SYMLINK_NOFOLLOW, STATX_SIZE, stx, dir))
+                                    continue;
+                                size = stx.stx_size;
+                            }
+                            if (type == DT_LNK) {
+                                // links are reported only when they point to a regular file
+                                if (::statx(fd, d->d_name, AT_STATX_DONT_SYNC, STATX_TYPE | (_opts.sizes ? STATX_SIZE : 0U), &stx) != 0 || !S_ISREG(stx.stx_mode))
+                                    continue;
+                                type = DT_REG;
+                                size = stx.stx_size;
+                            }
+                            path.resize(dir_prefix_size);
+                            path.append(name);
+                            if (type == DT_DIR)
+                                subdirs.emplace_back(path);
+                            else if (type == DT_REG)
+                                batch.add(path, size);
+                        }
+                    }
+                } catch (...) {
+                    ::close(fd);
+                    throw;
+                }
+                ::close(fd);
+            }
+#else
+            void _scan(const std::string &dir, dir_batch &batch, std::vector<std::string> &subdirs, std::vector<char> &) const
+            {
+                std::error_code ec {};
+                std::filesystem::directory_iterator it { dir, ec };
+                // a subdirectory removed since its parent was read is skipped, but a missing root is an error
+                if (ec == std::errc::no_such_file_or_directory && dir != _root)
+                    return;
+                if (ec) [[unlikely]]
+                    throw error(fmt::format("failed to open directory {}: {}", dir, ec.message()));
+                for (const auto &entry: it) {
+                    if (entry.is_directory() && !entry.is_symlink()) {
+                        subdirs.emplace_back(entry.path().string());
+                    } else if (entry.is_regular_file()) {
+                        // Mac OS does not cache the size, so the file may be gone by the time it is requested
+                        std::error_code ec {};
+                        const auto size = _opts.sizes ? entry.file_size(ec) : 0;
+                        batch.add(entry.path().string(), ec ? 0 : size);
+                    }
+                }
+            }
+#endif
+        };
+    }
+
+    void walk(const std::string &dir, const walk_observer_t &on_files, const walk_options &opts)
+    {
+        walker { dir, on_files, opts }.run();
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace turbo::file {
+    struct walk_entry {
+        // valid only during the observer's call
+        std::string_view path;
+        // zero unless walk_options::sizes is set
+        uint64_t size = 0;
+
+        // the same as std::filesystem::path::extension but without allocating
+        [[nodiscard]] std::string_view extension() const noexcept
+        {
+            const auto name = path.substr(path.find_last_of("/\\") + 1);
+            const auto pos = name.rfind('.');
+            if (pos == name.npos || pos == 0)
+                return {};
+            return name.substr(pos);
+        }
+    };
+
+    struct walk_options {
+        // stat each regular file to report its size
+        bool sizes = false;
+        // the maximum number of threads including the calling one; zero means one thread per hardware thread.
+        // Helper threads are started only once more directories are queued than the running threads can take.
+        size_t num_threads = 0;
+    };
+
+    // Receives the regular files of one directory at a time. Called concurrently from the walker's threads.
+    using walk_observer_t = std::function<void(std::span<const walk_entry>)>;
+
+    // Recursively scans a directory, processing its subdirectories in parallel. On Linux, reads directories
+    // with getdents64 and stats files with statx requesting only the needed fields. Symbolic links to regular
+    // files are reported, symbolic links to directories are not followed. The walker runs its own short-lived
+    // threads, so it can be used from within scheduler tasks. Rethrows the first error after all threads stop.
+    extern void walk(const std::string &dir, const walk_observer_t &on_files, const walk_options &opts={});
+}
@@ -0,0 +1,114 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <set>
+#include <thread>
+#include <turbo/common/test.hpp>
+#include "file-walk.hpp"
+#include "mutex.hpp"
+
+namespace {
+    using namespace turbo;
+    using boost::ext::ut::v2_1_0::nothrow;
+}
+
+suite turbo_common_file_walk_suite = [] {
+    "turbo::common::file_walk"_test = [] {
+        const file::tmp_directory dir { "turbo-file-walk-test" };
+        std::map<std::string, uint64_t> expected {};
+        for (size_t i = 0; i < 20; ++i) {
+            const auto sub_dir = fmt::format("{}/d{}/e{}", dir.path(), i % 4, i % 3);
+            const auto path = fmt::format("{}/f{}.{}", sub_dir, i, i % 2 ? "chunk" : "zpp");
+            file::write(path, uint8_vector(i * 10));
+            expected.try_emplace(path, i * 10);
+        }
+        std::filesystem::create_directories(fmt::format("{}/empty/nested", dir.path()));
+        file::write(fmt::format("{}/.hidden", dir.path()), uint8_vector(7));
+        expected.try_emplace(fmt::format("{}/.hidden", dir.path()), 7);
+        // a link to a regular file is reported, a link to a directory is not followed
+        std::filesystem::create_symlink(fmt::format("{}/d0/e0/f0.zpp", dir.path()), fmt::format("{}/link.zpp", dir.path()));
+        std::filesystem::create_directory_symlink(fmt::format("{}/d1", dir.path()), fmt::format("{}/d1-link", dir.path()));
+        expected.try_emplace(fmt::format("{}/link.zpp", dir.path()), std::filesystem::file_size(fmt::format("{}/link.zpp", dir.path())));
+        for (const size_t num_threads: { 1, 4 }) {
+            "walk"_test = [&] {
+                std::map<std::string, uint64_t> res {};
+                mutex::unique_lock::mutex_type res_mutex {};
+                file::walk(dir.path(), [&](const auto files) {
+                    mutex::scoped_lock lk { res_mutex };
+                    for (const auto &f: files)
+                        res.try_emplace(std::string { f.path }, f.size);
+                }, file::walk_options { .sizes=true, .num_threads=num_threads });
+                expect(res == expected) << num_threads;
+            };
+        }
+        "lazy threads"_test = [] {
+            // a directory without subdirectories is scanned by the calling thread alone
+            const file::tmp_directory flat_dir { "turbo-file-walk-flat" };
+            for (size_t i = 0; i < 10; ++i)
+                file::write(fmt::format("{}/f{}.bin", flat_dir.path(), i), uint8_vector(i));
+            std::set<std::thread::id> thread_ids {};
+            mutex::unique_lock::mutex_type ids_mutex {};
+            file::walk(flat_dir.path(), [&](const auto) {
+                mutex::scoped_lock lk { ids_mutex };
+                thread_ids.emplace(std::this_thread::get_id());
+            }, file::walk_options { .num_threads=8 });
+            expect_equal(size_t { 1 }, thread_ids.size());
+            expect(thread_ids.contains(std::this_thread::get_id()));
+        };
+        "extension"_test = [] {
+            expect_equal(std::string_view { ".chunk" }, file::walk_entry { "/a/b.c/x.y.chunk" }.extension());
+            expect_equal(std::string_view {}, file::walk_entry { "/a/b.c/x" }.extension());
+            expect_equal(std::string_view {}, file::walk_entry { "/a/.hidden" }.extension());
+        };
+        "helpers"_test = [&] {
+            uint64_t total = 0;
+            uint64_t chunk_total = 0;
+            std::vector<std::string> chunks {};
+            for (const auto &[p, sz]: expected) {
+                total += sz;
+                if (p.ends_with(".chunk")) {
+                    chunk_total += sz;
+                    chunks.emplace_back(p);
+                }
+            }
+            expect_equal(total, file::disk_used(dir.path()));
+            expect_equal(total, file::dir_size_recursive(dir.path()));
+            expect_equal(chunk_total, file::dir_size_recursive(dir.path(), ".chunk"));
+            expect(file::files_with_ext(dir.path(), ".chunk") == chunks);
+        };
+        "concurrent removal"_test = [] {
+            // the files and directories removed between reading their parent and accessing them are skipped
+            const file::tmp_directory dir { "turbo-file-walk-removal" };
+            std::vector<std::string> paths {};
+            for (size_t i = 0; i < 5000; ++i)
+                file::write(paths.emplace_back(fmt::format("{}/f{}.bin", dir.path(), i)), uint8_vector(16));
+            std::vector<std::string> sub_dirs {};
+            for (size_t i = 0; i < 500; ++i) {
+                const auto &sub_dir = sub_dirs.emplace_back(fmt::format("{}/d{}", dir.path(), i));
+                file::write(fmt::format("{}/e/f.bin", sub_dir), uint8_vector(16));
+            }
+            std::atomic_bool done { false };
+            std::thread remover { [&] {
+                for (size_t i = 0; i < paths.size(); ++i) {
+                    std::filesystem::remove(paths[i]);
+                    if (i % 10 == 0)
+                        std::filesystem::remove_all(sub_dirs[i / 10]);
+                }
+                done = true;
+            } };
+            expect(nothrow([&] {
+                do {
+                    expect(file::dir_size_recursive(dir.path()) <= (paths.size() + sub_dirs.size()) * 16);
+                } while (!done);
+            }));
+            remover.join();
+            expect_equal(0U, file::dir_size_recursive(dir.path()));
+        };
+        "errors"_test = [&] {
+            expect(throws([&] { file::walk(dir.path() + "/missing", [](const auto) {}); }));
+            expect(throws([&] {
+                file::walk(dir.path(), [](const auto) { throw error("observer failure"); });
+            }));
+        };
+    };
+};
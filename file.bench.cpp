@@ -0,0 +1,193 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <turbo/common/benchmark.hpp>
+#include "file-async.hpp"
+#include "file-cache.hpp"
+#include "file-direct.hpp"
+#include "file-walk.hpp"
+
+namespace {
+    using namespace turbo;
+
+    std::vector<std::string> make_files(const file::tmp_directory &dir, const size_t num_files, const size_t file_size)
+    {
+        uint8_vector data(file_size);
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<uint8_t>(i * 31);
+        std::vector<std::string> paths {};
+        for (size_t i = 0; i < num_files; ++i) {
+            const auto &path = paths.emplace_back(fmt::format("{}/file-{}.bin", dir.path(), i));
+            file::write(path, data);
+        }
+        return paths;
+    }
+}
+
+suite turbo_common_file_bench_suite = [] {
+    "turbo::common::file"_test = [] {
+        for (const auto &[num_files, file_size]: { std::pair<size_t, size_t> { 1000, 1ULL << 20U }, std::pair<size_t, size_t> { 100, 100ULL << 20U } }) {
+            const file::tmp_directory dir { "turbo-file-bench" };
+            const auto paths = make_files(dir, num_files, file_size);
+            ankerl::nanobench::Bench b {};
+            b.title(fmt::format("turbo::common::file read {} x {} MB", num_files, file_size >> 20U))
+                .output(&std::cerr)
+                .unit("byte")
+                .performanceCounters(true)
+                .relative(true)
+                .batch(num_files * file_size);
+            b.run("file::read loop", [&] {
+                for (const auto &p: paths)
+                    ankerl::nanobench::doNotOptimizeAway(file::read(p));
+            });
+            file::async_engine uring_engine {};
+            b.run(uring_engine.backend() == file::async_backend::io_uring ? "async_engine io_uring" : "async_engine automatic (thread pool)", [&] {
+                ankerl::nanobench::doNotOptimizeAway(uring_engine.read_files(paths));
+            });
+            file::async_engine pool_engine { file::async_backend::thread_pool };
+            b.run("async_engine thread pool", [&] {
+                ankerl::nanobench::doNotOptimizeAway(pool_engine.read_files(paths));
+            });
+        }
+    };
+    "turbo::common::file streams"_test = [] {
+        static constexpr size_t file_size = size_t { 1 } << 30U;
+        static constexpr size_t chunk_size = size_t { 1 } << 20U;
+        const file::tmp_directory dir { "turbo-file-stream-bench" };
+        const auto path = fmt::format("{}/stream.bin", dir.path());
+        uint8_vector chunk(chunk_size);
+        for (size_t i = 0; i < chunk.size(); ++i)
+            chunk[i] = static_cast<uint8_t>(i * 31);
+        ankerl::nanobench::Bench b {};
+        b.title(fmt::format("turbo::common::file streams {} MB", file_size >> 20U))
+            .output(&std::cerr)
+            .unit("byte")
+            .performanceCounters(true)
+            .relative(true)
+            .batch(file_size);
+        b.run("write_stream", [&] {
+            file::write_stream ws { path, chunk_size };
+            for (size_t i = 0; i < file_size / chunk_size; ++i)
+                ws.write(chunk);
+        });
+        b.run("direct_write_stream", [&] {
+            file::direct_write_stream ws { path, file_size };
+            for (size_t i = 0; i < file_size / chunk_size; ++i)
+                ws.write(chunk);
+        });
+        b.run("read_stream", [&] {
+            file::read_stream rs { path, chunk_size };
+            while (rs.try_read(chunk) > 0)
+                ankerl::nanobench::doNotOptimizeAway(chunk);
+        });
+        b.run("direct_read_stream", [&] {
+            file::direct_read_stream rs { path };
+            while (rs.try_read(chunk) > 0)
+                ankerl::nanobench::doNotOptimizeAway(chunk);
+        });
+    };
+    "turbo::common::file atomic_writer"_test = [] {
+        static constexpr size_t num_files = 1000;
+        const file::tmp_directory dir { "turbo-file-atomic-bench" };
+        std::vector<std::string> paths {};
+        for (size_t i = 0; i < num_files; ++i)
+            paths.emplace_back(fmt::format("{}/small-{}.bin", dir.path(), i));
+        const uint8_vector data(4096);
+        ankerl::nanobench::Bench b {};
+        b.title(fmt::format("turbo::common::file atomic_writer {} x 4 KB", num_files))
+            .output(&std::cerr)
+            .unit("file")
+            .relative(true)
+            .batch(num_files);
+        for (const auto dur: { file::durability::none, file::durability::full }) {
+            for (const auto batch: { false, true }) {
+                b.run(fmt::format("durability: {} batch: {}", dur == file::durability::full ? "full" : "none", batch), [&] {
+                    file::atomic_writer w { dur, batch };
+                    for (const auto &p: paths)
+                        w.write(p, data);
+                    w.commit();
+                });
+            }
+        }
+    };
+    "turbo::common::file walk"_test = [] {
+        static constexpr size_t num_dirs = 1000;
+        static constexpr size_t files_per_dir = 1000;
+        const file::tmp_directory dir { "turbo-file-walk-bench" };
+        for (size_t d = 0; d < num_dirs; ++d) {
+            const auto sub_dir = fmt::format("{}/{:02}/{:03}", dir.path(), d % 100, d);
+            std::filesystem::create_directories(sub_dir);
+            for (size_t f = 0; f < files_per_dir; ++f)
+                file::write_stream { fmt::format("{}/{}.chunk", sub_dir, f) }.write(buffer::from(f));
+        }
+        ankerl::nanobench::Bench b {};
+        b.title(fmt::format("turbo::common::file walk {} files", num_dirs * files_per_dir))
+            .output(&std::cerr)
+            .unit("file")
+            .relative(true)
+            .epochs(1)
+            .batch(num_dirs * files_per_dir);
+        b.run("recursive_directory_iterator files_with_ext", [&] {
+            std::vector<std::filesystem::path> res {};
+            for (auto &entry: std::filesystem::recursive_directory_iterator(dir.path())) {
+                if (entry.is_regular_file() && entry.path().extension().string() == ".chunk")
+                    res.emplace_back(entry.path());
+            }
+            std::sort(res.begin(), res.end());
+            ankerl::nanobench::doNotOptimizeAway(res);
+        });
+        b.run("file::files_with_ext_path", [&] {
+            ankerl::nanobench::doNotOptimizeAway(file::files_with_ext_path(dir.path(), ".chunk"));
+        });
+        b.run("recursive_directory_iterator disk_used", [&] {
+            uint64_t sz = 0;
+            for (auto &e: std::filesystem::recursive_directory_iterator(dir.path())) {
+                std::error_code ec {};
+                if (e.is_regular_file())
+                    sz += e.file_size(ec);
+            }
+            ankerl::nanobench::doNotOptimizeAway(sz);
+        });
+        b.run("file::disk_used", [&] {
+            ankerl::nanobench::doNotOptimizeAway(file::disk_used(dir.path()));
+        });
+        b.run("file::walk count only", [&] {
+            std::atomic_size_t num_files = 0;
+            file::walk(dir.path(), [&](const auto files) {
+                num_files.fetch_add(files.size(), std::memory_order_relaxed);
+            });
+            ankerl::nanobench::doNotOptimizeAway(num_files.load());
+        });
+    };
+    "turbo::common::file handle_cache"_test = [] {
+        static constexpr size_t num_files = 1000;
+        static constexpr size_t num_lookups = 100'000;
+        const file::tmp_directory dir { "turbo-file-cache-bench" };
+        std::vector<std::string> paths {};
+        for (size_t i = 0; i < num_files; ++i)
+            file::write(paths.emplace_back(fmt::format("{}/chunk-{}.bin", dir.path(), i)), uint8_vector(4096));
+        ankerl::nanobench::Bench b {};
+        b.title("turbo::common::file random 64-byte lookups")
+            .output(&std::cerr)
+            .unit("lookup")
+            .relative(true)
+            .batch(num_lookups);
+        std::array<uint8_t, 64> buf;
+        b.run("read_stream per lookup", [&] {
+            for (size_t i = 0; i < num_lookups; ++i) {
+                file::read_stream rs { paths[(i * 7919) % num_files] };
+                rs.seek(static_cast<std::streamoff>((i * 64) % 4032));
+                rs.read(buf.data(), buf.size());
+            }
+        });
+        b.run("handle per lookup", [&] {
+            for (size_t i = 0; i < num_lookups; ++i)
+                file::handle { paths[(i * 7919) % num_files] }.pread(buf, (i * 64) % 4032);
+        });
+        file::handle_cache cache { num_files };
+        b.run("handle_cache", [&] {
+            for (size_t i = 0; i < num_lookups; ++i)
+                cache.open(paths[(i * 7919) % num_files])->pread(buf, (i * 64) % 4032);
+        });
+    };
+};
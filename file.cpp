@@ -1,11 +1,26 @@
 /* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
- * Copyright (c) 2024-2025 R2 Rationality OÜ (info at r2rationality dot com) */
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
 
-#ifndef _WIN32
-#    include <sys/resource.h>
+#ifdef _WIN32
+#   define NOMINMAX 1
+#   include <windows.h>
+#   include <fcntl.h>
+#   include <io.h>
+#else
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/mman.h>
+#   include <sys/resource.h>
+#   include <sys/stat.h>
+#   include <sys/uio.h>
 #endif
+#include <algorithm>
+#include <array>
+#include <cerrno>
 #include "file.hpp"
+#include "file-walk.hpp"
 #include "logger.hpp"
+#include "mutex.hpp"
 
 namespace turbo::file {
     void set_max_open_files()
@@ -76,6 +91,607 @@ namespace turbo::file {
         return pos;
     }
 
+#ifndef _WIN32
+    static constexpr size_t max_iov = 64;
+    using iov_array = std::array<iovec, max_iov>;
+
+    // fills iov from bufs skipping the first first_off bytes of bufs[0]; returns the number of used entries
+    template<typename B>
+    static size_t _fill_iov(iov_array &iov, const std::span<const B> bufs, const size_t first_off)
+    {
+        size_t num_iov = 0;
+        for (size_t i = 0; i < bufs.size() && num_iov < iov.size(); ++i) {
+            const auto off = i == 0 ? first_off : 0;
+            if (bufs[i].size() == off)
+                continue;
+            iov[num_iov++] = { const_cast<uint8_t *>(bufs[i].data()) + off, bufs[i].size() - off };
+        }
+        return num_iov;
+    }
+
+    // skips over the fully transferred buffers and remembers the position within the partially transferred one
+    template<typename B>
+    static void _advance_iov(std::span<const B> &bufs, size_t &first_off, size_t num_bytes)
+    {
+        while (!bufs.empty() && num_bytes >= bufs.front().size() - first_off) {
+            num_bytes -= bufs.front().size() - first_off;
+            first_off = 0;
+            bufs = bufs.subspan(1);
+        }
+        first_off += num_bytes;
+    }
+#endif
+
+    handle::handle(const std::string &path, const open_mode mode, const bool direct):
+        _path { path }
+    {
+        int flags = 0;
+        switch (mode) {
+            case open_mode::read: flags = O_RDONLY; break;
+            case open_mode::write: flags = O_WRONLY | O_CREAT; break;
+            case open_mode::read_write: flags = O_RDWR | O_CREAT; break;
+            default: throw error(fmt::format("unsupported open mode: {}", static_cast<int>(mode)));
+        }
+#       ifdef _WIN32
+            // _open has no way to request unbuffered I/O, so direct handles are regular ones on Windows
+            _fd = ::_open(_path.c_str(), flags | O_BINARY, _S_IREAD | _S_IWRITE);
+#       elif defined(O_DIRECT)
+            if (direct) {
+                _fd = ::open(_path.c_str(), flags | O_CLOEXEC | O_DIRECT, 0666);
+                // some file systems, such as tmpfs, reject O_DIRECT, so fall back to regular I/O
+                _direct = _fd >= 0;
+            }
+            if (_fd < 0)
+                _fd = ::open(_path.c_str(), flags | O_CLOEXEC, 0666);
+#       else
+            _fd = ::open(_path.c_str(), flags | O_CLOEXEC, 0666);
+#           ifdef F_NOCACHE
+                if (direct && _fd >= 0)
+                    _direct = ::fcntl(_fd, F_NOCACHE, 1) == 0;
+#           endif
+#       endif
+        if (_fd < 0) [[unlikely]]
+            throw error_sys(fmt::format("failed to open {}", _path));
+        _report_open_file();
+    }
+
+    handle::~handle()
+    {
+        logger::run_log_errors([&] {
+            close();
+        });
+    }
+
+    void handle::close()
+    {
+        if (_fd >= 0) {
+#           ifdef _WIN32
+                const auto res = ::_close(_fd);
+#           else
+                const auto res = ::close(_fd);
+#           endif
+            _fd = -1;
+            _open_files().fetch_sub(1, std::memory_order_relaxed);
+            if (res != 0) [[unlikely]]
+                throw error_sys(fmt::format("failed to close file {}!", _path));
+        }
+    }
+
+    uint64_t handle::size() const
+    {
+#       ifdef _WIN32
+            struct _stat64 st {};
+            if (::_fstat64(_fd, &st) != 0) [[unlikely]]
+#       else
+            struct stat st {};
+            if (::fstat(_fd, &st) != 0) [[unlikely]]
+#       endif
+                throw error_sys(fmt::format("failed to stat {}", _path));
+        return static_cast<uint64_t>(st.st_size);
+    }
+
+    size_t handle::pread(const write_buffer dst, const uint64_t offset) const
+    {
+        size_t done = 0;
+        while (done < dst.size()) {
+#           ifdef _WIN32
+                OVERLAPPED ov {};
+                const auto off = offset + done;
+                ov.Offset = static_cast<DWORD>(off);
+                ov.OffsetHigh = static_cast<DWORD>(off >> 32U);
+                DWORD num_read = 0;
+                const auto req = static_cast<DWORD>(std::min(dst.size() - done, size_t { 1U << 30U }));
+                if (!ReadFile(reinterpret_cast<HANDLE>(::_get_osfhandle(_fd)), dst.data() + done, req, &num_read, &ov)) [[unlikely]] {
+                    if (GetLastError() == ERROR_HANDLE_EOF)
+                        break;
+                    throw error(fmt::format("failed to read {} bytes at offset {} from {}: error {}", req, off, _path, GetLastError()));
+                }
+                const auto res = static_cast<int64_t>(num_read);
+#           else
+                const auto res = ::pread(_fd, dst.data() + done, dst.size() - done, static_cast<off_t>(offset + done));
+                if (res < 0) [[unlikely]] {
+                    if (errno == EINTR)
+                        continue;
+                    throw error_sys(fmt::format("failed to read {} bytes at offset {} from {}", dst.size() - done, offset + done, _path));
+                }
+#           endif
+            if (res == 0)
+                break;
+            done += static_cast<size_t>(res);
+            // an unaligned short read of a direct handle can only end at the end of the file
+            if (_direct && done % direct_alignment != 0)
+                break;
+        }
+        return done;
+    }
+
+    void handle::pwrite(const buffer src, const uint64_t offset) const
+    {
+        size_t done = 0;
+        while (done < src.size()) {
+#           ifdef _WIN32
+                OVERLAPPED ov {};
+                const auto off = offset + done;
+                ov.Offset = static_cast<DWORD>(off);
+                ov.OffsetHigh = static_cast<DWORD>(off >> 32U);
+                DWORD num_written = 0;
+                const auto req = static_cast<DWORD>(std::min(src.size() - done, size_t { 1U << 30U }));
+                if (!WriteFile(reinterpret_cast<HANDLE>(::_get_osfhandle(_fd)), src.data() + done, req, &num_written, &ov)) [[unlikely]]
+                    throw error(fmt::format("failed to write {} bytes at offset {} to {}: error {}", req, off, _path, GetLastError()));
+                const auto res = static_cast<int64_t>(num_written);
+#           else
+                const auto res = ::pwrite(_fd, src.data() + done, src.size() - done, static_cast<off_t>(offset + done));
+                if (res < 0) [[unlikely]] {
+                    if (errno == EINTR)
+                        continue;
+                    throw error_sys(fmt::format("failed to write {} bytes at offset {} to {}", src.size() - done, offset + done, _path));
+                }
+#           endif
+            done += static_cast<size_t>(res);
+        }
+    }
+
+    size_t handle::preadv(std::span<const write_buffer> dsts, const uint64_t offset) const
+    {
+        size_t done = 0;
+#       ifdef _WIN32
+            for (const auto &dst: dsts) {
+                const auto num_read = pread(dst, offset + done);
+                done += num_read;
+                if (num_read < dst.size())
+                    break;
+            }
+#       else
+            iov_array iov;
+            size_t dst_off = 0;
+            while (!dsts.empty()) {
+                const auto num_iov = _fill_iov(iov, dsts, dst_off);
+                if (num_iov == 0)
+                    break;
+                const auto res = ::preadv(_fd, iov.data(), static_cast<int>(num_iov), static_cast<off_t>(offset + done));
+                if (res < 0) [[unlikely]] {
+                    if (errno == EINTR)
+                        continue;
+                    throw error_sys(fmt::format("failed to read at offset {} from {}", offset + done, _path));
+                }
+                if (res == 0)
+                    break;
+                done += static_cast<size_t>(res);
+                if (_direct && done % direct_alignment != 0)
+                    break;
+                _advance_iov(dsts, dst_off, static_cast<size_t>(res));
+            }
+#       endif
+        return done;
+    }
+
+    void handle::pwritev(std::span<const buffer> srcs, const uint64_t offset) const
+    {
+#       ifdef _WIN32
+            auto off = offset;
+            for (const auto &src: srcs) {
+                pwrite(src, off);
+                off += src.size();
+            }
+#       else
+            iov_array iov;
+            size_t src_off = 0;
+            uint64_t done = 0;
+            while (!srcs.empty()) {
+                const auto num_iov = _fill_iov(iov, srcs, src_off);
+                if (num_iov == 0)
+                    break;
+                const auto res = ::pwritev(_fd, iov.data(), static_cast<int>(num_iov), static_cast<off_t>(offset + done));
+                if (res < 0) [[unlikely]] {
+                    if (errno == EINTR)
+                        continue;
+                    throw error_sys(fmt::format("failed to write at offset {} to {}", offset + done, _path));
+                }
+                done += static_cast<uint64_t>(res);
+                _advance_iov(srcs, src_off, static_cast<size_t>(res));
+            }
+#       endif
+    }
+
+    std::vector<size_t> handle::read_batch(const std::span<const read_range> ranges) const
+    {
+        std::vector<size_t> num_read(ranges.size());
+        std::array<write_buffer, 64> dsts;
+        for (size_t i = 0; i < ranges.size(); ) {
+            // adjacent ranges are coalesced into a single system call
+            size_t j = i;
+            for (auto end = ranges[i].offset; j < ranges.size() && j - i < dsts.size() && ranges[j].offset == end; ++j) {
+                dsts[j - i] = ranges[j].target;
+                end += ranges[j].target.size();
+            }
+            auto left = preadv(std::span { dsts.data(), j - i }, ranges[i].offset);
+            for (; i < j; ++i) {
+                num_read[i] = std::min(left, ranges[i].target.size());
+                left -= num_read[i];
+            }
+        }
+        return num_read;
+    }
+
+    static void _sync_dir(const std::string &dir)
+    {
+#       ifndef _WIN32
+            const auto fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (fd < 0) [[unlikely]]
+                throw error_sys(fmt::format("failed to open directory {} for syncing", dir));
+            const auto res = ::fsync(fd);
+            ::close(fd);
+            if (res != 0) [[unlikely]]
+                throw error_sys(fmt::format("failed to sync directory {}", dir));
+#       else
+            // NTFS journals directory updates itself and Windows has no way to sync a directory handle
+            (void)dir;
+#       endif
+    }
+
+    static std::string _parent_dir(const std::string &path)
+    {
+        return std::filesystem::path { path }.parent_path().string();
+    }
+
+    static void _sync_file(const int fd, const durability dur, const std::string &path)
+    {
+        if (dur == durability::none)
+            return;
+#       ifdef _WIN32
+            const auto res = ::_commit(fd);
+#       elif defined(__APPLE__)
+            // fsync on Mac OS does not flush the drive's cache
+            const auto res = ::fcntl(fd, F_FULLFSYNC);
+#       elif defined(__linux__)
+            const auto res = dur == durability::data ? ::fdatasync(fd) : ::fsync(fd);
+#       else
+            const auto res = ::fsync(fd);
+#       endif
+        if (res != 0) [[unlikely]]
+            throw error_sys(fmt::format("failed to sync {}", path));
+    }
+
+    static void _write_parts(const int fd, std::span<const buffer> parts, const std::string &path)
+    {
+#       ifdef _WIN32
+            for (const auto &p: parts) {
+                for (size_t done = 0; done < p.size(); ) {
+                    const auto req = static_cast<unsigned>(std::min(p.size() - done, size_t { 1U << 30U }));
+                    const auto res = ::_write(fd, p.data() + done, req);
+                    if (res < 0) [[unlikely]]
+                        throw error_sys(fmt::format("failed to write {} bytes to {}", req, path));
+                    done += static_cast<size_t>(res);
+                }
+            }
+#       else
+            iov_array iov;
+            size_t part_off = 0;
+            while (!parts.empty()) {
+                const auto num_iov = _fill_iov(iov, parts, part_off);
+                if (num_iov == 0)
+                    break;
+                const auto res = ::writev(fd, iov.data(), static_cast<int>(num_iov));
+                if (res < 0) [[unlikely]] {
+                    if (errno == EINTR)
+                        continue;
+                    throw error_sys(fmt::format("failed to write to {}", path));
+                }
+                _advance_iov(parts, part_off, static_cast<size_t>(res));
+            }
+#       endif
+    }
+
+    void write_stream::write(const std::span<const buffer> parts)
+    {
+        // the buffered data must reach the file before the data written directly to its descriptor
+        if (std::fflush(_f) != 0) [[unlikely]]
+            throw error_sys(fmt::format("failed to flush {}", _path));
+#       ifdef _WIN32
+            _write_parts(::_fileno(_f), parts, _path);
+#       else
+            _write_parts(::fileno(_f), parts, _path);
+#       endif
+    }
+
+    static int _open_for_writing(const std::string &path)
+    {
+#       ifdef _WIN32
+            const auto fd = ::_open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#       else
+            // the same as fopen, lets the umask decide the permissions
+            const auto fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+#       endif
+        if (fd < 0) [[unlikely]]
+            throw error_sys(fmt::format("failed to open a file for writing {}", path));
+        return fd;
+    }
+
+    static void _close_fd(const int fd, const std::string &path)
+    {
+#       ifdef _WIN32
+            if (::_close(fd) != 0) [[unlikely]]
+#       else
+            if (::close(fd) != 0) [[unlikely]]
+#       endif
+                throw error_sys(fmt::format("failed to close file {}!", path));
+    }
+
+    atomic_writer::~atomic_writer()
+    {
+        for (const auto &path: _staged) {
+            logger::run_log_errors([&] {
+                std::filesystem::remove(_make_tmp_path(path));
+            });
+        }
+    }
+
+    const std::string &atomic_writer::_make_tmp_path(const std::string &path)
+    {
+        // reuses the capacity of the previous path, so that writing many files does not allocate on each
+        _tmp_path.assign(path);
+        _tmp_path.append(".tmp");
+        return _tmp_path;
+    }
+
+    bool atomic_writer::_try_write_unnamed(const std::string &path, const std::span<const buffer> parts)
+    {
+#       if defined(__linux__) && defined(O_TMPFILE)
+            // an unnamed temporary file never leaves garbage behind if the process crashes midway
+            const auto dir = _parent_dir(path);
+            const auto fd = ::open(dir.empty() ? "." : dir.c_str(), O_TMPFILE | O_WRONLY | O_CLOEXEC, 0666);
+            if (fd < 0)
+                return false;
+            try {
+                _write_parts(fd, parts, path);
+                _sync_file(fd, _dur, path);
+                std::array<char, 32> fd_path;
+                const auto fd_path_end = fmt::format_to_n(fd_path.data(), fd_path.size() - 1, "/proc/self/fd/{}", fd).out;
+                *fd_path_end = '\0';
+                // Linking needs a mounted /proc and may be denied, e.g., in containers. The caller then falls back
+                // to a named temporary file, which reports the errors that are not specific to this path.
+                if (::linkat(AT_FDCWD, fd_path.data(), AT_FDCWD, path.c_str(), AT_SYMLINK_FOLLOW) != 0) {
+                    if (errno != EEXIST) {
+                        ::close(fd);
+                        return false;
+                    }
+                    // linkat does not replace existing files, so link under a temporary name and rename
+                    const auto &tmp_path = _make_tmp_path(path);
+                    ::unlink(tmp_path.c_str());
+                    if (::linkat(AT_FDCWD, fd_path.data(), AT_FDCWD, tmp_path.c_str(), AT_SYMLINK_FOLLOW) != 0) {
+                        ::close(fd);
+                        return false;
+                    }
+                    try {
+                        std::filesystem::rename(tmp_path, path);
+                    } catch (...) {
+                        ::unlink(tmp_path.c_str());
+                        throw;
+                    }
+                }
+            } catch (...) {
+                ::close(fd);
+                throw;
+            }
+            _close_fd(fd, path);
+            if (_dur == durability::full)
+                _sync_dir(dir);
+            return true;
+#       else
+            (void)path;
+            (void)parts;
+            return false;
+#       endif
+    }
+
+    void atomic_writer::write(const std::string &path, const std::span<const buffer> parts)
+    {
+        if (const auto dir_path = std::filesystem::path { path }.parent_path(); !dir_path.empty())
+            std::filesystem::create_directories(dir_path);
+        if (!_batch && _try_write_unnamed(path, parts))
+            return;
+        const auto &tmp_path = _make_tmp_path(path);
+        try {
+            const auto fd = _open_for_writing(tmp_path);
+            try {
+                _write_parts(fd, parts, tmp_path);
+#               ifndef __linux__
+                    // without syncfs, batched writes are synced one by one
+                    _sync_file(fd, _dur, tmp_path);
+#               else
+                    if (!_batch)
+                        _sync_file(fd, _dur, tmp_path);
+#               endif
+            } catch (...) {
+#               ifdef _WIN32
+                    ::_close(fd);
+#               else
+                    ::close(fd);
+#               endif
+                throw;
+            }
+            _close_fd(fd, tmp_path);
+            if (_batch) {
+                // the temporary file of a path staged earlier has just been truncated and rewritten, so the last write wins
+                _staged.emplace(path);
+                return;
+            }
+            std::filesystem::rename(tmp_path, path);
+        } catch (...) {
+            // a partially written temporary file must neither be left behind nor be published by a later commit
+            std::error_code ec {};
+            std::filesystem::remove(tmp_path, ec);
+            _staged.erase(path);
+            throw;
+        }
+        if (_dur == durability::full)
+            _sync_dir(_parent_dir(path));
+    }
+
+    void atomic_writer::commit()
+    {
+        if (_staged.empty())
+            return;
+        std::vector<std::string> dirs {};
+        dirs.reserve(_staged.size());
+        for (const auto &path: _staged)
+            dirs.emplace_back(_parent_dir(path));
+        std::sort(dirs.begin(), dirs.end());
+        dirs.erase(std::unique(dirs.begin(), dirs.end()), dirs.end());
+#       ifdef __linux__
+            // a single syncfs per directory replaces an fsync per file; directories on the same file system
+            // after the first one have little left to flush
+            if (_dur != durability::none) {
+                for (const auto &dir: dirs) {
+                    const auto fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                    if (fd < 0) [[unlikely]]
+                        throw error_sys(fmt::format("failed to open directory {} for syncing", dir));
+                    const auto res = ::syncfs(fd);
+                    ::close(fd);
+                    if (res != 0) [[unlikely]]
+                        throw error_sys(fmt::format("failed to sync the file system of {}", dir));
+                }
+            }
+#       endif
+        while (!_staged.empty()) {
+            const auto it = _staged.begin();
+            std::filesystem::rename(_make_tmp_path(*it), *it);
+            _staged.erase(it);
+        }
+        if (_dur == durability::full) {
+            for (const auto &dir: dirs)
+                _sync_dir(dir);
+        }
+    }
+
+    mmap_view::mmap_view(const std::string &path, const access_advice advice, const bool populate):
+        _path { path }
+    {
+#       ifdef _WIN32
+            HANDLE f = CreateFileA(_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (f == INVALID_HANDLE_VALUE) [[unlikely]]
+                throw error(fmt::format("failed to open a file for mapping {}: error {}", _path, GetLastError()));
+            LARGE_INTEGER sz {};
+            if (!GetFileSizeEx(f, &sz)) [[unlikely]] {
+                CloseHandle(f);
+                throw error(fmt::format("failed to get the size of {}: error {}", _path, GetLastError()));
+            }
+            _size = static_cast<size_t>(sz.QuadPart);
+            if (_size > 0) {
+                HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                CloseHandle(f);
+                if (m == nullptr) [[unlikely]]
+                    throw error(fmt::format("failed to create a file mapping for {}: error {}", _path, GetLastError()));
+                // the view keeps the mapping object alive
+                _data = static_cast<const uint8_t *>(MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(m);
+                if (_data == nullptr) [[unlikely]]
+                    throw error(fmt::format("failed to map {}: error {}", _path, GetLastError()));
+            } else {
+                CloseHandle(f);
+            }
+#       else
+            const int fd = ::open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) [[unlikely]]
+                throw error_sys(fmt::format("failed to open a file for mapping {}", _path));
+            struct stat st {};
+            if (::fstat(fd, &st) != 0) [[unlikely]] {
+                ::close(fd);
+                throw error_sys(fmt::format("failed to stat {}", _path));
+            }
+            _size = static_cast<size_t>(st.st_size);
+            // an empty mapping is not allowed, so empty files are represented with a null data pointer
+            if (_size > 0) {
+                int flags = MAP_PRIVATE;
+#               ifdef MAP_POPULATE
+                    if (populate)
+                        flags |= MAP_POPULATE;
+#               endif
+                void *ptr = ::mmap(nullptr, _size, PROT_READ, flags, fd, 0);
+                ::close(fd);
+                if (ptr == MAP_FAILED) [[unlikely]]
+                    throw error_sys(fmt::format("failed to map {}", _path));
+                _data = static_cast<const uint8_t *>(ptr);
+            } else {
+                ::close(fd);
+            }
+#       endif
+        if (advice != access_advice::normal)
+            advise(advice);
+#       ifndef MAP_POPULATE
+            if (populate)
+                advise(access_advice::willneed);
+#       endif
+    }
+
+    mmap_view::~mmap_view()
+    {
+        _unmap();
+    }
+
+    void mmap_view::_unmap() noexcept
+    {
+        if (_data) {
+#           ifdef _WIN32
+                UnmapViewOfFile(_data);
+#           else
+                ::munmap(const_cast<uint8_t *>(_data), _size);
+#           endif
+            _data = nullptr;
+            _size = 0;
+        }
+    }
+
+    void mmap_view::advise(const access_advice advice, const size_t offset, size_t size) const
+    {
+        if (offset > _size) [[unlikely]]
+            throw error(fmt::format("mmap_view {}: advice offset {} is beyond the end of the mapping {}", _path, offset, _size));
+        size = std::min(size, _size - offset);
+        if (size == 0)
+            return;
+#       ifdef _WIN32
+            // Windows has an equivalent only for the prefetch hint
+            if (advice == access_advice::willneed) {
+                WIN32_MEMORY_RANGE_ENTRY range { const_cast<uint8_t *>(_data + offset), size };
+                PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+            }
+#       else
+            static const size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            const auto aligned_offset = offset - offset % page_size;
+            int native_advice = MADV_NORMAL;
+            switch (advice) {
+                case access_advice::normal: native_advice = MADV_NORMAL; break;
+                case access_advice::sequential: native_advice = MADV_SEQUENTIAL; break;
+                case access_advice::random: native_advice = MADV_RANDOM; break;
+                case access_advice::willneed: native_advice = MADV_WILLNEED; break;
+                case access_advice::dontneed: native_advice = MADV_DONTNEED; break;
+                default: throw error(fmt::format("unsupported access advice: {}", static_cast<int>(advice)));
+            }
+            if (::madvise(const_cast<uint8_t *>(_data + aligned_offset), size + (offset - aligned_offset), native_advice) != 0) [[unlikely]]
+                throw error_sys(fmt::format("madvise failed for {}", _path));
+#       endif
+    }
+
     static std::filesystem::path &_install_dir()
     {
         static std::filesystem::path dir_path = std::filesystem::current_path();
@@ -170,10 +786,14 @@ namespace turbo::file {
     std::vector<std::filesystem::path> files_with_ext_path(const std::string_view &dir, const std::string_view &ext)
     {
         std::vector<std::filesystem::path> res {};
-        for (auto &entry: std::filesystem::recursive_directory_iterator(dir)) {
-            if (entry.is_regular_file() && entry.path().extension().string() == ext)
-                res.emplace_back(entry.path());
-        }
+        mutex::unique_lock::mutex_type res_mutex {};
+        walk(std::string { dir }, [&](const auto files) {
+            mutex::scoped_lock lk { res_mutex };
+            for (const auto &f: files) {
+                if (f.extension() == ext)
+                    res.emplace_back(f.path);
+            }
+        });
         std::sort(res.begin(), res.end());
         return res;
     }
@@ -186,4 +806,30 @@ namespace turbo::file {
         }
         return res;
     }
+
+    uint64_t disk_used(const std::string &path)
+    {
+        std::atomic_uint64_t total_size = 0;
+        walk(path, [&](const auto files) {
+            uint64_t dir_size = 0;
+            for (const auto &f: files)
+                dir_size += f.size;
+            total_size.fetch_add(dir_size, std::memory_order_relaxed);
+        }, walk_options { .sizes=true });
+        return total_size.load(std::memory_order_relaxed);
+    }
+
+    uint64_t dir_size_recursive(const std::string_view path, const std::optional<std::string> &ext)
+    {
+        std::atomic_uint64_t total_size = 0;
+        walk(std::string { path }, [&](const auto files) {
+            uint64_t dir_size = 0;
+            for (const auto &f: files) {
+                if (!ext || f.extension() == *ext)
+                    dir_size += f.size;
+            }
+            total_size.fetch_add(dir_size, std::memory_order_relaxed);
+        }, walk_options { .sizes=true });
+        return total_size.load(std::memory_order_relaxed);
+    }
 }
@@ -1,11 +1,13 @@
 #pragma once
 /* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
- * Copyright (c) 2024-2025 R2 Rationality OÜ (info at r2rationality dot com) */
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
 
 #include <cstdio>
 #include <atomic>
 #include <filesystem>
+#include <set>
 #include <string>
+#include <vector>
 #include "bytes.hpp"
 #include "format.hpp"
 
@@ -233,13 +235,161 @@ namespace turbo::file {
         {
             write(data.data(), data.size());
         }
+
+        // writes the parts with scatter-gather I/O, bypassing the stream's buffer after flushing it
+        void write(std::span<const buffer> parts);
     protected:
         FILE *_f = NULL;
         std::string _path {};
         uint8_vector _buf;
     };
 
-    inline void read(const std::string &path, uint8_vector &buffer)
+    enum class open_mode {
+        read,
+        write,
+        read_write
+    };
+
+    struct read_range {
+        uint64_t offset = 0;
+        write_buffer target {};
+    };
+
+    // An unbuffered file descriptor. Positional reads and writes do not share a file position,
+    // so one handle can be used by many threads at once.
+    // With direct=true, I/O bypasses the page cache when the platform and the file system support it,
+    // in which case offsets, sizes, and buffer addresses must be multiples of direct_alignment.
+    struct handle: protected stream {
+        static constexpr size_t direct_alignment = 4096;
+
+        explicit handle(const std::string &path, open_mode mode=open_mode::read, bool direct=false);
+        handle(const handle &) =delete;
+
+        handle(handle &&o) noexcept:
+            _path { std::move(o._path) }, _fd { std::exchange(o._fd, -1) }, _direct { std::exchange(o._direct, false) }
+        {
+        }
+
+        ~handle();
+
+        handle &operator=(const handle &) =delete;
+
+        handle &operator=(handle &&o)
+        {
+            if (this != &o) [[likely]] {
+                close();
+                _path = std::move(o._path);
+                _fd = std::exchange(o._fd, -1);
+                _direct = std::exchange(o._direct, false);
+            }
+            return *this;
+        }
+
+        void close();
+        [[nodiscard]] uint64_t size() const;
+        // reads until the buffer is full or the end of the file is reached; returns the number of bytes read
+        size_t pread(write_buffer dst, uint64_t offset) const;
+        void pwrite(buffer src, uint64_t offset) const;
+        // reads a contiguous range into several buffers; returns the number of bytes read
+        size_t preadv(std::span<const write_buffer> dsts, uint64_t offset) const;
+        void pwritev(std::span<const buffer> srcs, uint64_t offset) const;
+        // returns the number of bytes read into each range; adjacent ranges are read with a single preadv call
+        std::vector<size_t> read_batch(std::span<const read_range> ranges) const;
+
+        [[nodiscard]] int fd() const noexcept
+        {
+            return _fd;
+        }
+
+        [[nodiscard]] const std::string &path() const noexcept
+        {
+            return _path;
+        }
+
+        // true only when the page cache is actually bypassed
+        [[nodiscard]] bool direct() const noexcept
+        {
+            return _direct;
+        }
+    private:
+        std::string _path;
+        int _fd = -1;
+        bool _direct = false;
+    };
+
+    enum class access_advice {
+        normal,
+        sequential,
+        random,
+        willneed,
+        dontneed
+    };
+
+    // A read-only memory mapping of a whole file. The file must not be truncated while it is mapped.
+    struct mmap_view {
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        explicit mmap_view(const std::string &path, access_advice advice=access_advice::normal, bool populate=false);
+        mmap_view(const mmap_view &) =delete;
+
+        mmap_view(mmap_view &&o) noexcept:
+            _path { std::move(o._path) }, _data { std::exchange(o._data, nullptr) }, _size { std::exchange(o._size, 0) }
+        {
+        }
+
+        ~mmap_view();
+
+        mmap_view &operator=(const mmap_view &) =delete;
+
+        mmap_view &operator=(mmap_view &&o) noexcept
+        {
+            if (this != &o) [[likely]] {
+                _unmap();
+                _path = std::move(o._path);
+                _data = std::exchange(o._data, nullptr);
+                _size = std::exchange(o._size, 0);
+            }
+            return *this;
+        }
+
+        // the hint applies to the pages overlapping with [offset, offset + size)
+        void advise(access_advice advice, size_t offset=0, size_t size=npos) const;
+
+        [[nodiscard]] const uint8_t *data() const noexcept
+        {
+            return _data;
+        }
+
+        [[nodiscard]] size_t size() const noexcept
+        {
+            return _size;
+        }
+
+        [[nodiscard]] const std::string &path() const noexcept
+        {
+            return _path;
+        }
+
+        operator buffer() const noexcept
+        {
+            return { _data, _size };
+        }
+    private:
+        std::string _path;
+        const uint8_t *_data = nullptr;
+        size_t _size = 0;
+
+        void _unmap() noexcept;
+    };
+
+    // Reads the whole file into a resizable byte vector.
+    // A default_init_uint8_vector skips the zero-filling of the buffer before the read.
+    template<typename T>
+        requires requires(T &b) {
+            b.resize(size_t {});
+            { b.data() } -> std::same_as<uint8_t *>;
+        }
+    void read(const std::string &path, T &buffer)
     {
         const auto file_size = std::filesystem::file_size(path);
         buffer.resize(file_size);
@@ -263,9 +413,13 @@ namespace turbo::file {
 
     inline uint8_vector read_all(const std::span<const std::string> &paths)
     {
+        size_t total_size = 0;
+        for (const auto &p: paths)
+            total_size += std::filesystem::file_size(p);
         uint8_vector data {};
+        data.reserve(total_size);
         for (const auto &p: paths)
-            data << read(p);
+            data << mmap_view { p, access_advice::sequential };
         return data;
     }
 
@@ -279,55 +433,63 @@ namespace turbo::file {
         is.read(v.data(), v.size());
     }
 
-    inline void write(const std::string &path, const buffer &buffer)
-    {
-        const auto tmp_path = fmt::format("{}.tmp", path);
+    enum class durability {
+        // the new contents reach the disk whenever the operating system decides
+        none,
+        // the file's data is synced before it is published
+        data,
+        // the file is synced before it is published and its directory entry afterwards
+        full
+    };
+
+    // Replaces whole files so that readers and crashes observe either the old or the new contents.
+    // In batch mode, writes are only staged and become visible on commit(), which syncs them all at once,
+    // publishes them, and syncs each parent directory once. This amortizes the cost of the durability
+    // over thousands of small files. Staging the same path again replaces its staged contents,
+    // and a failed write of a path discards its staged contents, so commit() leaves the file unchanged.
+    // Staged writes that were not committed are discarded on destruction.
+    struct atomic_writer {
+        explicit atomic_writer(durability dur=durability::full, bool batch=false):
+            _dur { dur }, _batch { batch }
         {
-            write_stream os { tmp_path };
-            os.write(buffer.data(), buffer.size());
         }
-        std::filesystem::rename(tmp_path, path);
-    }
 
-    inline void write(const std::filesystem::path &p, const buffer &buffer)
-    {
-        const auto path = p.string();
-        const auto tmp_path = fmt::format("{}.tmp", path);
+        atomic_writer(const atomic_writer &) =delete;
+        ~atomic_writer();
+
+        atomic_writer &operator=(const atomic_writer &) =delete;
+
+        void write(const std::string &path, const buffer data)
         {
-            write_stream os { tmp_path };
-            os.write(buffer.data(), buffer.size());
+            write(path, std::span { &data, 1 });
         }
-        std::filesystem::rename(tmp_path, path);
-    }
 
-    inline uint64_t disk_used(const std::string &path)
-    {
-        uint64_t sz = 0;
-        for (auto &e: std::filesystem::recursive_directory_iterator(path)) {
-            if (e.is_regular_file()) {
-                // On Mac file size is not cached so it is possible that the file does not exist any more
-                // when its size is checked
-                std::error_code ec {};
-                auto e_sz = e.file_size(ec);
-                if (!ec)
-                    sz += e_sz;
-            }
+        // the parts are written with scatter-gather I/O, so there is no need to concatenate them first
+        void write(const std::string &path, std::span<const buffer> parts);
+        void commit();
+
+        [[nodiscard]] size_t pending() const noexcept
+        {
+            return _staged.size();
         }
-        return sz;
+    private:
+        const durability _dur;
+        const bool _batch;
+        std::string _tmp_path {};
+        std::set<std::string> _staged {};
+
+        const std::string &_make_tmp_path(const std::string &path);
+        bool _try_write_unnamed(const std::string &path, std::span<const buffer> parts);
+    };
+
+    inline void write(const std::string &path, const buffer &buffer, const durability dur=durability::none)
+    {
+        atomic_writer { dur }.write(path, buffer);
     }
 
-    inline uint64_t dir_size_recursive(const std::string_view path, const std::optional<std::string> &ext={})
+    inline void write(const std::filesystem::path &p, const buffer &buffer, const durability dur=durability::none)
     {
-        uint64_t total_size = 0;
-        for (const auto &entry : std::filesystem::recursive_directory_iterator(path)) {
-            if (ext && entry.path().extension() != *ext)
-                continue;
-            std::error_code ec {};
-            auto e_sz = entry.file_size(ec);
-            if (!ec)
-                total_size += e_sz;
-        }
-        return total_size;
+        atomic_writer { dur }.write(p.string(), buffer);
     }
 
     inline uint64_t dir_size(const std::string_view path, const std::optional<std::string> &ext={})
@@ -357,6 +519,9 @@ namespace turbo::file {
     extern void set_install_path_exact(const std::filesystem::path &p);
     extern std::string install_path(std::string_view rel_path);
     extern path_str_list files_with_ext(const std::string_view &dir, const std::string_view &ext);
+    // the total size of regular files in a directory tree, scanned in parallel
+    extern uint64_t disk_used(const std::string &path);
+    extern uint64_t dir_size_recursive(std::string_view path, const std::optional<std::string> &ext={});
     extern path_list files_with_ext_path(const std::string_view &dir, const std::string_view &ext);
 }
 
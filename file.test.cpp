@@ -1,6 +1,9 @@
 /* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
- * Copyright (c) 2024-2025 R2 Rationality OÜ (info at r2rationality dot com) */
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
 
+#ifndef _WIN32
+#   include <sys/stat.h>
+#endif
 #include <turbo/common/test.hpp>
 #include <turbo/common/scope-exit.hpp>
 #include "logger.hpp"
@@ -24,5 +27,196 @@ suite turbo_common_file_suite = [] {
             file::set_install_path("D:\\bin\\cli");
             expect_equal("D:\\log", file::install_path("log"));
         };
+        "mmap_view"_test = [] {
+            const file::tmp tmp_f { "turbo-file-mmap-view.bin" };
+            uint8_vector data {};
+            for (size_t i = 0; i < 100'000; ++i)
+                data << buffer::from(i);
+            file::write(tmp_f.path(), data);
+            file::mmap_view view { tmp_f.path(), file::access_advice::sequential, true };
+            expect_equal(data.size(), view.size());
+            expect(static_cast<buffer>(view) == static_cast<buffer>(data));
+            expect(nothrow([&] { view.advise(file::access_advice::random, 12345, 4096); }));
+            expect(nothrow([&] { view.advise(file::access_advice::willneed, view.size()); }));
+            expect(throws([&] { view.advise(file::access_advice::willneed, view.size() + 1); }));
+            file::mmap_view moved { std::move(view) };
+            expect_equal(data.size(), moved.size());
+            expect_equal(size_t { 0 }, view.size());
+            expect(throws([] { file::mmap_view { "/non-existent/turbo-file-mmap-view.bin" }; }));
+        };
+        "mmap_view empty"_test = [] {
+            const file::tmp tmp_f { "turbo-file-mmap-view-empty.bin" };
+            file::write(tmp_f.path(), uint8_vector {});
+            const file::mmap_view view { tmp_f.path() };
+            expect_equal(size_t { 0 }, view.size());
+            expect_equal(size_t { 0 }, static_cast<buffer>(view).size());
+        };
+        "read_all"_test = [] {
+            const file::tmp tmp_a { "turbo-file-read-all-a.bin" };
+            const file::tmp tmp_b { "turbo-file-read-all-b.bin" };
+            const file::tmp tmp_c { "turbo-file-read-all-c.bin" };
+            file::write(tmp_a.path(), buffer { std::string_view { "abc" } });
+            file::write(tmp_b.path(), uint8_vector {});
+            file::write(tmp_c.path(), buffer { std::string_view { "defg" } });
+            const std::vector<std::string> paths { tmp_a.path(), tmp_b.path(), tmp_c.path() };
+            expect_equal(std::string_view { "abcdefg" }, file::read_all(paths).str());
+        };
+        "atomic_writer"_test = [] {
+            const file::tmp_directory dir { "turbo-file-atomic-writer" };
+            for (const auto dur: { file::durability::none, file::durability::data, file::durability::full }) {
+                file::atomic_writer w { dur };
+                const auto path = fmt::format("{}/sub/file-{}.bin", dir.path(), static_cast<int>(dur));
+                w.write(path, buffer { std::string_view { "old" } });
+                expect_equal(std::string_view { "old" }, file::read(path).str());
+                // replaces the existing file
+                const std::array<buffer, 3> parts { buffer { std::string_view { "ab" } }, buffer {}, buffer { std::string_view { "cde" } } };
+                w.write(path, parts);
+                expect_equal(std::string_view { "abcde" }, file::read(path).str());
+                expect(!std::filesystem::exists(path + ".tmp"));
+            }
+        };
+#       ifndef _WIN32
+        "atomic_writer permissions"_test = [] {
+            // the same as fopen, the new files get 0666 masked by the umask
+            const file::tmp_directory dir { "turbo-file-atomic-writer-perms" };
+            const auto prev_mask = ::umask(002);
+            const scope_exit restore_mask { [&] { ::umask(prev_mask); } };
+            using std::filesystem::perms;
+            const auto expected = perms::owner_read | perms::owner_write | perms::group_read | perms::group_write | perms::others_read;
+            for (const auto batch: { false, true }) {
+                const auto path = fmt::format("{}/file-{}.bin", dir.path(), batch);
+                file::atomic_writer w { file::durability::none, batch };
+                w.write(path, buffer { std::string_view { "data" } });
+                w.commit();
+                expect(std::filesystem::status(path).permissions() == expected) << path;
+            }
+            const auto path = fmt::format("{}/write.bin", dir.path());
+            file::write(path, buffer { std::string_view { "data" } });
+            expect(std::filesystem::status(path).permissions() == expected);
+        };
+#       endif
+        "atomic_writer many parts"_test = [] {
+            const file::tmp tmp_f { "turbo-file-atomic-writer-parts.bin" };
+            uint8_vector expected {};
+            std::vector<uint8_vector> chunks {};
+            for (size_t i = 0; i < 200; ++i) {
+                auto &c = chunks.emplace_back(i % 7 == 0 ? 0 : i * 13);
+                for (size_t j = 0; j < c.size(); ++j)
+                    c[j] = static_cast<uint8_t>(i + j);
+                expected << c;
+            }
+            const std::vector<buffer> parts { chunks.begin(), chunks.end() };
+            file::atomic_writer {}.write(tmp_f.path(), parts);
+            expect(file::read(tmp_f.path()) == expected);
+        };
+        "atomic_writer batch"_test = [] {
+            const file::tmp_directory dir { "turbo-file-atomic-writer-batch" };
+            const auto path_a = fmt::format("{}/a.bin", dir.path());
+            const auto path_b = fmt::format("{}/b/b.bin", dir.path());
+            {
+                file::atomic_writer w { file::durability::full, true };
+                w.write(path_a, buffer { std::string_view { "a" } });
+                w.write(path_b, buffer { std::string_view { "b" } });
+                expect_equal(size_t { 2 }, w.pending());
+                expect(!std::filesystem::exists(path_a));
+                w.commit();
+                expect_equal(size_t { 0 }, w.pending());
+                expect_equal(std::string_view { "a" }, file::read(path_a).str());
+                expect_equal(std::string_view { "b" }, file::read(path_b).str());
+            }
+            {
+                file::atomic_writer w { file::durability::data, true };
+                w.write(path_a, buffer { std::string_view { "discarded" } });
+            }
+            expect_equal(std::string_view { "a" }, file::read(path_a).str());
+            expect(!std::filesystem::exists(path_a + ".tmp"));
+            {
+                // the last staged write of a path wins
+                file::atomic_writer w { file::durability::data, true };
+                w.write(path_a, buffer { std::string_view { "first" } });
+                w.write(path_b, buffer { std::string_view { "b2" } });
+                w.write(path_a, buffer { std::string_view { "last" } });
+                expect_equal(size_t { 2 }, w.pending());
+                w.commit();
+                expect_equal(size_t { 0 }, w.pending());
+            }
+            expect_equal(std::string_view { "last" }, file::read(path_a).str());
+            expect_equal(std::string_view { "b2" }, file::read(path_b).str());
+            expect(!std::filesystem::exists(path_a + ".tmp"));
+        };
+        "atomic_writer failures"_test = [] {
+            const file::tmp_directory dir { "turbo-file-atomic-writer-failures" };
+            const auto path = fmt::format("{}/a.bin", dir.path());
+#           ifndef _WIN32
+            {
+                // the kernel writes the valid part and then fails on the unmapped one
+                const uint8_vector valid(10, 0xAA);
+                const std::array<buffer, 2> failing { buffer { valid }, buffer { reinterpret_cast<const uint8_t *>(uintptr_t { 16 }), 100 } };
+                file::atomic_writer w { file::durability::none, true };
+                w.write(path, uint8_vector(100, 0xBB));
+                expect(throws([&] { w.write(path, failing); }));
+                expect_equal(size_t { 0 }, w.pending());
+                expect(!std::filesystem::exists(path + ".tmp"));
+                w.commit();
+                expect(!std::filesystem::exists(path));
+            }
+#           endif
+            // a non-empty directory cannot be replaced by a file
+            std::filesystem::create_directories(path + "/sub");
+            expect(throws([&] { file::atomic_writer {}.write(path, buffer { std::string_view { "data" } }); }));
+            expect(!std::filesystem::exists(path + ".tmp"));
+            expect(std::filesystem::is_directory(path));
+        };
+        "handle positional io"_test = [] {
+            const file::tmp tmp_f { "turbo-file-handle-positional.bin" };
+            {
+                const file::handle f { tmp_f.path(), file::open_mode::write };
+                f.pwrite(buffer { std::string_view { "0123" } }, 0);
+                const std::array<buffer, 3> parts { buffer { std::string_view { "456" } }, buffer {}, buffer { std::string_view { "789abc" } } };
+                f.pwritev(parts, 4);
+                f.pwrite(buffer { std::string_view { "XY" } }, 2);
+                expect_equal(uint64_t { 13 }, f.size());
+            }
+            const file::handle f { tmp_f.path() };
+            uint8_vector a(3), b(5);
+            const std::array<write_buffer, 2> dsts { a, b };
+            expect_equal(size_t { 8 }, f.preadv(dsts, 1));
+            expect_equal(std::string_view { "1XY" }, a.str());
+            expect_equal(std::string_view { "45678" }, b.str());
+            // reads past the end of the file are short
+            expect_equal(size_t { 4 }, f.preadv(dsts, 9));
+            uint8_vector c(2), d(2), e(2), g(2);
+            const std::array<file::read_range, 4> ranges {
+                file::read_range { 0, c }, file::read_range { 2, d }, file::read_range { 10, e }, file::read_range { 12, g }
+            };
+            const auto num_read = f.read_batch(ranges);
+            expect(num_read == std::vector<size_t> { 2, 2, 2, 1 });
+            expect_equal(std::string_view { "01XY" }, fmt::format("{}{}", c.str(), d.str()));
+            expect_equal(std::string_view { "ab" }, e.str());
+            expect_equal(uint8_t { 'c' }, g[0]);
+        };
+        "handle concurrent reads"_test = [] {
+            const file::tmp tmp_f { "turbo-file-handle-concurrent.bin" };
+            uint8_vector data(1 << 20);
+            for (size_t i = 0; i < data.size(); ++i)
+                data[i] = static_cast<uint8_t>(i * 13);
+            file::write(tmp_f.path(), data);
+            const file::handle f { tmp_f.path() };
+            std::atomic_size_t mismatches = 0;
+            std::vector<std::thread> threads {};
+            for (size_t t = 0; t < 4; ++t) {
+                threads.emplace_back([&, t] {
+                    uint8_vector buf(4096);
+                    for (size_t off = t * buf.size(); off < data.size(); off += 4 * buf.size()) {
+                        f.pread(buf, off);
+                        if (static_cast<buffer>(buf) != static_cast<buffer>(data).subbuf(off, buf.size()))
+                            mismatches.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+            }
+            for (auto &t: threads)
+                t.join();
+            expect_equal(size_t { 0 }, mismatches.load());
+        };
     };
-};
\ No newline at end of file
+};
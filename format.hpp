@@ -1,6 +1,6 @@
 #pragma once
 /* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
- * Copyright (c) 2024-2025 R2 Rationality OÜ (info at r2rationality dot com) */
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
 
 #include <chrono>
 #include <list>
@@ -30,6 +30,7 @@
 #endif
 
 #include "error.hpp"
+#include "hex.hpp"
 #include "serializable.hpp"
 
 namespace turbo {
@@ -61,11 +62,7 @@ namespace fmt {
     struct formatter<std::span<const uint8_t>>: formatter<int> {
         template<typename FormatContext>
         auto format(const std::span<const uint8_t> &data, FormatContext &ctx) const -> decltype(ctx.out()) {
-            auto out_it = ctx.out();
-            for (uint8_t v: data) {
-                out_it = fmt::format_to(out_it, "{:02X}", v);
-            }
-            return out_it;
+            return turbo::hex::encode_to(ctx.out(), data, true);
         }
     };
 
@@ -0,0 +1,104 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#ifdef _MSC_VER
+#   include <intrin.h>
+#endif
+
+namespace turbo::hash {
+    // A non-cryptographic hash following the construction of wyhash (final version 4). It is fast for both short keys,
+    // such as hashes and addresses, and long inputs, and is defined inline so that calls with a compile-time size
+    // are specialised by the compiler. Not suitable for data controlled by an adversary that knows the seed.
+    namespace wyhash {
+        static constexpr uint64_t secret[4] { 0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL };
+
+        inline void _mum(uint64_t &a, uint64_t &b) noexcept
+        {
+#ifdef _MSC_VER
+            a = _umul128(a, b, &b);
+#else
+            const auto r = static_cast<unsigned __int128>(a) * b;
+            a = static_cast<uint64_t>(r);
+            b = static_cast<uint64_t>(r >> 64U);
+#endif
+        }
+
+        inline uint64_t _mix(uint64_t a, uint64_t b) noexcept
+        {
+            _mum(a, b);
+            return a ^ b;
+        }
+
+        // the reads are little-endian, so that the hashes are the same on all platforms
+        inline uint64_t _read8(const uint8_t *p) noexcept
+        {
+            uint64_t v;
+            memcpy(&v, p, sizeof(v));
+            if constexpr (std::endian::native == std::endian::big)
+                v = std::byteswap(v);
+            return v;
+        }
+
+        inline uint64_t _read4(const uint8_t *p) noexcept
+        {
+            uint32_t v;
+            memcpy(&v, p, sizeof(v));
+            if constexpr (std::endian::native == std::endian::big)
+                v = std::byteswap(v);
+            return v;
+        }
+
+        inline uint64_t _read3(const uint8_t *p, const size_t k) noexcept
+        {
+            return (static_cast<uint64_t>(p[0]) << 16U) | (static_cast<uint64_t>(p[k >> 1U]) << 8U) | p[k - 1];
+        }
+    }
+
+    [[nodiscard]] inline uint64_t bytes(const void *data, const size_t size, uint64_t seed=0) noexcept
+    {
+        using namespace wyhash;
+        const auto *p = static_cast<const uint8_t *>(data);
+        seed ^= _mix(seed ^ secret[0], secret[1]);
+        uint64_t a, b;
+        if (size <= 16) [[likely]] {
+            if (size >= 4) [[likely]] {
+                const auto off = (size >> 3U) << 2U;
+                a = (_read4(p) << 32U) | _read4(p + off);
+                b = (_read4(p + size - 4) << 32U) | _read4(p + size - 4 - off);
+            } else if (size > 0) [[likely]] {
+                a = _read3(p, size);
+                b = 0;
+            } else {
+                a = b = 0;
+            }
+        } else {
+            size_t i = size;
+            if (i > 48) [[unlikely]] {
+                auto see1 = seed, see2 = seed;
+                do {
+                    seed = _mix(_read8(p) ^ secret[1], _read8(p + 8) ^ seed);
+                    see1 = _mix(_read8(p + 16) ^ secret[2], _read8(p + 24) ^ see1);
+                    see2 = _mix(_read8(p + 32) ^ secret[3], _read8(p + 40) ^ see2);
+                    p += 48;
+                    i -= 48;
+                } while (i > 48);
+                seed ^= see1 ^ see2;
+            }
+            while (i > 16) [[unlikely]] {
+                seed = _mix(_read8(p) ^ secret[1], _read8(p + 8) ^ seed);
+                i -= 16;
+                p += 16;
+            }
+            a = _read8(p + i - 16);
+            b = _read8(p + i - 8);
+        }
+        a ^= secret[1];
+        b ^= seed;
+        _mum(a, b);
+        return _mix(a ^ secret[0] ^ size, b ^ secret[1]);
+    }
+}
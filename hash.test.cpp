@@ -0,0 +1,57 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <set>
+#include <turbo/common/test.hpp>
+#include "hash.hpp"
+
+namespace {
+    using namespace turbo;
+}
+
+suite turbo_common_hash_suite = [] {
+    "turbo::common::hash"_test = [] {
+        uint8_vector data(300);
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<uint8_t>(i * 37 + 11);
+        "deterministic"_test = [&] {
+            const uint8_vector copy { data };
+            expect_equal(hash::bytes(data.data(), data.size()), hash::bytes(copy.data(), copy.size()));
+            expect(hash::bytes(data.data(), data.size(), 1) != hash::bytes(data.data(), data.size(), 2));
+        };
+        "prefixes"_test = [&] {
+            // the lengths cover all branches of the short and the long inputs
+            std::set<uint64_t> seen {};
+            for (size_t sz = 0; sz <= data.size(); ++sz)
+                seen.emplace(hash::bytes(data.data(), sz));
+            expect_equal(data.size() + 1, seen.size());
+        };
+        "bit flips"_test = [&] {
+            for (const size_t sz: { 1, 3, 4, 7, 8, 16, 17, 28, 32, 48, 49, 64, 97, 300 }) {
+                const auto base = hash::bytes(data.data(), sz);
+                std::set<uint64_t> seen { base };
+                for (size_t bit = 0; bit < sz * 8; ++bit) {
+                    auto flipped = data;
+                    flipped[bit / 8] ^= static_cast<uint8_t>(1U << (bit % 8));
+                    seen.emplace(hash::bytes(flipped.data(), sz));
+                }
+                expect_equal(sz * 8 + 1, seen.size(), fmt::format("size {}", sz));
+            }
+        };
+        "avalanche"_test = [&] {
+            // a single flipped input bit changes about half of the output bits
+            size_t changed = 0, total = 0;
+            for (const size_t sz: { 8, 32, 100 }) {
+                const auto base = hash::bytes(data.data(), sz);
+                for (size_t bit = 0; bit < sz * 8; ++bit) {
+                    auto flipped = data;
+                    flipped[bit / 8] ^= static_cast<uint8_t>(1U << (bit % 8));
+                    changed += static_cast<size_t>(std::popcount(base ^ hash::bytes(flipped.data(), sz)));
+                    total += 64;
+                }
+            }
+            const auto ratio = static_cast<double>(changed) / static_cast<double>(total);
+            expect(ratio > 0.45 && ratio < 0.55) << ratio;
+        };
+    };
+};
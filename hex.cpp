@@ -0,0 +1,245 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <array>
+#include "hex.hpp"
+
+#ifdef TURBO_SIMD_X86
+#   include <immintrin.h>
+#endif
+
+namespace turbo::hex {
+    namespace {
+        static constexpr std::string_view upper_digits { "0123456789ABCDEF" };
+        static constexpr std::string_view lower_digits { "0123456789abcdef" };
+
+        // 0xFF marks the characters that are not hex digits
+        static constexpr auto decode_map = [] {
+            std::array<uint8_t, 256> map {};
+            map.fill(0xFF);
+            for (uint8_t i = 0; i < 16; ++i) {
+                map[static_cast<uint8_t>(upper_digits[i])] = i;
+                map[static_cast<uint8_t>(lower_digits[i])] = i;
+            }
+            return map;
+        }();
+
+        void encode_scalar(char *out, const uint8_t *data, const size_t size, const bool uppercase) noexcept
+        {
+            const auto *digits = uppercase ? upper_digits.data() : lower_digits.data();
+            for (size_t i = 0; i < size; ++i) {
+                out[i * 2] = digits[data[i] >> 4U];
+                out[i * 2 + 1] = digits[data[i] & 0xFU];
+            }
+        }
+
+        bool decode_scalar(uint8_t *out, const char *hex, const size_t size) noexcept
+        {
+            // the invalid characters are detected once for the whole input instead of per character
+            uint8_t invalid = 0;
+            for (size_t i = 0; i < size; ++i) {
+                const auto hi = decode_map[static_cast<uint8_t>(hex[i * 2])];
+                const auto lo = decode_map[static_cast<uint8_t>(hex[i * 2 + 1])];
+                invalid |= hi | lo;
+                out[i] = static_cast<uint8_t>(hi << 4U) | lo;
+            }
+            return !(invalid & 0xF0U);
+        }
+
+#ifdef TURBO_SIMD_X86
+        // The 16-byte steps are always inlined, so that the wider kernels can process their tails with them
+        // in VEX encoding. Calling a function in legacy SSE encoding after AVX code stalls on the state transition.
+        __attribute__((target("sse4.1"), always_inline))
+        inline void encode16_sse41(char *out, const uint8_t *data, const __m128i lut) noexcept
+        {
+            const auto mask = _mm_set1_epi8(0x0F);
+            const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+            const auto hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(x, 4), mask));
+            const auto lo = _mm_shuffle_epi8(lut, _mm_and_si128(x, mask));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_unpacklo_epi8(hi, lo));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16), _mm_unpackhi_epi8(hi, lo));
+        }
+
+        __attribute__((target("sse4.1")))
+        void encode_sse41(char *out, const uint8_t *data, const size_t size, const bool uppercase) noexcept
+        {
+            const auto lut = _mm_loadu_si128(reinterpret_cast<const __m128i *>(uppercase ? upper_digits.data() : lower_digits.data()));
+            size_t i = 0;
+            for (; i + 16 <= size; i += 16)
+                encode16_sse41(out + i * 2, data + i, lut);
+            encode_scalar(out + i * 2, data + i, size - i, uppercase);
+        }
+
+        // converts 16 characters into their values and marks the invalid ones in the invalid mask
+        __attribute__((target("sse4.1"), always_inline))
+        inline __m128i decode_chars_sse41(const __m128i c, __m128i &invalid) noexcept
+        {
+            const auto d = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+            const auto l = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+            const auto digit = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+            const auto letter = _mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8(5)), l);
+            invalid = _mm_or_si128(invalid, _mm_andnot_si128(_mm_or_si128(digit, letter), _mm_set1_epi8(-1)));
+            return _mm_blendv_epi8(_mm_add_epi8(l, _mm_set1_epi8(10)), d, digit);
+        }
+
+        __attribute__((target("sse4.1"), always_inline))
+        inline void decode16_sse41(uint8_t *out, const char *hex, __m128i &invalid) noexcept
+        {
+            // multiplies the even characters by 16 and adds the odd ones
+            const auto weights = _mm_set1_epi16(0x0110);
+            const auto v0 = decode_chars_sse41(_mm_loadu_si128(reinterpret_cast<const __m128i *>(hex)), invalid);
+            const auto v1 = decode_chars_sse41(_mm_loadu_si128(reinterpret_cast<const __m128i *>(hex + 16)), invalid);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(_mm_maddubs_epi16(v0, weights), _mm_maddubs_epi16(v1, weights)));
+        }
+
+        __attribute__((target("sse4.1")))
+        bool decode_sse41(uint8_t *out, const char *hex, const size_t size) noexcept
+        {
+            auto invalid = _mm_setzero_si128();
+            size_t i = 0;
+            for (; i + 16 <= size; i += 16)
+                decode16_sse41(out + i, hex + i * 2, invalid);
+            return _mm_testz_si128(invalid, invalid) & decode_scalar(out + i, hex + i * 2, size - i);
+        }
+
+        __attribute__((target("avx2")))
+        void encode_avx2(char *out, const uint8_t *data, const size_t size, const bool uppercase) noexcept
+        {
+            const auto lut128 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(uppercase ? upper_digits.data() : lower_digits.data()));
+            const auto lut = _mm256_broadcastsi128_si256(lut128);
+            const auto mask = _mm256_set1_epi8(0x0F);
+            size_t i = 0;
+            for (; i + 32 <= size; i += 32) {
+                const auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+                const auto hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(x, 4), mask));
+                const auto lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(x, mask));
+                // the unpacks work within 128-bit lanes, so the halves need to be put back in order
+                const auto a = _mm256_unpacklo_epi8(hi, lo);
+                const auto b = _mm256_unpackhi_epi8(hi, lo);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i * 2), _mm256_permute2x128_si256(a, b, 0x20));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i * 2 + 32), _mm256_permute2x128_si256(a, b, 0x31));
+            }
+            if (i + 16 <= size) {
+                encode16_sse41(out + i * 2, data + i, lut128);
+                i += 16;
+            }
+            encode_scalar(out + i * 2, data + i, size - i, uppercase);
+        }
+
+        __attribute__((target("avx2")))
+        __m256i decode_chars_avx2(const __m256i c, __m256i &invalid) noexcept
+        {
+            const auto d = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+            const auto l = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+            const auto digit = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+            const auto letter = _mm256_cmpeq_epi8(_mm256_min_epu8(l, _mm256_set1_epi8(5)), l);
+            invalid = _mm256_or_si256(invalid, _mm256_andnot_si256(_mm256_or_si256(digit, letter), _mm256_set1_epi8(-1)));
+            return _mm256_blendv_epi8(_mm256_add_epi8(l, _mm256_set1_epi8(10)), d, digit);
+        }
+
+        __attribute__((target("avx2")))
+        bool decode_avx2(uint8_t *out, const char *hex, const size_t size) noexcept
+        {
+            const auto weights = _mm256_set1_epi16(0x0110);
+            auto invalid = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 32 <= size; i += 32) {
+                const auto v0 = decode_chars_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(hex + i * 2)), invalid);
+                const auto v1 = decode_chars_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(hex + i * 2 + 32)), invalid);
+                const auto packed = _mm256_packus_epi16(_mm256_maddubs_epi16(v0, weights), _mm256_maddubs_epi16(v1, weights));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_permute4x64_epi64(packed, 0xD8));
+            }
+            auto invalid128 = _mm_setzero_si128();
+            if (i + 16 <= size) {
+                decode16_sse41(out + i, hex + i * 2, invalid128);
+                i += 16;
+            }
+            return _mm256_testz_si256(invalid, invalid) & _mm_testz_si128(invalid128, invalid128) & decode_scalar(out + i, hex + i * 2, size - i);
+        }
+
+        __attribute__((target("avx512f,avx512bw")))
+        void encode_avx512(char *out, const uint8_t *data, const size_t size, const bool uppercase) noexcept
+        {
+            // the digits repeated in every 128-bit lane since the shuffles work within lanes
+            static constexpr std::string_view upper_lut { "0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF" };
+            static constexpr std::string_view lower_lut { "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef" };
+            const auto lut = _mm512_loadu_si512(uppercase ? upper_lut.data() : lower_lut.data());
+            const auto mask = _mm512_set1_epi8(0x0F);
+            const auto idx_first = _mm512_set_epi64(11, 10, 3, 2, 9, 8, 1, 0);
+            const auto idx_second = _mm512_set_epi64(15, 14, 7, 6, 13, 12, 5, 4);
+            size_t i = 0;
+            for (; i + 64 <= size; i += 64) {
+                const auto x = _mm512_loadu_si512(data + i);
+                const auto hi = _mm512_shuffle_epi8(lut, _mm512_and_si512(_mm512_srli_epi16(x, 4), mask));
+                const auto lo = _mm512_shuffle_epi8(lut, _mm512_and_si512(x, mask));
+                const auto a = _mm512_unpacklo_epi8(hi, lo);
+                const auto b = _mm512_unpackhi_epi8(hi, lo);
+                _mm512_storeu_si512(out + i * 2, _mm512_permutex2var_epi64(a, idx_first, b));
+                _mm512_storeu_si512(out + i * 2 + 64, _mm512_permutex2var_epi64(a, idx_second, b));
+            }
+            encode_avx2(out + i * 2, data + i, size - i, uppercase);
+        }
+
+        __attribute__((target("avx512f,avx512bw")))
+        __m512i decode_chars_avx512(const __m512i c, __mmask64 &valid) noexcept
+        {
+            const auto d = _mm512_sub_epi8(c, _mm512_set1_epi8('0'));
+            const auto l = _mm512_sub_epi8(_mm512_or_si512(c, _mm512_set1_epi8(0x20)), _mm512_set1_epi8('a'));
+            const auto digit = _mm512_cmple_epu8_mask(d, _mm512_set1_epi8(9));
+            const auto letter = _mm512_cmple_epu8_mask(l, _mm512_set1_epi8(5));
+            valid &= digit | letter;
+            return _mm512_mask_blend_epi8(digit, _mm512_add_epi8(l, _mm512_set1_epi8(10)), d);
+        }
+
+        __attribute__((target("avx512f,avx512bw")))
+        bool decode_avx512(uint8_t *out, const char *hex, const size_t size) noexcept
+        {
+            const auto weights = _mm512_set1_epi16(0x0110);
+            const auto idx = _mm512_set_epi64(7, 5, 3, 1, 6, 4, 2, 0);
+            __mmask64 valid = ~__mmask64 { 0 };
+            size_t i = 0;
+            for (; i + 64 <= size; i += 64) {
+                const auto v0 = decode_chars_avx512(_mm512_loadu_si512(hex + i * 2), valid);
+                const auto v1 = decode_chars_avx512(_mm512_loadu_si512(hex + i * 2 + 64), valid);
+                const auto packed = _mm512_packus_epi16(_mm512_maddubs_epi16(v0, weights), _mm512_maddubs_epi16(v1, weights));
+                _mm512_storeu_si512(out + i, _mm512_permutex2var_epi64(packed, idx, packed));
+            }
+            return (valid == ~__mmask64 { 0 }) & decode_avx2(out + i, hex + i * 2, size - i);
+        }
+#endif
+    }
+
+    void encode(const std::span<char> out, const std::span<const uint8_t> data, const bool uppercase, const isa i) noexcept
+    {
+        switch (i) {
+#ifdef TURBO_SIMD_X86
+            case isa::avx512: encode_avx512(out.data(), data.data(), data.size(), uppercase); break;
+            case isa::avx2: encode_avx2(out.data(), data.data(), data.size(), uppercase); break;
+            case isa::sse41: encode_sse41(out.data(), data.data(), data.size(), uppercase); break;
+#endif
+            default: encode_scalar(out.data(), data.data(), data.size(), uppercase); break;
+        }
+    }
+
+    void encode(const std::span<char> out, const std::span<const uint8_t> data, const bool uppercase) noexcept
+    {
+        encode(out, data, uppercase, simd::best_isa());
+    }
+
+    bool decode(const std::span<uint8_t> out, const std::string_view hex, const isa i) noexcept
+    {
+        switch (i) {
+#ifdef TURBO_SIMD_X86
+            case isa::avx512: return decode_avx512(out.data(), hex.data(), out.size());
+            case isa::avx2: return decode_avx2(out.data(), hex.data(), out.size());
+            case isa::sse41: return decode_sse41(out.data(), hex.data(), out.size());
+#endif
+            default: return decode_scalar(out.data(), hex.data(), out.size());
+        }
+    }
+
+    bool decode(const std::span<uint8_t> out, const std::string_view hex) noexcept
+    {
+        return decode(out, hex, simd::best_isa());
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include "simd.hpp"
+
+namespace turbo::hex {
+    using simd::isa;
+
+    // out must have exactly twice as many characters as there are bytes in data
+    extern void encode(std::span<char> out, std::span<const uint8_t> data, bool uppercase=true) noexcept;
+    extern void encode(std::span<char> out, std::span<const uint8_t> data, bool uppercase, isa i) noexcept;
+
+    // encodes through a stack buffer, so that formatters can write large inputs without allocating
+    template<typename OutputIt>
+    OutputIt encode_to(OutputIt out_it, const std::span<const uint8_t> data, const bool uppercase=true)
+    {
+        std::array<char, 0x400> buf;
+        for (size_t off = 0; off < data.size(); ) {
+            const auto num_bytes = std::min(buf.size() / 2, data.size() - off);
+            encode(std::span { buf.data(), num_bytes * 2 }, data.subspan(off, num_bytes), uppercase);
+            out_it = std::copy_n(buf.data(), num_bytes * 2, out_it);
+            off += num_bytes;
+        }
+        return out_it;
+    }
+
+    // Accepts both upper- and lowercase digits. Returns false if the input has a non-hex character,
+    // in which case the contents of out are unspecified. hex must have exactly twice as many characters as out has bytes.
+    [[nodiscard]] extern bool decode(std::span<uint8_t> out, std::string_view hex) noexcept;
+    [[nodiscard]] extern bool decode(std::span<uint8_t> out, std::string_view hex, isa i) noexcept;
+}
@@ -0,0 +1,87 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <turbo/common/test.hpp>
+#include "hex.hpp"
+
+namespace {
+    using namespace turbo;
+
+    std::string reference_hex(const buffer data, const bool uppercase)
+    {
+        std::string res {};
+        for (const auto b: data)
+            res += fmt::format(fmt::runtime(uppercase ? "{:02X}" : "{:02x}"), b);
+        return res;
+    }
+}
+
+suite turbo_common_hex_suite = [] {
+    "turbo::common::hex"_test = [] {
+        uint8_vector data(1000);
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<uint8_t>(i * 37 + (i >> 8));
+        const auto isas = { hex::isa::scalar, hex::isa::sse41, hex::isa::avx2, hex::isa::avx512 };
+        "encode"_test = [&] {
+            for (const auto i: isas) {
+                if (!simd::supported(i))
+                    continue;
+                for (const auto uppercase: { true, false }) {
+                    // sizes around the block boundaries of every kernel
+                    for (size_t sz = 0; sz <= 300; ++sz) {
+                        const auto in = static_cast<buffer>(data).subbuf(sz, sz);
+                        std::string out(sz * 2, '?');
+                        hex::encode(out, in, uppercase, i);
+                        expect_equal(reference_hex(in, uppercase), out, fmt::format("isa {} size {}", static_cast<int>(i), sz));
+                    }
+                }
+            }
+        };
+        "decode"_test = [&] {
+            for (const auto i: isas) {
+                if (!simd::supported(i))
+                    continue;
+                for (const auto uppercase: { true, false }) {
+                    for (size_t sz = 0; sz <= 300; ++sz) {
+                        const auto in = static_cast<buffer>(data).subbuf(sz, sz);
+                        const auto text = reference_hex(in, uppercase);
+                        uint8_vector out(sz);
+                        expect(hex::decode(out, text, i)) << static_cast<int>(i) << sz;
+                        expect_equal(in, static_cast<buffer>(out), fmt::format("isa {} size {}", static_cast<int>(i), sz));
+                    }
+                }
+                // mixed case is accepted
+                byte_array<4> mixed {};
+                expect(hex::decode(mixed, "aBcDeF09", i));
+                expect_equal(byte_array<4>::from_hex("ABCDEF09"), mixed);
+            }
+        };
+        "decode invalid"_test = [&] {
+            const auto text = reference_hex(static_cast<buffer>(data).subbuf(0, 200), true);
+            for (const auto i: isas) {
+                if (!simd::supported(i))
+                    continue;
+                for (size_t pos = 0; pos < text.size(); pos += 7) {
+                    for (const auto bad: { 'G', 'g', '/', ':', '@', '`', ' ', '\0', '\xFF' }) {
+                        auto broken = text;
+                        broken[pos] = bad;
+                        uint8_vector out(200);
+                        expect(!hex::decode(out, broken, i)) << static_cast<int>(i) << pos << static_cast<int>(bad);
+                    }
+                }
+            }
+        };
+        "best_isa"_test = [] {
+            expect(simd::supported(simd::best_isa()));
+            expect(simd::supported(hex::isa::scalar));
+        };
+        "formatters"_test = [&] {
+            const auto in = static_cast<buffer>(data).subbuf(0, 999);
+            expect_equal(reference_hex(in, true), fmt::format("{}", in));
+            expect_equal(reference_hex(in, false), fmt::format("{}", buffer_lowercase { in.data(), in.size() }));
+            // larger than the stack buffer of encode_to
+            const uint8_vector big(5000, 0xA5);
+            expect_equal(reference_hex(big, true), fmt::format("{}", big));
+        };
+    };
+};
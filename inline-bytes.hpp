@@ -0,0 +1,359 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include "bytes.hpp"
+
+namespace turbo {
+    // A byte vector that keeps up to N bytes inline, so that copying keys, hashes and other short fields
+    // does not allocate. Longer data moves to the heap, which grows through realloc since bytes are trivially copyable.
+    // Supports the byte_append_container interface and resizing without initializing the new bytes.
+    template<size_t N>
+    struct inline_bytes {
+        static_assert(N > 0);
+        using value_type = uint8_t;
+        using size_type = size_t;
+        using iterator = uint8_t *;
+        using const_iterator = const uint8_t *;
+
+        static constexpr size_t inline_capacity = N;
+
+        inline_bytes() noexcept
+        {
+        }
+
+        explicit inline_bytes(const size_t sz)
+        {
+            resize(sz);
+        }
+
+        inline_bytes(const size_t sz, const uint8_t val)
+        {
+            resize_uninitialized(sz);
+            memset(data(), val, sz);
+        }
+
+        inline_bytes(const buffer bytes)
+        {
+            _assign(bytes);
+        }
+
+        inline_bytes(const std::initializer_list<uint8_t> bytes)
+        {
+            _assign(buffer { std::data(bytes), bytes.size() });
+        }
+
+        inline_bytes(const inline_bytes &o)
+        {
+            _assign(o);
+        }
+
+        inline_bytes(inline_bytes &&o) noexcept
+        {
+            _steal(o);
+        }
+
+        ~inline_bytes()
+        {
+            if (_on_heap())
+                std::free(_heap);
+        }
+
+        inline_bytes &operator=(const inline_bytes &o)
+        {
+            if (this != &o) [[likely]]
+                _assign(o);
+            return *this;
+        }
+
+        inline_bytes &operator=(inline_bytes &&o) noexcept
+        {
+            if (this != &o) [[likely]] {
+                if (_on_heap())
+                    std::free(_heap);
+                _capacity = N;
+                _steal(o);
+            }
+            return *this;
+        }
+
+        inline_bytes &operator=(const buffer bytes)
+        {
+            _assign(bytes);
+            return *this;
+        }
+
+        [[nodiscard]] uint8_t *data() noexcept
+        {
+            return _on_heap() ? _heap : _inline;
+        }
+
+        [[nodiscard]] const uint8_t *data() const noexcept
+        {
+            return _on_heap() ? _heap : _inline;
+        }
+
+        [[nodiscard]] size_t size() const noexcept
+        {
+            return _size;
+        }
+
+        [[nodiscard]] size_t capacity() const noexcept
+        {
+            return _capacity;
+        }
+
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return _size == 0;
+        }
+
+        // true while the data is stored within the object
+        [[nodiscard]] bool is_inline() const noexcept
+        {
+            return !_on_heap();
+        }
+
+        iterator begin() noexcept
+        {
+            return data();
+        }
+
+        iterator end() noexcept
+        {
+            return data() + _size;
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return data();
+        }
+
+        const_iterator end() const noexcept
+        {
+            return data() + _size;
+        }
+
+        uint8_t &operator[](const size_t i) noexcept
+        {
+            return data()[i];
+        }
+
+        const uint8_t &operator[](const size_t i) const noexcept
+        {
+            return data()[i];
+        }
+
+        uint8_t &back() noexcept
+        {
+            return data()[_size - 1];
+        }
+
+        const uint8_t &back() const noexcept
+        {
+            return data()[_size - 1];
+        }
+
+        operator buffer() const noexcept
+        {
+            return { data(), _size };
+        }
+
+        std::span<uint8_t> span() noexcept
+        {
+            return { data(), _size };
+        }
+
+        std::string_view str() const noexcept
+        {
+            return { reinterpret_cast<const char *>(data()), _size };
+        }
+
+        void reserve(const size_t cap)
+        {
+            if (cap > _capacity)
+                _grow(cap);
+        }
+
+        // the new bytes are zero-filled as in std::vector
+        void resize(const size_t sz)
+        {
+            const auto prev_size = _size;
+            resize_uninitialized(sz);
+            if (sz > prev_size)
+                memset(data() + prev_size, 0, sz - prev_size);
+        }
+
+        // the new bytes are left uninitialized for the callers that overwrite them right away
+        void resize_uninitialized(const size_t sz)
+        {
+            reserve(sz);
+            _size = sz;
+        }
+
+        void clear() noexcept
+        {
+            _size = 0;
+        }
+
+        // returns the memory to the inline storage if the data fits into it
+        void shrink_to_fit() noexcept
+        {
+            if (_on_heap() && _size <= N) {
+                auto *heap = _heap;
+                memcpy(_inline, heap, _size);
+                std::free(heap);
+                _capacity = N;
+            }
+        }
+
+        uint8_t &emplace_back(const uint8_t b)
+        {
+            if (_size == _capacity) [[unlikely]]
+                _grow(_size + 1);
+            return data()[_size++] = b;
+        }
+
+        void push_back(const uint8_t b)
+        {
+            emplace_back(b);
+        }
+
+        void pop_back() noexcept
+        {
+            --_size;
+        }
+
+        template<std::forward_iterator IT>
+        iterator insert(const const_iterator pos, IT first, IT last)
+        {
+            const auto off = static_cast<size_t>(pos - data());
+            const auto num = static_cast<size_t>(std::distance(first, last));
+            if (num == 0)
+                return data() + off;
+            if constexpr (std::contiguous_iterator<IT>) {
+                const auto *src = reinterpret_cast<const uint8_t *>(std::to_address(first));
+                if (src >= data() && src < data() + _size) [[unlikely]] {
+                    // the gap can move or reallocate the source, so it is copied first
+                    const inline_bytes copy { buffer { src, num } };
+                    return insert(pos, copy.begin(), copy.end());
+                }
+                _make_gap(off, num);
+                memcpy(data() + off, src, num);
+            } else {
+                _make_gap(off, num);
+                std::copy(first, last, data() + off);
+            }
+            return data() + off;
+        }
+
+        iterator erase(const const_iterator first, const const_iterator last) noexcept
+        {
+            const auto off = static_cast<size_t>(first - data());
+            const auto num = static_cast<size_t>(last - first);
+            memmove(data() + off, data() + off + num, _size - off - num);
+            _size -= num;
+            return data() + off;
+        }
+
+        std::strong_ordering operator<=>(const buffer &o) const noexcept
+        {
+            return static_cast<buffer>(*this) <=> o;
+        }
+
+        std::strong_ordering operator<=>(const inline_bytes &o) const noexcept
+        {
+            return static_cast<buffer>(*this) <=> static_cast<buffer>(o);
+        }
+
+        bool operator==(const buffer &o) const noexcept
+        {
+            return static_cast<buffer>(*this) == o;
+        }
+
+        bool operator==(const inline_bytes &o) const noexcept
+        {
+            return static_cast<buffer>(*this) == static_cast<buffer>(o);
+        }
+    private:
+        size_t _size = 0;
+        // the heap pointer is active once the capacity exceeds the inline capacity
+        size_t _capacity = N;
+        union {
+            uint8_t _inline[N];
+            uint8_t *_heap;
+        };
+
+        [[nodiscard]] bool _on_heap() const noexcept
+        {
+            return _capacity > N;
+        }
+
+        void _grow(size_t cap)
+        {
+            // the geometric growth keeps the appends amortized constant
+            cap = std::max(cap, _capacity + _capacity / 2);
+            if (_on_heap()) {
+                auto *ptr = static_cast<uint8_t *>(std::realloc(_heap, cap));
+                if (!ptr) [[unlikely]]
+                    throw std::bad_alloc {};
+                _heap = ptr;
+            } else {
+                auto *ptr = static_cast<uint8_t *>(std::malloc(cap));
+                if (!ptr) [[unlikely]]
+                    throw std::bad_alloc {};
+                memcpy(ptr, _inline, _size);
+                _heap = ptr;
+            }
+            _capacity = cap;
+        }
+
+        void _make_gap(const size_t off, const size_t num)
+        {
+            const auto prev_size = _size;
+            resize_uninitialized(_size + num);
+            memmove(data() + off + num, data() + off, prev_size - off);
+        }
+
+        void _assign(const buffer bytes)
+        {
+            // A realloc would copy the old contents, which are replaced anyway. Data larger than the capacity
+            // cannot be a part of this vector, so freeing the memory is safe.
+            if (bytes.size() > _capacity && _on_heap()) {
+                std::free(_heap);
+                // the inline storage holds no valid data, so the growth must not copy anything from it
+                _size = 0;
+                _capacity = N;
+            }
+            resize_uninitialized(bytes.size());
+            if (!bytes.empty())
+                memmove(data(), bytes.data(), bytes.size());
+        }
+
+        void _steal(inline_bytes &o) noexcept
+        {
+            _size = o._size;
+            if (o._on_heap()) {
+                _heap = o._heap;
+                _capacity = o._capacity;
+                o._capacity = N;
+            } else {
+                memcpy(_inline, o._inline, o._size);
+            }
+            o._size = 0;
+        }
+    };
+
+    static_assert(byte_append_container<inline_bytes<32>>);
+    static_assert(std::is_convertible_v<inline_bytes<32>, buffer>);
+}
+
+namespace fmt {
+    template<size_t N>
+    struct formatter<turbo::inline_bytes<N>>: formatter<turbo::buffer> {
+    };
+}
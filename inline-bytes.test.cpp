@@ -0,0 +1,96 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <turbo/common/test.hpp>
+#include "inline-bytes.hpp"
+#include "serializable.hpp"
+
+namespace {
+    using namespace turbo;
+
+    static_assert(codec::byte_sequence_like_c<inline_bytes<32>>);
+    static_assert(codec::archive_formattable_c<inline_bytes<32>>);
+}
+
+suite turbo_common_inline_bytes_suite = [] {
+    "turbo::common::inline_bytes"_test = [] {
+        const auto hash = byte_array<32>::from_hex("00112233445566778899AABBCCDDEEFF00112233445566778899AABBCCDDEEFF");
+        "inline storage"_test = [&] {
+            inline_bytes<32> b { hash };
+            expect(b.is_inline());
+            expect_equal(buffer { hash }, buffer { b });
+            inline_bytes<32> copy { b };
+            expect(copy.is_inline());
+            expect(copy == b);
+            inline_bytes<32> moved { std::move(copy) };
+            expect(moved == b);
+            expect(copy.empty());
+            expect_equal(32U, sizeof(inline_bytes<32>) - 2 * sizeof(size_t));
+        };
+        "heap storage"_test = [&] {
+            inline_bytes<8> b {};
+            for (size_t i = 0; i < 1000; ++i)
+                b << static_cast<uint8_t>(i);
+            expect(!b.is_inline());
+            expect_equal(1000U, b.size());
+            for (size_t i = 0; i < b.size(); ++i)
+                expect_equal(static_cast<uint8_t>(i), b[i], fmt::format("byte {}", i));
+            const auto *prev_data = b.data();
+            inline_bytes<8> moved { std::move(b) };
+            // a move takes over the heap memory
+            expect(moved.data() == prev_data);
+            expect(b.is_inline());
+            expect(b.empty());
+            b = moved;
+            expect(b == moved);
+            b.resize(5);
+            b.shrink_to_fit();
+            expect(b.is_inline());
+            expect_equal(uint8_vector::from_hex("0001020304"), uint8_vector { b });
+        };
+        "assign a larger heap value"_test = [] {
+            inline_bytes<4> b(100, 0xAA);
+            expect(!b.is_inline());
+            const inline_bytes<4> larger(200, 0xBB);
+            b = larger;
+            expect_equal(200U, b.size());
+            expect(b == larger);
+        };
+        "resize"_test = [] {
+            inline_bytes<4> b(3, 0xAA);
+            b.resize(6);
+            expect_equal(uint8_vector::from_hex("AAAAAA000000"), uint8_vector { b });
+            b.resize_uninitialized(100);
+            expect_equal(100U, b.size());
+            expect(b.capacity() >= 100);
+            b.resize(2);
+            expect_equal(uint8_vector::from_hex("AAAA"), uint8_vector { b });
+            b.clear();
+            expect(b.empty());
+        };
+        "insert and erase"_test = [] {
+            inline_bytes<4> b { 0x01, 0x02, 0x03 };
+            const uint8_vector tail = uint8_vector::from_hex("0405060708");
+            b << buffer { tail };
+            expect_equal(uint8_vector::from_hex("0102030405060708"), uint8_vector { b });
+            const uint8_vector mid = uint8_vector::from_hex("AABB");
+            b.insert(b.begin() + 1, mid.begin(), mid.end());
+            expect_equal(uint8_vector::from_hex("01AABB02030405060708"), uint8_vector { b });
+            // from itself, including a reallocation
+            b.insert(b.begin() + 2, b.begin(), b.end());
+            expect_equal(uint8_vector::from_hex("01AA01AABB02030405060708BB02030405060708"), uint8_vector { b });
+            b.erase(b.begin() + 2, b.begin() + 12);
+            expect_equal(uint8_vector::from_hex("01AABB02030405060708"), uint8_vector { b });
+            b = static_cast<buffer>(b).subbuf(2);
+            expect_equal(uint8_vector::from_hex("BB02030405060708"), uint8_vector { b });
+        };
+        "ordering and formatting"_test = [&] {
+            const inline_bytes<32> a { 0x01, 0x02 };
+            const inline_bytes<32> b { 0x01, 0x03 };
+            expect(a < b);
+            expect(a == buffer { uint8_vector::from_hex("0102") });
+            expect_equal(std::string { "0102" }, fmt::format("{}", a));
+            expect_equal(std::string_view { "\x01\x02", 2 }, a.str());
+        };
+    };
+};
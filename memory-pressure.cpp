@@ -0,0 +1,308 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include "logger.hpp"
+#include "memory-pressure.hpp"
+#include "mutex.hpp"
+
+namespace turbo::memory {
+    // procfs and cgroupfs files report a zero size, so they are read as streams
+    static std::optional<std::string> _read_small_file(const std::string &path)
+    {
+        std::ifstream is { path };
+        if (!is)
+            return {};
+        std::stringstream ss {};
+        ss << is.rdbuf();
+        return ss.str();
+    }
+
+    template<typename T>
+    static std::optional<T> _parse_number(const std::string_view str)
+    {
+        T val {};
+        const auto res = std::from_chars(str.data(), str.data() + str.size(), val);
+        if (res.ec != std::errc {}) [[unlikely]]
+            return {};
+        return val;
+    }
+
+    static std::optional<std::string> _find_cgroup_dir(const pressure_config &cfg)
+    {
+        const auto proc_cgroup = _read_small_file(cfg.proc_cgroup_path);
+        if (!proc_cgroup)
+            return {};
+        // cgroup v2 has a single hierarchy with an entry of the form "0::/path"
+        std::istringstream is { *proc_cgroup };
+        for (std::string line; std::getline(is, line); ) {
+            if (line.starts_with("0::"))
+                return cfg.cgroup_root + line.substr(3);
+        }
+        return {};
+    }
+
+    static std::optional<size_t> _read_cgroup_value(const std::string &dir, const std::string_view name)
+    {
+        const auto val = _read_small_file(fmt::format("{}/{}", dir, name));
+        if (!val)
+            return {};
+        const std::string_view str { *val };
+        return _parse_number<size_t>(str.substr(0, str.find_first_of(" \n")));
+    }
+
+    // parses the avg10 field of a line such as "some avg10=0.00 avg60=0.00 avg300=0.00 total=0"
+    static std::optional<double> _parse_psi_avg10(const std::string_view psi, const std::string_view kind)
+    {
+        const auto line_pos = psi.find(kind);
+        if (line_pos == psi.npos)
+            return {};
+        static constexpr std::string_view key { "avg10=" };
+        const auto pos = psi.find(key, line_pos);
+        if (pos == psi.npos) [[unlikely]]
+            return {};
+        const auto val = psi.substr(pos + key.size());
+        return _parse_number<double>(val.substr(0, val.find(' ')));
+    }
+
+    struct pressure_monitor::impl {
+        explicit impl(const pressure_config &cfg):
+            _cfg { cfg }, _cgroup_dir { _find_cgroup_dir(cfg) }, _physical_bytes { physical_mb() << 20U }
+        {
+        }
+
+        ~impl()
+        {
+            stop();
+        }
+
+        callback_id_t on_pressure(std::string name, const double usage_threshold, callback_t callback, const std::optional<double> psi_threshold)
+        {
+            if (usage_threshold <= 0.0) [[unlikely]]
+                throw error(fmt::format("pressure callback {}: the usage threshold must be positive but got {}", name, usage_threshold));
+            mutex::scoped_lock lk { _callbacks_mutex };
+            const auto id = ++_next_id;
+            _callbacks.try_emplace(id, std::move(name), usage_threshold, psi_threshold, std::move(callback));
+            return id;
+        }
+
+        void remove(const callback_id_t id)
+        {
+            mutex::unique_lock lk { _callbacks_mutex };
+            _callbacks.erase(id);
+            // a removed callback must not run once remove() has returned, so wait for its in-progress calls
+            // except for the one made by this thread, which is calling remove() from within the callback itself
+            const auto self = std::this_thread::get_id();
+            _invoking_cv.wait(lk, [&] {
+                return std::ranges::none_of(_invoking, [&](const auto &inv) { return inv.first == id && inv.second != self; });
+            });
+        }
+
+        pressure_state sample() const
+        {
+            pressure_state st {};
+            st.rss_bytes = _rss.bytes();
+            st.physical_bytes = _physical_bytes;
+            if (_cgroup_dir) {
+                st.cgroup_current = _read_cgroup_value(*_cgroup_dir, "memory.current");
+                st.cgroup_max = _read_cgroup_value(*_cgroup_dir, "memory.max");
+            }
+            if (const auto psi = _read_small_file(_cfg.psi_path); psi) {
+                st.psi_some_avg10 = _parse_psi_avg10(*psi, "some");
+                st.psi_full_avg10 = _parse_psi_avg10(*psi, "full");
+            }
+            return st;
+        }
+
+        size_t check()
+        {
+            const auto st = sample();
+            std::vector<std::pair<callback_id_t, callback_t>> triggered {};
+            {
+                mutex::scoped_lock lk { _callbacks_mutex };
+                for (auto &[id, cb]: _callbacks) {
+                    const auto psi_over = [&](const double margin) {
+                        return cb.psi_threshold && st.psi_some_avg10 && *st.psi_some_avg10 >= *cb.psi_threshold - margin;
+                    };
+                    if (cb.armed) {
+                        if (st.usage() >= cb.usage_threshold || psi_over(0.0)) {
+                            cb.armed = false;
+                            triggered.emplace_back(id, cb.callback);
+                        }
+                    } else if (st.usage() < cb.usage_threshold - _cfg.usage_rearm_margin && !psi_over(_cfg.psi_rearm_margin)) {
+                        cb.armed = true;
+                    }
+                }
+            }
+            // the callbacks are invoked without holding the lock, so that they can register or remove other callbacks
+            size_t num_invoked = 0;
+            for (const auto &[id, callback]: triggered) {
+                const auto name = _begin_invoke(id);
+                if (!name)
+                    continue;
+                logger::debug("memory pressure: {} invoking shrink callback {}", st, *name);
+                logger::run_log_errors([&] {
+                    callback(st);
+                });
+                _end_invoke(id);
+                ++num_invoked;
+            }
+            return num_invoked;
+        }
+
+        void start()
+        {
+            std::thread prev {};
+            {
+                mutex::scoped_lock lk { _thread_mutex };
+                if (_thread.joinable() && _thread_gen == _generation)
+                    return;
+                // a thread stopped from within a callback has not been joined yet
+                prev = std::move(_thread);
+                _thread_gen = ++_generation;
+                _thread = std::thread { [this, gen = _thread_gen] { _run(gen); } };
+            }
+            _thread_cv.notify_all();
+            _join(prev);
+        }
+
+        void stop()
+        {
+            std::thread t {};
+            {
+                mutex::scoped_lock lk { _thread_mutex };
+                if (!_thread.joinable())
+                    return;
+                // a new generation tells the running thread to exit
+                if (_thread_gen == _generation)
+                    ++_generation;
+                // the monitor thread cannot join itself, so when a callback calls stop(),
+                // the thread is left for the next stop(), start() or the destructor to join
+                if (_thread.get_id() == std::this_thread::get_id()) {
+                    _thread_cv.notify_all();
+                    return;
+                }
+                // only the caller that takes the thread joins it
+                t = std::move(_thread);
+            }
+            _thread_cv.notify_all();
+            t.join();
+        }
+    private:
+        struct callback_info {
+            std::string name;
+            double usage_threshold;
+            std::optional<double> psi_threshold;
+            callback_t callback;
+            // cleared when the callback fires and set again once the pressure is gone
+            bool armed = true;
+        };
+
+        const pressure_config _cfg;
+        const std::optional<std::string> _cgroup_dir;
+        const size_t _physical_bytes;
+        const rss_sampler _rss {};
+        mutable mutex::unique_lock::mutex_type _callbacks_mutex alignas(mutex::alignment) {};
+        std::map<callback_id_t, callback_info> _callbacks {};
+        // the callbacks being invoked and the threads invoking them
+        std::vector<std::pair<callback_id_t, std::thread::id>> _invoking {};
+        std::condition_variable_any _invoking_cv {};
+        callback_id_t _next_id = 0;
+        mutex::unique_lock::mutex_type _thread_mutex alignas(mutex::alignment) {};
+        std::condition_variable_any _thread_cv {};
+        std::thread _thread {};
+        // incremented by every start() and stop(), so a thread runs only while its generation is current
+        size_t _generation = 0;
+        size_t _thread_gen = 0;
+
+        // marks the callback as being invoked unless it has been removed since it was triggered; returns its name
+        std::optional<std::string> _begin_invoke(const callback_id_t id)
+        {
+            mutex::scoped_lock lk { _callbacks_mutex };
+            const auto it = _callbacks.find(id);
+            if (it == _callbacks.end())
+                return {};
+            _invoking.emplace_back(id, std::this_thread::get_id());
+            return it->second.name;
+        }
+
+        void _end_invoke(const callback_id_t id)
+        {
+            {
+                mutex::scoped_lock lk { _callbacks_mutex };
+                const auto it = std::ranges::find(_invoking, std::make_pair(id, std::this_thread::get_id()));
+                if (it != _invoking.end())
+                    _invoking.erase(it);
+            }
+            _invoking_cv.notify_all();
+        }
+
+        static void _join(std::thread &t)
+        {
+            if (!t.joinable())
+                return;
+            // start() called from a callback after stop() replaces the very thread it runs on
+            if (t.get_id() == std::this_thread::get_id())
+                t.detach();
+            else
+                t.join();
+        }
+
+        void _run(const size_t gen)
+        {
+            for (;;) {
+                {
+                    mutex::unique_lock lk { _thread_mutex };
+                    if (_thread_cv.wait_for(lk, _cfg.interval, [&] { return _generation != gen; }))
+                        break;
+                }
+                logger::run_log_errors([&] {
+                    check();
+                });
+            }
+        }
+    };
+
+    pressure_monitor::pressure_monitor(const pressure_config &cfg):
+        _impl { std::make_unique<impl>(cfg) }
+    {
+    }
+
+    pressure_monitor::~pressure_monitor() =default;
+
+    pressure_monitor::callback_id_t pressure_monitor::on_pressure(std::string name, const double usage_threshold, callback_t callback, const std::optional<double> psi_threshold)
+    {
+        return _impl->on_pressure(std::move(name), usage_threshold, std::move(callback), psi_threshold);
+    }
+
+    void pressure_monitor::remove(const callback_id_t id)
+    {
+        _impl->remove(id);
+    }
+
+    pressure_state pressure_monitor::sample() const
+    {
+        return _impl->sample();
+    }
+
+    size_t pressure_monitor::check()
+    {
+        return _impl->check();
+    }
+
+    void pressure_monitor::start()
+    {
+        _impl->start();
+    }
+
+    void pressure_monitor::stop()
+    {
+        _impl->stop();
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include "memory.hpp"
+
+namespace turbo::memory {
+    struct pressure_state {
+        size_t rss_bytes = 0;
+        size_t physical_bytes = 0;
+        // cgroup v2 memory.current and memory.max; empty outside of a cgroup v2 or when memory.max is "max"
+        std::optional<size_t> cgroup_current {};
+        std::optional<size_t> cgroup_max {};
+        // the avg10 values of /proc/pressure/memory in percent
+        std::optional<double> psi_some_avg10 {};
+        std::optional<double> psi_full_avg10 {};
+
+        [[nodiscard]] size_t used_bytes() const noexcept
+        {
+            return cgroup_current ? *cgroup_current : rss_bytes;
+        }
+
+        [[nodiscard]] size_t limit_bytes() const noexcept
+        {
+            if (cgroup_max && (!physical_bytes || *cgroup_max < physical_bytes))
+                return *cgroup_max;
+            return physical_bytes;
+        }
+
+        // the used fraction of the effective memory limit
+        [[nodiscard]] double usage() const noexcept
+        {
+            const auto limit = limit_bytes();
+            return limit ? static_cast<double>(used_bytes()) / static_cast<double>(limit) : 0.0;
+        }
+    };
+
+    struct pressure_config {
+        std::chrono::milliseconds interval { 1000 };
+        std::string proc_cgroup_path { "/proc/self/cgroup" };
+        std::string cgroup_root { "/sys/fs/cgroup" };
+        std::string psi_path { "/proc/pressure/memory" };
+        // a callback that has fired is invoked again only after the usage has dropped this far below its threshold
+        // and psi_some_avg10, when the callback has a psi threshold, this many percentage points below it
+        double usage_rearm_margin = 0.05;
+        double psi_rearm_margin = 5.0;
+    };
+
+    // Periodically samples the process's memory usage and invokes the registered shrink callbacks
+    // when their thresholds become exceeded. A callback fires once per episode of pressure rather than on every sample
+    // and is re-armed once the pressure falls below its thresholds by the configured margins.
+    // The callbacks are called from the monitor's thread. A callback may call stop(), in which case the thread exits
+    // once the callback returns and is joined by the next start(), stop() or the destructor,
+    // but a callback must not destroy the monitor.
+    struct pressure_monitor {
+        using callback_t = std::function<void(const pressure_state &)>;
+        using callback_id_t = size_t;
+
+        static pressure_monitor &get()
+        {
+            static pressure_monitor mon {};
+            return mon;
+        }
+
+        explicit pressure_monitor(const pressure_config &cfg={});
+        ~pressure_monitor();
+
+        // usage_threshold is a fraction of pressure_state::limit_bytes();
+        // psi_threshold, when given, also triggers the callback once psi_some_avg10 reaches it.
+        callback_id_t on_pressure(std::string name, double usage_threshold, callback_t callback, std::optional<double> psi_threshold={});
+        // Once remove() returns, the callback is no longer called and none of its calls are in progress,
+        // so a callback capturing an object can be removed in the object's destructor.
+        // When called from within the callback being removed, remove() does not wait for the current call to finish.
+        void remove(callback_id_t id);
+        [[nodiscard]] pressure_state sample() const;
+        // samples once and invokes the armed callbacks whose thresholds are exceeded; returns the number of invoked callbacks
+        size_t check();
+        void start();
+        void stop();
+    private:
+        struct impl;
+        std::unique_ptr<impl> _impl;
+    };
+}
+
+namespace fmt {
+    template<>
+    struct formatter<turbo::memory::pressure_state>: formatter<int> {
+        template<typename FormatContext>
+        auto format(const auto &v, FormatContext &ctx) const -> decltype(ctx.out()) {
+            return fmt::format_to(ctx.out(), "used: {} MB limit: {} MB ({:0.1f}%) psi some avg10: {}",
+                v.used_bytes() >> 20U, v.limit_bytes() >> 20U, v.usage() * 100, v.psi_some_avg10);
+        }
+    };
+}
@@ -0,0 +1,196 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <turbo/common/test.hpp>
+#include "memory-pressure.hpp"
+
+namespace {
+    using namespace turbo;
+
+    memory::pressure_config fake_cgroup_config(const file::tmp_directory &dir, const size_t current, const std::string_view max)
+    {
+        const std::filesystem::path root { dir.path() };
+        file::write(root / "cgroup", buffer { std::string_view { "0::/workers\n" } });
+        file::write(root / "workers" / "memory.current", buffer { fmt::format("{}\n", current) });
+        file::write(root / "workers" / "memory.max", buffer { fmt::format("{}\n", max) });
+        file::write(root / "pressure", buffer { std::string_view {
+            "some avg10=12.50 avg60=3.00 avg300=1.00 total=12345\n"
+            "full avg10=0.25 avg60=0.00 avg300=0.00 total=678\n" } });
+        return { std::chrono::milliseconds { 10 }, (root / "cgroup").string(), dir.path(), (root / "pressure").string() };
+    }
+
+    void set_fake_usage(const file::tmp_directory &dir, const size_t current, const double psi_some_avg10)
+    {
+        const std::filesystem::path root { dir.path() };
+        file::write(root / "workers" / "memory.current", buffer { fmt::format("{}\n", current) });
+        file::write(root / "pressure", buffer { fmt::format(
+            "some avg10={:.2f} avg60=3.00 avg300=1.00 total=12345\n"
+            "full avg10=0.25 avg60=0.00 avg300=0.00 total=678\n", psi_some_avg10) });
+    }
+}
+
+suite turbo_common_memory_pressure_suite = [] {
+    "turbo::common::memory_pressure"_test = [] {
+        "sample"_test = [] {
+            const file::tmp_directory dir { "turbo-memory-pressure-sample" };
+            const memory::pressure_monitor mon { fake_cgroup_config(dir, 1000, "4000") };
+            const auto st = mon.sample();
+            expect(st.rss_bytes > 0);
+            expect_equal(size_t { 1000 }, st.cgroup_current.value_or(0), "cgroup_current");
+            expect_equal(size_t { 4000 }, st.cgroup_max.value_or(0), "cgroup_max");
+            expect_equal(size_t { 4000 }, st.limit_bytes(), "limit_bytes");
+            expect_close(0.25, st.usage());
+            expect_close(12.5, st.psi_some_avg10.value_or(0.0));
+            expect_close(0.25, st.psi_full_avg10.value_or(0.0));
+        };
+        "unlimited cgroup"_test = [] {
+            const file::tmp_directory dir { "turbo-memory-pressure-unlimited" };
+            const memory::pressure_monitor mon { fake_cgroup_config(dir, 1000, "max") };
+            const auto st = mon.sample();
+            expect(!st.cgroup_max);
+            expect_equal(st.physical_bytes, st.limit_bytes());
+        };
+        "check"_test = [] {
+            const file::tmp_directory dir { "turbo-memory-pressure-check" };
+            memory::pressure_monitor mon { fake_cgroup_config(dir, 3000, "4000") };
+            size_t num_high = 0;
+            size_t num_low = 0;
+            size_t num_psi = 0;
+            mon.on_pressure("high", 0.9, [&](const auto &) { ++num_high; });
+            const auto low_id = mon.on_pressure("low", 0.5, [&](const auto &) { ++num_low; });
+            mon.on_pressure("psi", 0.99, [&](const auto &) { ++num_psi; }, 10.0);
+            expect_equal(size_t { 2 }, mon.check());
+            expect_equal(size_t { 0 }, num_high);
+            expect_equal(size_t { 1 }, num_low);
+            expect_equal(size_t { 1 }, num_psi);
+            mon.remove(low_id);
+            // the callbacks fire only when the pressure begins, not on every sample
+            expect_equal(size_t { 0 }, mon.check());
+            expect_equal(size_t { 1 }, num_psi);
+            expect_equal(size_t { 1 }, num_low);
+            expect(throws([&] { mon.on_pressure("bad", 0.0, [](const auto &) {}); }));
+        };
+        "hysteresis"_test = [] {
+            const file::tmp_directory dir { "turbo-memory-pressure-hysteresis" };
+            memory::pressure_monitor mon { fake_cgroup_config(dir, 3000, "4000") };
+            size_t num_calls = 0;
+            mon.on_pressure("usage", 0.7, [&](const auto &) { ++num_calls; });
+            expect_equal(size_t { 1 }, mon.check());
+            expect_equal(size_t { 0 }, mon.check());
+            // within the re-arm margin below the threshold
+            set_fake_usage(dir, 2900, 0.0);
+            expect_equal(size_t { 0 }, mon.check());
+            set_fake_usage(dir, 3000, 0.0);
+            expect_equal(size_t { 0 }, mon.check());
+            // below the margin re-arms the callback
+            set_fake_usage(dir, 2000, 0.0);
+            expect_equal(size_t { 0 }, mon.check());
+            set_fake_usage(dir, 2800, 0.0);
+            expect_equal(size_t { 1 }, mon.check());
+            expect_equal(size_t { 2 }, num_calls);
+            // psi re-arms only once it falls far enough below its threshold as well
+            size_t num_psi = 0;
+            mon.on_pressure("psi", 0.99, [&](const auto &) { ++num_psi; }, 10.0);
+            set_fake_usage(dir, 1000, 12.5);
+            expect_equal(size_t { 1 }, mon.check());
+            set_fake_usage(dir, 1000, 7.0);
+            expect_equal(size_t { 0 }, mon.check());
+            set_fake_usage(dir, 1000, 12.5);
+            expect_equal(size_t { 0 }, mon.check());
+            set_fake_usage(dir, 1000, 1.0);
+            expect_equal(size_t { 0 }, mon.check());
+            set_fake_usage(dir, 1000, 12.5);
+            expect_equal(size_t { 1 }, mon.check());
+            expect_equal(size_t { 2 }, num_psi);
+        };
+        "background thread"_test = [] {
+            const file::tmp_directory dir { "turbo-memory-pressure-thread" };
+            memory::pressure_monitor mon { fake_cgroup_config(dir, 3000, "4000") };
+            std::atomic_size_t num_calls = 0;
+            mon.on_pressure("any", 0.1, [&](const auto &) { num_calls.fetch_add(1, std::memory_order_relaxed); });
+            mon.start();
+            for (size_t i = 0; i < 500 && num_calls.load() == 0; ++i)
+                std::this_thread::sleep_for(std::chrono::milliseconds { 10 });
+            mon.stop();
+            expect(num_calls.load() > 0);
+        };
+        "remove waits for the callback"_test = [] {
+            const file::tmp_directory dir { "turbo-memory-pressure-remove" };
+            memory::pressure_monitor mon { fake_cgroup_config(dir, 3000, "4000") };
+            std::atomic_bool started = false;
+            std::atomic_bool finished = false;
+            std::atomic_bool removed = false;
+            std::atomic_bool called_after_remove = false;
+            const auto id = mon.on_pressure("slow", 0.1, [&](const auto &) {
+                if (removed.load())
+                    called_after_remove = true;
+                started = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds { 100 });
+                if (removed.load())
+                    called_after_remove = true;
+                finished = true;
+            });
+            std::thread checker { [&] { mon.check(); } };
+            while (!started.load())
+                std::this_thread::yield();
+            mon.remove(id);
+            removed = true;
+            expect(finished.load());
+            checker.join();
+            set_fake_usage(dir, 100, 0.0);
+            mon.check();
+            set_fake_usage(dir, 3000, 0.0);
+            expect_equal(size_t { 0 }, mon.check());
+            expect(!called_after_remove.load());
+        };
+        "remove from within the callback"_test = [] {
+            const file::tmp_directory dir { "turbo-memory-pressure-remove-self" };
+            memory::pressure_monitor mon { fake_cgroup_config(dir, 3000, "4000") };
+            memory::pressure_monitor::callback_id_t id = 0;
+            size_t num_calls = 0;
+            id = mon.on_pressure("self", 0.1, [&](const auto &) {
+                ++num_calls;
+                mon.remove(id);
+            });
+            expect_equal(size_t { 1 }, mon.check());
+            set_fake_usage(dir, 100, 0.0);
+            mon.check();
+            set_fake_usage(dir, 3000, 0.0);
+            expect_equal(size_t { 0 }, mon.check());
+            expect_equal(size_t { 1 }, num_calls);
+        };
+        "stop from within the callback"_test = [] {
+            const file::tmp_directory dir { "turbo-memory-pressure-stop-self" };
+            memory::pressure_monitor mon { fake_cgroup_config(dir, 3000, "4000") };
+            std::atomic_size_t num_calls = 0;
+            mon.on_pressure("stop", 0.1, [&](const auto &) {
+                mon.stop();
+                num_calls.fetch_add(1, std::memory_order_relaxed);
+            });
+            mon.start();
+            for (size_t i = 0; i < 500 && num_calls.load() == 0; ++i)
+                std::this_thread::sleep_for(std::chrono::milliseconds { 10 });
+            expect_equal(size_t { 1 }, num_calls.load());
+            // the stopped thread is joined by the next start
+            set_fake_usage(dir, 100, 0.0);
+            mon.check();
+            set_fake_usage(dir, 3000, 0.0);
+            mon.start();
+            for (size_t i = 0; i < 500 && num_calls.load() == 1; ++i)
+                std::this_thread::sleep_for(std::chrono::milliseconds { 10 });
+            expect_equal(size_t { 2 }, num_calls.load());
+        };
+        "concurrent stop"_test = [] {
+            const file::tmp_directory dir { "turbo-memory-pressure-stop" };
+            memory::pressure_monitor mon { fake_cgroup_config(dir, 3000, "4000") };
+            for (size_t i = 0; i < 20; ++i) {
+                mon.start();
+                std::thread t1 { [&] { mon.stop(); } };
+                std::thread t2 { [&] { mon.stop(); } };
+                t1.join();
+                t2.join();
+            }
+            expect(true);
+        };
+    };
+};
@@ -1,5 +1,5 @@
 /* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
- * Copyright (c) 2024-2025 R2 Rationality OÜ (info at r2rationality dot com) */
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
 
 extern "C" {
 #ifdef __APPLE__
@@ -12,12 +12,16 @@ extern "C" {
 #   include <windows.h>
 #   include <psapi.h>
 #else
+#   include <fcntl.h>
 #   include <unistd.h>
 #   include <sys/time.h>
 #   include <sys/resource.h>
 #endif
 }
-#include <fstream>
+#include <array>
+#include <charconv>
+#include <cstdlib>
+#include <new>
 #include "error.hpp"
 #include "format.hpp"
 #include "mutex.hpp"
@@ -27,43 +31,66 @@ namespace turbo::memory {
     // Win API is not thread safe by default
     static mutex::unique_lock::mutex_type _win_api_mutex alignas(mutex::alignment) {};
 
-    size_t my_usage_mb()
+    rss_sampler::rss_sampler()
+    {
+#       ifdef __linux__
+            const long v = sysconf(_SC_PAGESIZE);
+            if (v < 0) [[unlikely]]
+                throw error_sys("sysconf failed");
+            _page_size = static_cast<size_t>(v);
+            _fd = ::open("/proc/self/statm", O_RDONLY | O_CLOEXEC);
+            if (_fd < 0) [[unlikely]]
+                throw error_sys("unable to open /proc/self/statm");
+#       endif
+    }
+
+    rss_sampler::~rss_sampler()
+    {
+#       ifdef __linux__
+            if (_fd >= 0)
+                ::close(_fd);
+#       endif
+    }
+
+    size_t rss_sampler::bytes() const
     {
-        mutex::scoped_lock lk{_win_api_mutex};
 #       ifdef _WIN32
+            mutex::scoped_lock lk{_win_api_mutex};
             PROCESS_MEMORY_COUNTERS_EX pmc{};
             GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&pmc, sizeof(pmc));
-            return static_cast<size_t>(pmc.WorkingSetSize >> 20U);
+            return static_cast<size_t>(pmc.WorkingSetSize);
 #       elif __linux__
-            static size_t page_size = [](){
-                const long v = sysconf(_SC_PAGESIZE);
-                if (v < 0) [[unlikely]]
-                    throw error_sys("sysconf failed");
-                return static_cast<size_t>(v);
-            }();
-
-            // statm file has always a 0 size despite having the content, so cannot use file::read
-            std::ifstream is { "/proc/self/statm" };
-            if (!is) [[unlikely]]
-                throw error("unable to open /proc/self/statm");
-            std::string stat;
-            std::getline(is, stat);
+            // statm file has always a 0 size despite having the content, so it is re-read from the start every time
+            std::array<char, 256> buf;
+            const auto num_read = ::pread(_fd, buf.data(), buf.size() - 1, 0);
+            if (num_read <= 0) [[unlikely]]
+                throw error_sys("failed to read /proc/self/statm");
+            const std::string_view stat { buf.data(), static_cast<size_t>(num_read) };
             auto pos = stat.find(' ');
             if (pos == stat.npos) [[unlikely]]
                 throw error(fmt::format("invalid /proc/self/statm file format: '{}'!", stat));
             const auto rss_begin = stat.find_first_not_of(' ', pos);
             if (rss_begin == stat.npos) [[unlikely]]
                 throw error(fmt::format("invalid /proc/self/statm file format: '{}'!", stat));
-            pos = stat.find(' ', rss_begin);
-            return (std::stoull(stat.substr(rss_begin, pos - rss_begin)) * page_size) >> 20U;
+            size_t rss_pages = 0;
+            if (const auto res = std::from_chars(stat.data() + rss_begin, stat.data() + stat.size(), rss_pages); res.ec != std::errc{}) [[unlikely]]
+                throw error(fmt::format("invalid /proc/self/statm file format: '{}'!", stat));
+            return rss_pages * _page_size;
 #       else
+            mutex::scoped_lock lk{_win_api_mutex};
             struct mach_task_basic_info tinfo{};
             mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
             task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &tinfo, &count);
-            return tinfo.resident_size >> 20U;
+            return tinfo.resident_size;
 #       endif
     }
 
+    size_t my_usage_mb()
+    {
+        static const rss_sampler sampler {};
+        return sampler.mb();
+    }
+
     size_t max_usage_mb()
     {
         mutex::scoped_lock lk{_win_api_mutex};
@@ -99,4 +126,120 @@ namespace turbo::memory {
             return (static_cast<size_t>(pages) * static_cast<size_t>(page_size)) >> 20U;
 #       endif
     }
+
+#   ifdef TURBO_MEMORY_TRACKING
+        // constant-initialized, so accessing it from operator new never triggers a dynamic TLS initialization
+        static thread_local constinit alloc_stats _thread_stats {};
+
+        alloc_stats thread_stats() noexcept
+        {
+            return _thread_stats;
+        }
+#   else
+        alloc_stats thread_stats() noexcept
+        {
+            return {};
+        }
+#   endif
+
+    static mutex::unique_lock::mutex_type _tracker_mutex alignas(mutex::alignment) {};
+
+    static tracker::stats_map &_tracker_stats()
+    {
+        static tracker::stats_map stats {};
+        return stats;
+    }
+
+    tracker::tracker(std::string name):
+        _name { std::move(name) }, _start { thread_stats() }
+    {
+    }
+
+    tracker::~tracker()
+    {
+        const auto delta = stats();
+        mutex::scoped_lock lk { _tracker_mutex };
+        _tracker_stats()[_name] += delta;
+    }
+
+    tracker::stats_map tracker::report()
+    {
+        mutex::scoped_lock lk { _tracker_mutex };
+        return _tracker_stats();
+    }
+
+    void tracker::reset()
+    {
+        mutex::scoped_lock lk { _tracker_mutex };
+        _tracker_stats().clear();
+    }
 }
+
+#ifdef TURBO_MEMORY_TRACKING
+    // The array and nothrow overloads are implemented by the standard library in terms of these.
+    void *operator new(const std::size_t sz)
+    {
+        auto &stats = turbo::memory::_thread_stats;
+        ++stats.alloc_calls;
+        stats.alloc_bytes += sz;
+        // as the replaceable allocation functions must, calls the new handler until it frees memory or gives up
+        for (;;) {
+            if (void *ptr = std::malloc(sz ? sz : 1); ptr) [[likely]]
+                return ptr;
+            const auto handler = std::get_new_handler();
+            if (!handler)
+                throw std::bad_alloc {};
+            handler();
+        }
+    }
+
+    void *operator new(const std::size_t sz, const std::align_val_t align)
+    {
+        auto &stats = turbo::memory::_thread_stats;
+        ++stats.alloc_calls;
+        stats.alloc_bytes += sz;
+        for (;;) {
+#           ifdef _WIN32
+                if (void *ptr = _aligned_malloc(sz ? sz : 1, static_cast<size_t>(align)); ptr) [[likely]]
+                    return ptr;
+#           else
+                if (void *ptr = nullptr; posix_memalign(&ptr, static_cast<size_t>(align), sz ? sz : 1) == 0) [[likely]]
+                    return ptr;
+#           endif
+            const auto handler = std::get_new_handler();
+            if (!handler)
+                throw std::bad_alloc {};
+            handler();
+        }
+    }
+
+    void operator delete(void *ptr) noexcept
+    {
+        if (ptr) {
+            ++turbo::memory::_thread_stats.free_calls;
+            std::free(ptr);
+        }
+    }
+
+    void operator delete(void *ptr, std::align_val_t) noexcept
+    {
+        if (ptr) {
+            ++turbo::memory::_thread_stats.free_calls;
+#           ifdef _WIN32
+                _aligned_free(ptr);
+#           else
+                std::free(ptr);
+#           endif
+        }
+    }
+
+    void operator delete(void *ptr, std::size_t) noexcept
+    {
+        operator delete(ptr);
+    }
+
+    void operator delete(void *ptr, std::size_t, const std::align_val_t align) noexcept
+    {
+        operator delete(ptr, align);
+    }
+#endif
@@ -1,11 +1,99 @@
 #pragma once
 /* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
- * Copyright (c) 2024-2025 R2 Rationality OÜ (info at r2rationality dot com) */
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
 
 #include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include "format.hpp"
 
 namespace turbo::memory {
     extern size_t max_usage_mb();
     extern size_t physical_mb();
     extern size_t my_usage_mb();
-}
\ No newline at end of file
+
+    // Reads the resident set size of the current process.
+    // On Linux, keeps /proc/self/statm open and re-reads it with pread, so sampling is lock-free
+    // and costs a single system call.
+    struct rss_sampler {
+        rss_sampler();
+        rss_sampler(const rss_sampler &) = delete;
+        rss_sampler &operator=(const rss_sampler &) = delete;
+        ~rss_sampler();
+
+        [[nodiscard]] size_t bytes() const;
+
+        [[nodiscard]] size_t mb() const
+        {
+            return bytes() >> 20U;
+        }
+    private:
+        int _fd = -1;
+        size_t _page_size = 0;
+    };
+
+    // Allocation tracking hooks the global operator new and operator delete
+    // and is compiled in only when TURBO_MEMORY_TRACKING is defined.
+#ifdef TURBO_MEMORY_TRACKING
+    static constexpr bool tracking_enabled = true;
+#else
+    static constexpr bool tracking_enabled = false;
+#endif
+
+    struct alloc_stats {
+        uint64_t alloc_calls = 0;
+        uint64_t alloc_bytes = 0;
+        uint64_t free_calls = 0;
+
+        alloc_stats &operator+=(const alloc_stats &o) noexcept
+        {
+            alloc_calls += o.alloc_calls;
+            alloc_bytes += o.alloc_bytes;
+            free_calls += o.free_calls;
+            return *this;
+        }
+
+        alloc_stats operator-(const alloc_stats &o) const noexcept
+        {
+            return { alloc_calls - o.alloc_calls, alloc_bytes - o.alloc_bytes, free_calls - o.free_calls };
+        }
+
+        bool operator==(const alloc_stats &o) const noexcept =default;
+    };
+
+    // Cumulative allocations made by the calling thread. Always zero when tracking is disabled.
+    extern alloc_stats thread_stats() noexcept;
+
+    // Attributes the allocations made by the calling thread during its lifetime to a named region.
+    // Nested trackers are inclusive: an allocation is counted in every active region of the thread.
+    struct tracker {
+        using stats_map = std::map<std::string, alloc_stats>;
+
+        explicit tracker(std::string name);
+        tracker(const tracker &) = delete;
+        tracker &operator=(const tracker &) = delete;
+        ~tracker();
+
+        [[nodiscard]] alloc_stats stats() const noexcept
+        {
+            return thread_stats() - _start;
+        }
+
+        static stats_map report();
+        static void reset();
+    private:
+        std::string _name;
+        alloc_stats _start;
+    };
+}
+
+namespace fmt {
+    template<>
+    struct formatter<turbo::memory::alloc_stats>: formatter<int> {
+        template<typename FormatContext>
+        auto format(const auto &v, FormatContext &ctx) const -> decltype(ctx.out()) {
+            return fmt::format_to(ctx.out(), "allocs: {} bytes: {} frees: {}", v.alloc_calls, v.alloc_bytes, v.free_calls);
+        }
+    };
+}
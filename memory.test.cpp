@@ -1,6 +1,8 @@
 /* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
- * Copyright (c) 2024-2025 R2 Rationality OÜ (info at r2rationality dot com) */
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
 
+#include <limits>
+#include <new>
 #include <turbo/common/test.hpp>
 #include "memory.hpp"
 #include "timer.hpp"
@@ -27,5 +29,48 @@ suite turbo_common_memory_suite = [] {
             expect(after > before) << after << before;
             // Some standard libraries do not immediately return the memory to the OS, thus, not checking for the memory release
         };
+        "rss_sampler"_test = [] {
+            const memory::rss_sampler sampler {};
+            const auto first = sampler.bytes();
+            expect(first > 0);
+            // the cached handle must be re-readable
+            expect(sampler.bytes() > 0);
+            expect_equal(sampler.bytes() >> 20U, sampler.mb(), "mb");
+        };
+        "tracker"_test = [] {
+            memory::tracker::reset();
+            {
+                const memory::tracker t { "test-region" };
+                auto data = std::make_unique<std::array<uint8_t, 1000>>();
+                // a volatile write ensures that the compiler does not elide the allocation
+                *static_cast<volatile uint8_t *>(data->data()) = 1;
+                if constexpr (memory::tracking_enabled) {
+                    expect(t.stats().alloc_calls >= 1U);
+                    expect(t.stats().alloc_bytes >= 1000U);
+                } else {
+                    expect(t.stats() == memory::alloc_stats {});
+                }
+            }
+            const auto report = memory::tracker::report();
+            expect(report.contains("test-region"));
+            if constexpr (memory::tracking_enabled) {
+                const auto &stats = report.at("test-region");
+                expect(stats.alloc_calls >= 1U);
+                expect(stats.free_calls >= 1U);
+            }
+        };
+        "new handler"_test = [] {
+            // a failed allocation calls the new handler until it gives up by uninstalling itself
+            static size_t num_calls = 0;
+            num_calls = 0;
+            const auto prev_handler = std::set_new_handler([] {
+                if (++num_calls == 3)
+                    std::set_new_handler(nullptr);
+            });
+            volatile size_t size = std::numeric_limits<size_t>::max() / 2;
+            expect(throws<std::bad_alloc>([&] { ::operator delete(::operator new(size)); }));
+            std::set_new_handler(prev_handler);
+            expect_equal(size_t { 3 }, num_calls);
+        };
     };
 };
\ No newline at end of file
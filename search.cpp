@@ -0,0 +1,220 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <string_view>
+#include "search.hpp"
+
+#ifdef TURBO_SIMD_X86
+#   include <immintrin.h>
+#endif
+
+namespace turbo::search {
+    namespace {
+        size_t find_scalar(const uint8_t *data, const size_t size, const uint8_t *needle, const size_t needle_size, const size_t from) noexcept
+        {
+            const std::string_view hay { reinterpret_cast<const char *>(data), size };
+            return hay.find(std::string_view { reinterpret_cast<const char *>(needle), needle_size }, from);
+        }
+
+        size_t find_first_of_scalar(const uint8_t *data, const size_t size, const std::array<bool, 256> &member, const size_t from) noexcept
+        {
+            for (size_t i = from; i < size; ++i) {
+                if (member[data[i]])
+                    return i;
+            }
+            return npos;
+        }
+
+#ifdef TURBO_SIMD_X86
+        // Tables for the lookup of a byte set with two shuffles: the entry for a low nibble has one bit per
+        // high nibble for which the byte is in the set. The high nibbles 0-7 are in lo_table and 8-15 in hi_table.
+        struct nibble_tables {
+            alignas(16) std::array<uint8_t, 16> lo_table {};
+            alignas(16) std::array<uint8_t, 16> hi_table {};
+        };
+
+        nibble_tables make_nibble_tables(const buffer set) noexcept
+        {
+            nibble_tables t {};
+            for (const auto b: set) {
+                const auto hi = b >> 4U;
+                auto &table = hi < 8 ? t.lo_table : t.hi_table;
+                table[b & 0xFU] |= static_cast<uint8_t>(1U << (hi & 7U));
+            }
+            return t;
+        }
+
+        // The candidates are the positions where both the first and the last byte of the needle match,
+        // which rules out most of the false positives before the comparison of the whole needle.
+        __attribute__((target("sse4.1")))
+        size_t find_sse41(const uint8_t *data, const size_t size, const uint8_t *needle, const size_t needle_size, size_t &done) noexcept
+        {
+            const auto first = _mm_set1_epi8(static_cast<char>(needle[0]));
+            const auto last = _mm_set1_epi8(static_cast<char>(needle[needle_size - 1]));
+            size_t i = 0;
+            for (; i + needle_size - 1 + 16 <= size; i += 16) {
+                const auto bf = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+                const auto bl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + needle_size - 1));
+                auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(bf, first), _mm_cmpeq_epi8(bl, last))));
+                for (; mask; mask &= mask - 1) {
+                    const auto pos = i + static_cast<size_t>(std::countr_zero(mask));
+                    if (memcmp(data + pos + 1, needle + 1, needle_size - 2) == 0)
+                        return pos;
+                }
+            }
+            done = i;
+            return npos;
+        }
+
+        __attribute__((target("avx2")))
+        size_t find_avx2(const uint8_t *data, const size_t size, const uint8_t *needle, const size_t needle_size, size_t &done) noexcept
+        {
+            const auto first = _mm256_set1_epi8(static_cast<char>(needle[0]));
+            const auto last = _mm256_set1_epi8(static_cast<char>(needle[needle_size - 1]));
+            size_t i = 0;
+            for (; i + needle_size - 1 + 32 <= size; i += 32) {
+                const auto bf = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+                const auto bl = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + needle_size - 1));
+                auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(bf, first), _mm256_cmpeq_epi8(bl, last))));
+                for (; mask; mask &= mask - 1) {
+                    const auto pos = i + static_cast<size_t>(std::countr_zero(mask));
+                    if (memcmp(data + pos + 1, needle + 1, needle_size - 2) == 0)
+                        return pos;
+                }
+            }
+            done = i;
+            return npos;
+        }
+
+        // the mask of the bytes of x that are in the set described by the tables
+        __attribute__((target("sse4.1"), always_inline))
+        inline uint32_t match16_sse41(const __m128i x, const __m128i lo_table, const __m128i hi_table, const __m128i bits) noexcept
+        {
+            const auto lo = _mm_and_si128(x, _mm_set1_epi8(0x0F));
+            const auto hi = _mm_and_si128(_mm_srli_epi16(x, 4), _mm_set1_epi8(0x0F));
+            // the top bit of a byte selects the table of the high nibbles 8-15
+            const auto row = _mm_blendv_epi8(_mm_shuffle_epi8(lo_table, lo), _mm_shuffle_epi8(hi_table, lo), x);
+            const auto bit = _mm_shuffle_epi8(bits, hi);
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row, bit), bit)));
+        }
+
+        __attribute__((target("sse4.1")))
+        size_t find_first_of_sse41(const uint8_t *data, const size_t size, const nibble_tables &t, size_t &done) noexcept
+        {
+            const auto lo_table = _mm_load_si128(reinterpret_cast<const __m128i *>(t.lo_table.data()));
+            const auto hi_table = _mm_load_si128(reinterpret_cast<const __m128i *>(t.hi_table.data()));
+            const auto bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+            size_t i = 0;
+            for (; i + 16 <= size; i += 16) {
+                const auto mask = match16_sse41(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)), lo_table, hi_table, bits);
+                if (mask)
+                    return i + static_cast<size_t>(std::countr_zero(mask));
+            }
+            done = i;
+            return npos;
+        }
+
+        __attribute__((target("avx2")))
+        size_t find_first_of_avx2(const uint8_t *data, const size_t size, const nibble_tables &t, size_t &done) noexcept
+        {
+            const auto lo_table = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(t.lo_table.data())));
+            const auto hi_table = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(t.hi_table.data())));
+            const auto bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+            const auto nibble_mask = _mm256_set1_epi8(0x0F);
+            size_t i = 0;
+            for (; i + 32 <= size; i += 32) {
+                const auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+                const auto lo = _mm256_and_si256(x, nibble_mask);
+                const auto hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble_mask);
+                const auto row = _mm256_blendv_epi8(_mm256_shuffle_epi8(lo_table, lo), _mm256_shuffle_epi8(hi_table, lo), x);
+                const auto bit = _mm256_shuffle_epi8(bits, hi);
+                const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit)));
+                if (mask)
+                    return i + static_cast<size_t>(std::countr_zero(mask));
+            }
+            if (i + 16 <= size) {
+                const auto mask = match16_sse41(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)),
+                    _mm256_castsi256_si128(lo_table), _mm256_castsi256_si128(hi_table), _mm256_castsi256_si128(bits));
+                if (mask)
+                    return i + static_cast<size_t>(std::countr_zero(mask));
+                i += 16;
+            }
+            done = i;
+            return npos;
+        }
+#endif
+    }
+
+    size_t find(const buffer data, const buffer needle, const isa i) noexcept
+    {
+        if (needle.empty())
+            return 0;
+        if (needle.size() > data.size())
+            return npos;
+        // memchr of the C library is vectorised already
+        if (needle.size() == 1) {
+            const auto *p = static_cast<const uint8_t *>(memchr(data.data(), needle[0], data.size()));
+            return p ? static_cast<size_t>(p - data.data()) : npos;
+        }
+        size_t done = 0;
+        switch (i) {
+#ifdef TURBO_SIMD_X86
+            // 512-bit registers bring no gain over AVX2 here since most time goes to the verification of candidates
+            case isa::avx512:
+            case isa::avx2:
+                if (const auto pos = find_avx2(data.data(), data.size(), needle.data(), needle.size(), done); pos != npos)
+                    return pos;
+                break;
+            case isa::sse41:
+                if (const auto pos = find_sse41(data.data(), data.size(), needle.data(), needle.size(), done); pos != npos)
+                    return pos;
+                break;
+#endif
+            default: break;
+        }
+        return find_scalar(data.data(), data.size(), needle.data(), needle.size(), done);
+    }
+
+    size_t find(const buffer data, const buffer needle) noexcept
+    {
+        return find(data, needle, simd::best_isa());
+    }
+
+    size_t find_first_of(const buffer data, const buffer set, const isa i) noexcept
+    {
+        if (set.empty())
+            return npos;
+        if (set.size() == 1)
+            return find(data, set, i);
+        size_t done = 0;
+        switch (i) {
+#ifdef TURBO_SIMD_X86
+            case isa::avx512:
+            case isa::avx2:
+                if (const auto pos = find_first_of_avx2(data.data(), data.size(), make_nibble_tables(set), done); pos != npos)
+                    return pos;
+                break;
+            case isa::sse41:
+                if (const auto pos = find_first_of_sse41(data.data(), data.size(), make_nibble_tables(set), done); pos != npos)
+                    return pos;
+                break;
+#endif
+            default: break;
+        }
+        if (done == data.size())
+            return npos;
+        std::array<bool, 256> member {};
+        for (const auto b: set)
+            member[b] = true;
+        return find_first_of_scalar(data.data(), data.size(), member, done);
+    }
+
+    size_t find_first_of(const buffer data, const buffer set) noexcept
+    {
+        return find_first_of(data, set, simd::best_isa());
+    }
+}
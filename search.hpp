@@ -0,0 +1,20 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include "bytes.hpp"
+#include "simd.hpp"
+
+namespace turbo::search {
+    using simd::isa;
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // the offset of the first occurrence of needle in data or npos; an empty needle is found at offset 0
+    [[nodiscard]] extern size_t find(buffer data, buffer needle) noexcept;
+    [[nodiscard]] extern size_t find(buffer data, buffer needle, isa i) noexcept;
+
+    // the offset of the first byte of data that is present in set or npos
+    [[nodiscard]] extern size_t find_first_of(buffer data, buffer set) noexcept;
+    [[nodiscard]] extern size_t find_first_of(buffer data, buffer set, isa i) noexcept;
+}
@@ -0,0 +1,78 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <turbo/common/test.hpp>
+#include "search.hpp"
+
+namespace {
+    using namespace turbo;
+
+    size_t reference_find_first_of(const buffer data, const buffer set)
+    {
+        const auto pos = std::string_view { data }.find_first_of(std::string_view { set });
+        return pos == std::string_view::npos ? search::npos : pos;
+    }
+}
+
+suite turbo_common_search_suite = [] {
+    "turbo::common::search"_test = [] {
+        // a small alphabet, so that partial matches of the needles are frequent
+        uint8_vector data(1000);
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<uint8_t>("abcab"[(i * 7 + (i >> 3)) % 5]);
+        const auto isas = { search::isa::scalar, search::isa::sse41, search::isa::avx2, search::isa::avx512 };
+        "find"_test = [&] {
+            const std::string_view hay = static_cast<buffer>(data);
+            for (const auto i: isas) {
+                if (!simd::supported(i))
+                    continue;
+                for (size_t sz = 0; sz <= 200; sz += 7) {
+                    for (size_t needle_sz = 0; needle_sz <= 40; needle_sz += 3) {
+                        const auto in = static_cast<buffer>(data).subbuf(0, sz + 300);
+                        for (size_t off = 0; off + needle_sz <= in.size(); off += 97) {
+                            const auto needle = in.subbuf(off, needle_sz);
+                            expect_equal(hay.substr(0, in.size()).find(std::string_view { needle }), search::find(in, needle, i),
+                                fmt::format("isa {} size {} needle {} at {}", static_cast<int>(i), in.size(), needle_sz, off));
+                        }
+                    }
+                }
+                // a match at the very end is found by the scalar tail of the kernels
+                const std::string tail_data = std::string(100, 'x') + "xyz";
+                expect_equal(100U, search::find(tail_data, std::string_view { "xyz" }, i));
+                expect_equal(search::npos, search::find(tail_data, std::string_view { "xyzx" }, i));
+                expect_equal(0U, search::find(tail_data, buffer {}, i));
+                expect_equal(search::npos, search::find(buffer {}, std::string_view { "x" }, i));
+            }
+        };
+        "find_first_of"_test = [&] {
+            uint8_vector all(256);
+            for (size_t b = 0; b < all.size(); ++b)
+                all[b] = static_cast<uint8_t>(b);
+            for (const auto i: isas) {
+                if (!simd::supported(i))
+                    continue;
+                // each byte value at every position relative to the block boundaries
+                for (size_t pos = 0; pos < 70; pos += 3) {
+                    for (size_t b = 1; b < 256; ++b) {
+                        uint8_vector hay(70, 0);
+                        hay[pos] = static_cast<uint8_t>(b);
+                        const uint8_t set[] { static_cast<uint8_t>(b), static_cast<uint8_t>(b) };
+                        expect_equal(pos, search::find_first_of(hay, buffer { set, 2 }, i), fmt::format("isa {} byte {} at {}", static_cast<int>(i), b, pos));
+                        // the same low nibble with a different high one must not match
+                        const uint8_t other[] { static_cast<uint8_t>(b ^ 0x10), static_cast<uint8_t>(b ^ 0x90) };
+                        if (other[0] != 0 && other[1] != 0)
+                            expect_equal(search::npos, search::find_first_of(hay, buffer { other, 2 }, i));
+                    }
+                }
+                for (size_t sz = 0; sz <= 200; sz += 11) {
+                    for (const std::string_view set: { "", "c", "zc", "cb", "\x01\x7F\x80\xFF", "xyz" }) {
+                        const auto in = static_cast<buffer>(data).subbuf(sz, sz);
+                        expect_equal(reference_find_first_of(in, set), search::find_first_of(in, set, i),
+                            fmt::format("isa {} size {} set {}", static_cast<int>(i), sz, buffer { set }));
+                    }
+                }
+                expect_equal(7U, search::find_first_of(all, static_cast<buffer>(all).subbuf(7), i));
+            }
+        };
+    };
+};
@@ -1,7 +1,8 @@
 #pragma once
 /* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
- * Copyright (c) 2024-2025 R2 Rationality OÜ (info at r2rationality dot com) */
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
 
+#include <array>
 #include <span>
 #include <string>
 #include <string_view>
@@ -35,24 +36,65 @@ namespace turbo::codec {
         explicit variant_index_overrides_t(const std::initializer_list<init_type> o):
             decode_overrides{o}
         {
+            for (size_t i = 0; i < _decode_table.size(); ++i) {
+                _decode_table[i] = i;
+                _encode_table[i] = static_cast<uint8_t>(i);
+            }
             for (const auto &[ci, vi]: decode_overrides) {
                 encode_overrides.try_emplace(vi, ci);
+                _decode_table[ci] = vi;
+            }
+            for (const auto &[vi, ci]: encode_overrides) {
+                if (vi < _encode_table.size())
+                    _encode_table[vi] = ci;
             }
         }
+
+        // The lookups go through the dense tables since the archives call them for every variant value.
+        // The codes and indices without an override map to themselves.
+        [[nodiscard]] size_t decode_index(const uint8_t code) const noexcept
+        {
+            return _decode_table[code];
+        }
+
+        [[nodiscard]] size_t encode_index(const size_t idx) const noexcept
+        {
+            if (idx < _encode_table.size()) [[likely]]
+                return _encode_table[idx];
+            const auto it = encode_overrides.find(idx);
+            return it != encode_overrides.end() ? it->second : idx;
+        }
+    private:
+        std::array<size_t, 256> _decode_table {};
+        std::array<uint8_t, 256> _encode_table {};
     };
 
-    template<typename T, size_t I>
+    // Dispatches through a table of functions built at compile time, one per alternative,
+    // so that the cost does not grow with the index of the requested alternative.
+    template<typename T>
     void variant_set_type(T &val, const size_t requested_type, auto &archive)
     {
-        if (requested_type >= std::variant_size_v<T>) [[unlikely]]
+        using archive_type = std::remove_reference_t<decltype(archive)>;
+        using setter_t = void (*)(T &, archive_type &);
+        static constexpr auto setters = []<size_t... I>(std::index_sequence<I...>) {
+            return std::array<setter_t, sizeof...(I)> {
+                [](T &v, archive_type &a) {
+                    v = codec::from<std::variant_alternative_t<I, T>>(a);
+                }...
+            };
+        }(std::make_index_sequence<std::variant_size_v<T>> {});
+        if (requested_type >= setters.size()) [[unlikely]]
             throw error(fmt::format("an unsupported type value {} for {}", requested_type, typeid(T).name()));
-        if constexpr (I < std::variant_size_v<T>) {
-            if (requested_type > I)
-                return variant_set_type<T, I + 1>(val, requested_type, archive);
-            if (requested_type < I) [[unlikely]]
-                throw error(fmt::format("internal error: an incomplete traversal of type {}", typeid(T).name()));
-            val = codec::from<std::variant_alternative_t<I, T>>(archive);
-        }
+        setters[requested_type](val, archive);
+    }
+
+    // The original interface that searched the alternatives starting from I; kept for the existing callers.
+    template<typename T, size_t I>
+    void variant_set_type(T &val, const size_t requested_type, auto &archive)
+    {
+        if (requested_type < I) [[unlikely]]
+            throw error(fmt::format("internal error: an incomplete traversal of type {}", typeid(T).name()));
+        variant_set_type(val, requested_type, archive);
     }
 
     template<typename T>
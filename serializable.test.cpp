@@ -1,4 +1,4 @@
-/* Copyright (c) 2024-2025 R2 Rationality OÜ (info at r2rationality dot com) */
+/* Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
 
 #include "test.hpp"
 #include "serializable.hpp"
@@ -22,6 +22,22 @@ namespace {
         int val = 0;
     };
 
+    // fills the values with a constant
+    struct constant_archive_t: archive_t {
+        uint32_t val = 0;
+
+        void process(uint32_t &v) const
+        {
+            v = val;
+        }
+
+        void process(point_t &p) const
+        {
+            p.x = val;
+            p.y = val;
+        }
+    };
+
     struct line_t {
         point_t a{};
         point_t b{};
@@ -42,6 +58,33 @@ suite turbo_common_serializable_suite = [] {
             expect(!serializable_c<uint32_t>);
             expect(not_serializable_c<plain_t>);
         };
+        "variant_index_overrides_t"_test = [] {
+            const variant_index_overrides_t o { { 10, 0 }, { 11, 1 }, { 12, 1 } };
+            expect_equal(0U, o.decode_index(10));
+            expect_equal(1U, o.decode_index(12));
+            expect_equal(5U, o.decode_index(5));
+            expect_equal(10U, o.encode_index(0));
+            expect_equal(11U, o.encode_index(1));
+            expect_equal(2U, o.encode_index(2));
+            expect_equal(300U, o.encode_index(300));
+        };
+        "variant_set_type"_test = [] {
+            std::variant<uint32_t, point_t> v {};
+            constant_archive_t a {};
+            a.val = 5;
+            variant_set_type(v, 1, a);
+            expect_equal(1U, v.index());
+            expect_equal(5U, std::get<point_t>(v).y);
+            a.val = 7;
+            variant_set_type(v, 0, a);
+            expect_equal(7U, std::get<uint32_t>(v));
+            expect(throws([&] { variant_set_type(v, 2, a); }));
+            // the explicit starting index of the original interface
+            a.val = 9;
+            variant_set_type<decltype(v), 0>(v, 1, a);
+            expect_equal(9U, std::get<point_t>(v).y);
+            expect(throws([&] { variant_set_type<decltype(v), 1>(v, 0, a); }));
+        };
         "formatter::scalar"_test = [] {
             std::string out{};
             formatter frmtr{ std::back_inserter(out) };
@@ -0,0 +1,159 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <memory>
+#include <ranges>
+#include "file.hpp"
+
+namespace turbo {
+    // An immutable byte sequence sharing an atomically ref-counted owner of its memory.
+    // Copies and slices only bump the reference count and keep the whole owner alive, so a loaded chunk
+    // can be handed to many tasks without copying it and without tracking its lifetime by hand.
+    // The owner can be any movable type owning its memory and exposing data() and size(), such as uint8_vector,
+    // file::mmap_view or file::aligned_buffer.
+    struct shared_bytes {
+        using owner_ptr = std::shared_ptr<const void>;
+
+        // copies the data into a single allocation shared with the reference count
+        static shared_bytes copy(const buffer data)
+        {
+            if (data.empty())
+                return {};
+            std::shared_ptr<uint8_t[]> mem = std::make_shared_for_overwrite<uint8_t[]>(data.size());
+            memcpy(mem.get(), data.data(), data.size());
+            const buffer view { mem.get(), data.size() };
+            return { std::move(mem), view };
+        }
+
+        // maps the whole file into memory; the mapping is released together with the last reference
+        static shared_bytes map(const std::string &path, const file::access_advice advice=file::access_advice::normal)
+        {
+            return shared_bytes { file::mmap_view { path, advice } };
+        }
+
+        shared_bytes() =default;
+
+        // shares the memory owned by owner; data must point into it
+        shared_bytes(owner_ptr owner, const buffer data) noexcept:
+            _owner { std::move(owner) }, _data { data }
+        {
+        }
+
+        // takes over the owner of the memory; views such as buffer, std::span or std::string_view own nothing
+        // and are rejected, since the memory they refer to could be freed while still shared.
+        // The owner's elements must be bytes, since its size() is used as the byte count.
+        template<typename T>
+            requires (!std::is_lvalue_reference_v<T> && !std::is_same_v<std::remove_cvref_t<T>, shared_bytes>
+                && !std::ranges::borrowed_range<T> && requires(const T &t) { t.data(); t.size(); requires sizeof(*t.data()) == 1; })
+        explicit shared_bytes(T &&owner)
+        {
+            auto ptr = std::make_shared<const std::remove_cvref_t<T>>(std::move(owner));
+            _data = buffer { reinterpret_cast<const uint8_t *>(ptr->data()), ptr->size() };
+            _owner = std::move(ptr);
+        }
+
+        [[nodiscard]] const uint8_t *data() const noexcept
+        {
+            return _data.data();
+        }
+
+        [[nodiscard]] size_t size() const noexcept
+        {
+            return _data.size();
+        }
+
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return _data.empty();
+        }
+
+        [[nodiscard]] const owner_ptr &owner() const noexcept
+        {
+            return _owner;
+        }
+
+        // the number of shared_bytes and other holders of the owner; zero for an empty default-constructed instance
+        [[nodiscard]] long use_count() const noexcept
+        {
+            return _owner.use_count();
+        }
+
+        buffer::iterator begin() const noexcept
+        {
+            return _data.begin();
+        }
+
+        buffer::iterator end() const noexcept
+        {
+            return _data.end();
+        }
+
+        const uint8_t &operator[](const size_t i) const noexcept
+        {
+            return _data[i];
+        }
+
+        uint8_t at(const size_t off) const
+        {
+            return _data.at(off);
+        }
+
+        operator buffer() const noexcept
+        {
+            return _data;
+        }
+
+        std::string_view str() const noexcept
+        {
+            return _data;
+        }
+
+        // the slices share the owner, so they stay valid after this instance is gone
+        shared_bytes subbuf(const size_t offset, const size_t sz) const
+        {
+            return { _owner, _data.subbuf(offset, sz) };
+        }
+
+        shared_bytes subbuf(const size_t offset) const
+        {
+            return { _owner, _data.subbuf(offset) };
+        }
+
+        std::strong_ordering operator<=>(const buffer &o) const noexcept
+        {
+            return _data <=> o;
+        }
+
+        std::strong_ordering operator<=>(const shared_bytes &o) const noexcept
+        {
+            return _data <=> o._data;
+        }
+
+        bool operator==(const buffer &o) const noexcept
+        {
+            return _data == o;
+        }
+
+        bool operator==(const shared_bytes &o) const noexcept
+        {
+            return _data == o._data;
+        }
+
+        bool operator==(const uint8_vector &o) const noexcept
+        {
+            return _data == static_cast<buffer>(o);
+        }
+    private:
+        owner_ptr _owner {};
+        buffer _data {};
+    };
+
+    static_assert(std::is_convertible_v<shared_bytes, buffer>);
+}
+
+namespace fmt {
+    template<>
+    struct formatter<turbo::shared_bytes>: formatter<turbo::buffer> {
+    };
+}
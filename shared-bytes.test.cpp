@@ -0,0 +1,105 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <atomic>
+#include <turbo/common/test.hpp>
+#include "buffer-chain.hpp"
+#include "file-direct.hpp"
+#include "scheduler.hpp"
+#include "shared-bytes.hpp"
+
+namespace {
+    using namespace turbo;
+
+    // views do not own their memory, so they cannot become owners
+    static_assert(std::is_constructible_v<shared_bytes, uint8_vector>);
+    static_assert(std::is_constructible_v<shared_bytes, file::mmap_view>);
+    static_assert(!std::is_constructible_v<shared_bytes, buffer>);
+    static_assert(!std::is_constructible_v<shared_bytes, std::span<const uint8_t>>);
+    static_assert(!std::is_constructible_v<shared_bytes, std::string_view>);
+    // size() is the byte count only for owners of bytes
+    static_assert(std::is_constructible_v<shared_bytes, std::string>);
+    static_assert(!std::is_constructible_v<shared_bytes, std::vector<uint32_t>>);
+}
+
+suite turbo_common_shared_bytes_suite = [] {
+    "turbo::common::shared_bytes"_test = [] {
+        "construction"_test = [] {
+            const shared_bytes empty {};
+            expect(empty.empty());
+            expect_equal(0, empty.use_count());
+            const auto expected = test_data(1000, 1);
+            const auto copy = shared_bytes::copy(expected);
+            expect_equal(expected, copy);
+            expect(copy.data() != expected.data());
+            auto data = test_data(1000, 1);
+            const auto *ptr = data.data();
+            const shared_bytes owned { std::move(data) };
+            expect_equal(expected, owned);
+            // takes over the memory without copying it
+            expect(owned.data() == ptr);
+            expect_equal(owned, copy);
+            expect_equal(fmt::format("{}", buffer { expected }), fmt::format("{}", owned));
+        };
+        "subbuf"_test = [] {
+            const auto expected = test_data(1000, 2);
+            shared_bytes sb {};
+            {
+                const auto parent = shared_bytes::copy(expected);
+                sb = parent.subbuf(100, 200);
+                expect(sb.data() == parent.data() + 100);
+                expect_equal(2, parent.use_count());
+            }
+            // the slice keeps the memory of its parent alive
+            expect_equal(1, sb.use_count());
+            expect_equal(static_cast<buffer>(expected).subbuf(100, 200), sb);
+            const auto tail = sb.subbuf(150);
+            expect_equal(static_cast<buffer>(expected).subbuf(250, 50), tail);
+            expect(throws([&] { sb.subbuf(150, 51); }));
+            expect(throws([&] { sb.subbuf(201); }));
+        };
+        "memory-mapped files"_test = [] {
+            const file::tmp tmp { "turbo-shared-bytes.bin" };
+            const auto expected = test_data(5000, 3);
+            file::write(tmp.path(), expected);
+            const auto sb = shared_bytes::map(tmp.path());
+            expect_equal(expected, sb);
+            expect_equal(tmp.path(), std::static_pointer_cast<const file::mmap_view>(sb.owner())->path());
+        };
+        "pooled buffers"_test = [] {
+            file::aligned_buffer_pool pool { 0x1000, 4 };
+            auto buf = pool.acquire();
+            memset(buf.data(), 0xA5, buf.size());
+            const shared_bytes sb { std::move(buf) };
+            expect_equal(0x1000U, sb.size());
+            expect_equal(uint8_vector(0x1000, 0xA5), sb);
+        };
+        "buffer_chain"_test = [] {
+            const auto expected = test_data(1000, 5);
+            const auto sb = shared_bytes::copy(expected);
+            buffer_chain c {};
+            c.append(sb.subbuf(500)).prepend(sb.subbuf(0, 500));
+            expect_equal(expected, c.flatten());
+            // the segments share the memory
+            expect_equal(3, sb.use_count());
+            expect(c.begin()->data.data() == sb.data());
+        };
+        "fan-out to tasks"_test = [] {
+            const auto data = shared_bytes { test_data(0x10000, 4) };
+            std::atomic_size_t num_ok = 0;
+            {
+                scheduler sched { 4 };
+                for (size_t i = 0; i < 64; ++i) {
+                    // each task holds its own slice, so none depends on the lifetime of data
+                    sched.submit("check", 100, [part = data.subbuf(i * 0x400, 0x400), i, &num_ok] {
+                        if (part == static_cast<buffer>(test_data(0x10000, 4)).subbuf(i * 0x400, 0x400))
+                            ++num_ok;
+                    });
+                }
+                sched.process();
+            }
+            expect_equal(64U, num_ok.load());
+            expect_equal(1, data.use_count());
+        };
+    };
+};
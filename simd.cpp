@@ -0,0 +1,33 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include "simd.hpp"
+
+namespace turbo::simd {
+    namespace {
+        isa detect_isa() noexcept
+        {
+#ifdef TURBO_SIMD_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+                return isa::avx512;
+            if (__builtin_cpu_supports("avx2"))
+                return isa::avx2;
+            if (__builtin_cpu_supports("sse4.1"))
+                return isa::sse41;
+#endif
+            return isa::scalar;
+        }
+    }
+
+    isa best_isa() noexcept
+    {
+        static const isa best = detect_isa();
+        return best;
+    }
+
+    bool supported(const isa i) noexcept
+    {
+        return static_cast<int>(i) <= static_cast<int>(best_isa());
+    }
+}
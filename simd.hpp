@@ -0,0 +1,22 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    // the kernels are compiled with per-function target attributes and selected at runtime
+#   define TURBO_SIMD_X86 1
+#endif
+
+namespace turbo::simd {
+    // instruction sets of the vectorised kernels, from the slowest to the fastest
+    enum class isa {
+        scalar,
+        sse41,
+        avx2,
+        avx512
+    };
+
+    // the fastest instruction set supported by the CPU, detected once
+    extern isa best_isa() noexcept;
+    [[nodiscard]] extern bool supported(isa i) noexcept;
+}
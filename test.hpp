@@ -58,6 +58,17 @@ namespace turbo {
         expect(res, loc) << fmt::format("{}: {} != {}", name, x, y);
         return res;
     }
+
+    // deterministic and compressible test data: consecutive uint64_t values i * i + seed truncated to size bytes
+    inline uint8_vector test_data(const size_t size, const uint64_t seed=0)
+    {
+        uint8_vector data {};
+        data.reserve(size + sizeof(uint64_t));
+        for (uint64_t i = 0; data.size() < size; ++i)
+            data << buffer::from(i * i + seed);
+        data.resize(size);
+        return data;
+    }
 }
 
 template <class... Ts>
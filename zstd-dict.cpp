@@ -0,0 +1,148 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+extern "C" {
+#   include <zdict.h>
+};
+#include "zstd-dict.hpp"
+
+namespace turbo::zstd {
+    dictionary dictionary::train(const std::span<const buffer> samples, const size_t max_size, const int level)
+    {
+        uint8_vector sample_data {};
+        std::vector<size_t> sample_sizes {};
+        sample_sizes.reserve(samples.size());
+        for (const auto &s: samples) {
+            sample_data << s;
+            sample_sizes.emplace_back(s.size());
+        }
+        uint8_vector dict_data(max_size);
+        const auto dict_size = ZDICT_trainFromBuffer(dict_data.data(), dict_data.size(), sample_data.data(), sample_sizes.data(), static_cast<unsigned>(sample_sizes.size()));
+        if (ZDICT_isError(dict_size)) [[unlikely]]
+            throw error(fmt::format("zstd: failed to train a dictionary from {} samples: {}", samples.size(), ZDICT_getErrorName(dict_size)));
+        dict_data.resize(dict_size);
+        return dictionary { dict_data, level };
+    }
+
+    dictionary dictionary::load(const std::string &path, const int level)
+    {
+        return dictionary { file::read(path), level };
+    }
+
+    dictionary::dictionary(const buffer dict_data, const int level):
+        _data { dict_data }, _level { level }
+    {
+        _id = ZSTD_getDictID_fromDict(_data.data(), _data.size());
+        if (!_id) [[unlikely]]
+            throw error("zstd: the data does not contain a dictionary with a header");
+        _cdict = ZSTD_createCDict(_data.data(), _data.size(), level);
+        if (!_cdict) [[unlikely]]
+            throw error(fmt::format("zstd: failed to digest the compression dictionary {}", _id));
+        _ddict = ZSTD_createDDict(_data.data(), _data.size());
+        if (!_ddict) [[unlikely]] {
+            ZSTD_freeCDict(_cdict);
+            throw error(fmt::format("zstd: failed to digest the decompression dictionary {}", _id));
+        }
+    }
+
+    dictionary::dictionary(dictionary &&o) noexcept:
+        _data { std::move(o._data) }, _cdict { o._cdict }, _ddict { o._ddict }, _id { o._id }, _level { o._level }
+    {
+        o._cdict = nullptr;
+        o._ddict = nullptr;
+    }
+
+    dictionary::~dictionary()
+    {
+        ZSTD_freeCDict(_cdict);
+        ZSTD_freeDDict(_ddict);
+    }
+
+    void dictionary::save(const std::string &path) const
+    {
+        file::write(path, _data);
+    }
+
+    void dictionary_registry::add(dictionary_ptr dict)
+    {
+        const auto id = dict->id();
+        mutex::scoped_lock lk { _mutex };
+        _dicts.insert_or_assign(id, std::move(dict));
+    }
+
+    dictionary_registry::dictionary_ptr dictionary_registry::find(const uint32_t id) const
+    {
+        mutex::scoped_lock lk { _mutex };
+        if (const auto it = _dicts.find(id); it != _dicts.end())
+            return it->second;
+        return {};
+    }
+
+    void dictionary_registry::decompress(uint8_vector &out, const buffer compressed) const
+    {
+        const auto id = dictionary_id(compressed);
+        if (!id) {
+            zstd::decompress(out, compressed);
+            return;
+        }
+        const auto dict = find(id);
+        if (!dict) [[unlikely]]
+            throw error(fmt::format("zstd: the data requires the unknown dictionary {}", id));
+        zstd::decompress(out, compressed, *dict);
+    }
+
+    uint8_vector dictionary_registry::decompress(const buffer compressed) const
+    {
+        uint8_vector out {};
+        decompress(out, compressed);
+        return out;
+    }
+
+    uint32_t dictionary_id(const buffer compressed)
+    {
+        return ZSTD_getDictID_fromFrame(compressed.data(), compressed.size());
+    }
+
+    void compress(uint8_vector &compressed, const buffer orig, const dictionary &dict)
+    {
+        if (orig.size() > max_zstd_buffer) [[unlikely]]
+            throw error(fmt::format("data size {} is greater than the maximum allowed: {}!", orig.size(), max_zstd_buffer));
+        compressed.resize(ZSTD_compressBound(orig.size()));
+        // the dictionary overrides the parameters of the context, so the level only selects contexts of a similar size
+        const auto ctx = context_pool::get().acquire(compress_params { .level=dict.level() });
+        const auto compressed_size = ZSTD_compress_usingCDict(ctx.get(), compressed.data(), compressed.size(), orig.data(), orig.size(), dict.cdict());
+        if (ZSTD_isError(compressed_size)) [[unlikely]]
+            throw error(fmt::format("zstd compression error: {}", ZSTD_getErrorName(compressed_size)));
+        compressed.resize(compressed_size);
+    }
+
+    uint8_vector compress(const buffer orig, const dictionary &dict)
+    {
+        uint8_vector res {};
+        compress(res, orig, dict);
+        return res;
+    }
+
+    void decompress(uint8_vector &out, const buffer compressed, const dictionary &dict)
+    {
+        if (const auto id = dictionary_id(compressed); id && id != dict.id()) [[unlikely]]
+            throw error(fmt::format("zstd: the data requires dictionary {} but got {}", id, dict.id()));
+        const auto orig_data_size = decompressed_size(compressed);
+        if (orig_data_size > max_zstd_buffer) [[unlikely]]
+            throw error(fmt::format("recorded original data size {} is greater than the maximum allowed: {}!", orig_data_size, max_zstd_buffer));
+        out.resize(orig_data_size);
+        thread_local decompress_context ctx {};
+        const auto actual_size = ZSTD_decompress_usingDDict(ctx.get(), out.data(), out.size(), compressed.data(), compressed.size(), dict.ddict());
+        if (ZSTD_isError(actual_size)) [[unlikely]]
+            throw error(fmt::format("zstd decompression error: {}", ZSTD_getErrorName(actual_size)));
+        if (actual_size != out.size()) [[unlikely]]
+            throw error(fmt::format("Internal error: decompressed size {} != expected output size {}!", actual_size, out.size()));
+    }
+
+    uint8_vector decompress(const buffer compressed, const dictionary &dict)
+    {
+        uint8_vector out {};
+        decompress(out, compressed, dict);
+        return out;
+    }
+}
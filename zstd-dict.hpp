@@ -0,0 +1,82 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <map>
+#include <memory>
+#include <span>
+#include "mutex.hpp"
+#include "zstd.hpp"
+
+namespace turbo::zstd {
+    // A trained dictionary digested once into ZSTD_CDict and ZSTD_DDict so that compressing small records
+    // does not pay for loading it on every call. The compression level is fixed when the dictionary is digested.
+    struct dictionary {
+        static constexpr size_t default_max_size = 112'640;
+
+        // samples should be representative records; zstd needs at least a few hundred of them to train well
+        static dictionary train(std::span<const buffer> samples, size_t max_size=default_max_size, int level=3);
+        static dictionary load(const std::string &path, int level=3);
+
+        explicit dictionary(buffer dict_data, int level=3);
+        dictionary(dictionary &&o) noexcept;
+        dictionary(const dictionary &) =delete;
+        ~dictionary();
+
+        void save(const std::string &path) const;
+
+        // the id that compressed frames record in their headers
+        [[nodiscard]] uint32_t id() const noexcept
+        {
+            return _id;
+        }
+
+        [[nodiscard]] int level() const noexcept
+        {
+            return _level;
+        }
+
+        [[nodiscard]] buffer data() const noexcept
+        {
+            return _data;
+        }
+
+        [[nodiscard]] const ZSTD_CDict *cdict() const noexcept
+        {
+            return _cdict;
+        }
+
+        [[nodiscard]] const ZSTD_DDict *ddict() const noexcept
+        {
+            return _ddict;
+        }
+    private:
+        uint8_vector _data;
+        ZSTD_CDict *_cdict = nullptr;
+        ZSTD_DDict *_ddict = nullptr;
+        uint32_t _id = 0;
+        int _level;
+    };
+
+    // Keeps the known dictionaries and picks the right one for a frame by the dictionary id in its header.
+    struct dictionary_registry {
+        using dictionary_ptr = std::shared_ptr<const dictionary>;
+
+        void add(dictionary_ptr dict);
+        // nullptr when the id is not known
+        [[nodiscard]] dictionary_ptr find(uint32_t id) const;
+        // frames compressed without a dictionary are decompressed as usual
+        void decompress(uint8_vector &out, buffer compressed) const;
+        uint8_vector decompress(buffer compressed) const;
+    private:
+        mutable mutex::unique_lock::mutex_type _mutex alignas(mutex::alignment) {};
+        std::map<uint32_t, dictionary_ptr> _dicts {};
+    };
+
+    // zero if the frame was compressed without a dictionary
+    extern uint32_t dictionary_id(buffer compressed);
+    extern void compress(uint8_vector &compressed, buffer orig, const dictionary &dict);
+    extern uint8_vector compress(buffer orig, const dictionary &dict);
+    extern void decompress(uint8_vector &out, buffer compressed, const dictionary &dict);
+    extern uint8_vector decompress(buffer compressed, const dictionary &dict);
+}
@@ -0,0 +1,73 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <turbo/common/test.hpp>
+#include "zstd-dict.hpp"
+
+namespace {
+    using namespace turbo;
+
+    std::vector<uint8_vector> make_records(const size_t num_records)
+    {
+        std::vector<uint8_vector> records {};
+        for (size_t i = 0; i < num_records; ++i) {
+            records.emplace_back(uint8_vector { std::string_view { fmt::format(
+                R"({{"slot":{},"hash":"{:016X}{:016X}","inputs":[{{"tx":"{:08x}","idx":{}}}],"outputs":[{{"address":"addr1q{:x}","amount":{}}}],"fee":{}}})",
+                i * 20, i * 0x9E3779B97F4A7C15ULL, ~i * 0xC2B2AE3D27D4EB4FULL, i * 7919, i % 5, i * 104729, i * 1'000'003 % 45'000'000, 150'000 + i % 1000) } });
+        }
+        return records;
+    }
+}
+
+suite turbo_common_zstd_dict_suite = [] {
+    "turbo::common::zstd_dict"_test = [] {
+        const auto records = make_records(2000);
+        const std::vector<buffer> samples(records.begin(), records.end());
+        const auto dict = zstd::dictionary::train(samples, 16 << 10, 3);
+        "train"_test = [&] {
+            expect(dict.id() != 0_u);
+            expect(dict.data().size() <= 16_ull << 10);
+            expect(dict.cdict() != nullptr);
+            expect(dict.ddict() != nullptr);
+        };
+        "round trip"_test = [&] {
+            uint64_t plain_size = 0;
+            uint64_t dict_size = 0;
+            for (const auto &r: records) {
+                const auto compressed = zstd::compress(r, dict);
+                expect_equal(dict.id(), zstd::dictionary_id(compressed));
+                expect_equal(r, zstd::decompress(compressed, dict));
+                dict_size += compressed.size();
+                plain_size += zstd::compress(r, 3).size();
+            }
+            expect(dict_size < plain_size) << dict_size << plain_size;
+        };
+        "save and load"_test = [&] {
+            const file::tmp tmp_f { "turbo-zstd-dict-test.dict" };
+            dict.save(tmp_f.path());
+            const auto loaded = zstd::dictionary::load(tmp_f.path(), 3);
+            expect_equal(dict.id(), loaded.id());
+            expect_equal(records[5], zstd::decompress(zstd::compress(records[5], dict), loaded));
+        };
+        "registry"_test = [&] {
+            zstd::dictionary_registry reg {};
+            expect(!reg.find(dict.id()));
+            reg.add(std::make_shared<zstd::dictionary>(dict.data(), 3));
+            expect(static_cast<bool>(reg.find(dict.id())));
+            expect_equal(records[7], reg.decompress(zstd::compress(records[7], dict)));
+            // frames without a dictionary go through the regular path
+            expect_equal(0U, zstd::dictionary_id(zstd::compress(records[7], 3)));
+            expect_equal(records[7], reg.decompress(zstd::compress(records[7], 3)));
+        };
+        "errors"_test = [&] {
+            expect(throws([] { zstd::dictionary { uint8_vector(100, 0x11) }; }));
+            const std::vector<buffer> few(samples.begin(), samples.begin() + 2);
+            expect(throws([&] { zstd::dictionary::train(few, 16 << 10); }));
+            const zstd::dictionary_registry reg {};
+            expect(throws([&] { reg.decompress(zstd::compress(records[0], dict)); }));
+            const auto other = zstd::dictionary::train(samples, 8 << 10, 3);
+            expect(other.id() != dict.id());
+            expect(throws([&] { zstd::decompress(zstd::compress(records[0], dict), other); }));
+        };
+    };
+};
@@ -0,0 +1,201 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <condition_variable>
+#include <cstring>
+#include <utility>
+#include "logger.hpp"
+#include "zstd-parallel.hpp"
+#include "zstd-stream.hpp"
+
+namespace turbo::zstd {
+    namespace {
+        struct frame_info {
+            uint64_t in_offset;
+            uint64_t in_size;
+            uint64_t out_offset;
+            uint64_t out_size;
+        };
+
+        bool is_skippable(const buffer frame)
+        {
+            if (frame.size() < sizeof(uint32_t))
+                return false;
+            uint32_t magic;
+            memcpy(&magic, frame.data(), sizeof(magic));
+            return (magic & ZSTD_MAGIC_SKIPPABLE_MASK) == ZSTD_MAGIC_SKIPPABLE_START;
+        }
+    }
+
+    struct parallel_runner::state_t {
+        // executes the next task not yet taken by another thread; returns false when there are none left
+        // or some task has already failed, since the result is going to be discarded then
+        bool run_next()
+        {
+            std::function<void()> task {};
+            {
+                mutex::scoped_lock lk { _mutex };
+                if (_err || _next >= _tasks.size())
+                    return false;
+                task = std::move(_tasks[_next++]);
+                ++_active;
+            }
+            try {
+                task();
+            } catch (...) {
+                mutex::scoped_lock lk { _mutex };
+                if (!_err)
+                    _err = std::current_exception();
+            }
+            // the captures are released before the waiting caller may return
+            task = {};
+            {
+                mutex::scoped_lock lk { _mutex };
+                --_active;
+            }
+            _active_cv.notify_all();
+            return true;
+        }
+
+        void add(const std::function<void()> &task)
+        {
+            mutex::scoped_lock lk { _mutex };
+            _tasks.emplace_back(task);
+        }
+
+        // prevents the tasks not yet started from ever running and waits for the ones being executed
+        std::exception_ptr finish()
+        {
+            mutex::unique_lock lk { _mutex };
+            _next = _tasks.size();
+            _active_cv.wait(lk, [&] { return _active == 0; });
+            _tasks.clear();
+            return std::exchange(_err, {});
+        }
+    private:
+        mutex::unique_lock::mutex_type _mutex alignas(mutex::alignment) {};
+        std::condition_variable_any _active_cv {};
+        std::vector<std::function<void()>> _tasks {};
+        size_t _next = 0;
+        size_t _active = 0;
+        std::exception_ptr _err {};
+    };
+
+    parallel_runner::parallel_runner(scheduler &sched, std::string task_group):
+        _sched { sched }, _task_group { std::move(task_group) }, _state { std::make_shared<state_t>() }
+    {
+    }
+
+    parallel_runner::~parallel_runner()
+    {
+        // the tasks may refer to the stack frame of the caller, which is about to be destroyed
+        logger::run_log_errors([&] {
+            _state->finish();
+        });
+    }
+
+    void parallel_runner::submit(const int64_t priority, const std::function<void()> &task)
+    {
+        _state->add(task);
+        // a single-worker scheduler executes its tasks only within process(), so run() executes them all itself
+        if (_sched.num_workers() == 1)
+            return;
+        // each scheduler task executes whichever of the runner's tasks is next, if any is still left by then
+        _sched.submit(_task_group, priority, [state=_state] {
+            state->run_next();
+        });
+    }
+
+    void parallel_runner::run()
+    {
+        while (_state->run_next()) {
+        }
+        if (const auto err = _state->finish(); err) [[unlikely]]
+            std::rethrow_exception(err);
+    }
+
+    void compress_parallel(uint8_vector &out, const buffer orig, const int level, scheduler &sched, const size_t frame_size)
+    {
+        if (frame_size == 0) [[unlikely]]
+            throw error("the frame size must be greater than zero!");
+        const auto num_frames = std::max(size_t { 1 }, (orig.size() + frame_size - 1) / frame_size);
+        const auto slot_size = ZSTD_compressBound(std::min(frame_size, orig.size()));
+        // each frame is compressed into its own slot, and the slots are compacted afterwards
+        out.resize(slot_size * num_frames);
+        std::vector<size_t> sizes(num_frames);
+        parallel_runner runner { sched, "zstd:compress-frame" };
+        for (size_t i = 0; i < num_frames; ++i) {
+            runner.submit(static_cast<int64_t>(num_frames - i), [&, i] {
+                const auto in = orig.subbuf(i * frame_size, std::min(frame_size, orig.size() - i * frame_size));
+                const auto ctx = context_pool::get().acquire(compress_params { .level=level });
+                const auto res = ZSTD_compress2(ctx.get(), out.data() + i * slot_size, slot_size, in.data(), in.size());
+                if (ZSTD_isError(res)) [[unlikely]]
+                    throw error(fmt::format("zstd compression error: {}", ZSTD_getErrorName(res)));
+                sizes[i] = res;
+            });
+        }
+        runner.run();
+        size_t out_size = sizes[0];
+        for (size_t i = 1; i < num_frames; ++i) {
+            memmove(out.data() + out_size, out.data() + i * slot_size, sizes[i]);
+            out_size += sizes[i];
+        }
+        out.resize(out_size);
+    }
+
+    uint8_vector compress_parallel(const buffer orig, const int level, scheduler &sched, const size_t frame_size)
+    {
+        uint8_vector out {};
+        compress_parallel(out, orig, level, sched, frame_size);
+        return out;
+    }
+
+    void decompress_parallel(uint8_vector &out, const buffer compressed, scheduler &sched, const size_t max_buffer)
+    {
+        std::vector<frame_info> frames {};
+        uint64_t out_size = 0;
+        for (uint64_t off = 0; off < compressed.size(); ) {
+            const auto rest = compressed.subbuf(off);
+            const auto in_size = ZSTD_findFrameCompressedSize(rest.data(), rest.size());
+            if (ZSTD_isError(in_size)) [[unlikely]]
+                throw error(fmt::format("zstd: invalid frame at offset {}: {}", off, ZSTD_getErrorName(in_size)));
+            if (!is_skippable(rest)) {
+                const auto content_size = ZSTD_getFrameContentSize(rest.data(), rest.size());
+                if (content_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+                    // the limit can be checked only while decompressing
+                    out = decompress_all(compressed, max_buffer);
+                    return;
+                }
+                if (content_size == ZSTD_CONTENTSIZE_ERROR) [[unlikely]]
+                    throw error(fmt::format("zstd: could not extract the content size of the frame at offset {}", off));
+                frames.emplace_back(off, in_size, out_size, content_size);
+                out_size += content_size;
+                if (out_size > max_buffer) [[unlikely]]
+                    throw error(fmt::format("recorded original data size {} is greater than the maximum allowed: {}!", out_size, max_buffer));
+            }
+            off += in_size;
+        }
+        out.resize(out_size);
+        parallel_runner runner { sched, "zstd:decompress-frame" };
+        for (size_t i = 0; i < frames.size(); ++i) {
+            runner.submit(static_cast<int64_t>(frames.size() - i), [&, i] {
+                const auto &f = frames[i];
+                thread_local decompress_context ctx {};
+                ctx.reset();
+                const auto res = ZSTD_decompressDCtx(ctx.get(), out.data() + f.out_offset, f.out_size, compressed.data() + f.in_offset, f.in_size);
+                if (ZSTD_isError(res)) [[unlikely]]
+                    throw error(fmt::format("zstd decompression error: {}", ZSTD_getErrorName(res)));
+                if (res != f.out_size) [[unlikely]]
+                    throw error(fmt::format("zstd: the frame at offset {} decompressed into {} bytes instead of recorded {}", f.in_offset, res, f.out_size));
+            });
+        }
+        runner.run();
+    }
+
+    uint8_vector decompress_parallel(const buffer compressed, scheduler &sched)
+    {
+        uint8_vector out {};
+        decompress_parallel(out, compressed, sched);
+        return out;
+    }
+}
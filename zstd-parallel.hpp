@@ -0,0 +1,50 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <exception>
+#include <memory>
+#include "mutex.hpp"
+#include "scheduler.hpp"
+#include "zstd.hpp"
+
+namespace turbo::zstd {
+    static constexpr size_t default_frame_size = size_t { 1 } << 22U;
+
+    // Runs per-frame tasks on a scheduler and rethrows the first of their errors with its original message
+    // instead of the scheduler's generic one. run() waits only for the runner's own tasks and executes the ones
+    // not yet taken by the workers itself, so concurrent runners may share a scheduler and a runner may be used
+    // from within a task of the same scheduler. Neither run() nor the destructor returns while a task is executing,
+    // and the tasks not started by then are never executed, so the tasks may safely refer to the caller's stack.
+    struct parallel_runner {
+        explicit parallel_runner(scheduler &sched, std::string task_group);
+        ~parallel_runner();
+        parallel_runner(const parallel_runner &) =delete;
+        parallel_runner &operator=(const parallel_runner &) =delete;
+        void submit(int64_t priority, const std::function<void()> &task);
+        void run();
+    private:
+        struct state_t;
+        scheduler &_sched;
+        const std::string _task_group;
+        // shared with the submitted scheduler tasks, which may outlive the runner
+        std::shared_ptr<state_t> _state;
+    };
+
+    // Splits the data into independent frames of frame_size bytes, compresses them on the scheduler's workers,
+    // and concatenates them into a valid multi-frame stream that any zstd decoder accepts. Each frame records
+    // its content size, which is what allows decompress_parallel to process the frames concurrently.
+    // May be called concurrently and from within a task of the same scheduler.
+    extern void compress_parallel(uint8_vector &out, buffer orig, int level=22, scheduler &sched=scheduler::get(),
+        size_t frame_size=default_frame_size);
+    extern uint8_vector compress_parallel(buffer orig, int level=22, scheduler &sched=scheduler::get(),
+        size_t frame_size=default_frame_size);
+
+    // Decompresses a sequence of frames, each on its own scheduler task. Skippable frames are ignored.
+    // Falls back to sequential streaming decompression when some frame does not record its content size,
+    // in which case max_buffer is enforced as the output is produced.
+    // The same as compress_parallel, may be called concurrently and from within a task of the same scheduler.
+    extern void decompress_parallel(uint8_vector &out, buffer compressed, scheduler &sched=scheduler::get(),
+        size_t max_buffer=max_zstd_buffer);
+    extern uint8_vector decompress_parallel(buffer compressed, scheduler &sched=scheduler::get());
+}
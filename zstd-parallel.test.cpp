@@ -0,0 +1,122 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <thread>
+#include <turbo/common/test.hpp>
+#include "zstd-parallel.hpp"
+#include "zstd-stream.hpp"
+
+using namespace turbo;
+
+suite turbo_common_zstd_parallel_suite = [] {
+    "turbo::common::zstd_parallel"_test = [] {
+        const auto data = test_data(8'000'000);
+        scheduler sched { 4 };
+        "round trip"_test = [&] {
+            const auto compressed = zstd::compress_parallel(data, 1, sched, 1 << 20);
+            expect_equal(data, zstd::decompress_parallel(compressed, sched));
+            // the output is a regular multi-frame stream
+            expect_equal(data, zstd::decompress_all(compressed));
+            expect_equal(static_cast<uint64_t>(1 << 20), zstd::decompressed_size(compressed));
+        };
+        "single worker"_test = [&] {
+            scheduler sched1 { 1 };
+            const auto compressed = zstd::compress_parallel(data, 1, sched1, 100'001);
+            expect_equal(data, zstd::decompress_parallel(compressed, sched1));
+        };
+        "small and empty"_test = [&] {
+            const uint8_vector small { std::string_view { "some text" } };
+            expect_equal(small, zstd::decompress_parallel(zstd::compress_parallel(small, 3, sched), sched));
+            const uint8_vector empty {};
+            const auto compressed = zstd::compress_parallel(empty, 3, sched);
+            expect(compressed.size() > 0_ull);
+            expect(zstd::decompress_parallel(compressed, sched).empty());
+        };
+        "sequential frames"_test = [&] {
+            // frames produced by the regular compress and concatenated by hand
+            uint8_vector compressed {};
+            compressed << zstd::compress(static_cast<buffer>(data).subbuf(0, 1000), 1);
+            compressed << zstd::compress(static_cast<buffer>(data).subbuf(1000), 1);
+            expect_equal(data, zstd::decompress_parallel(compressed, sched));
+        };
+        "unknown content size"_test = [&] {
+            uint8_vector compressed {};
+            {
+                zstd::compress_stream cs { [&](const buffer chunk) { compressed << chunk; }, 1 };
+                cs.write(static_cast<buffer>(data).subbuf(0, 1000));
+                cs.flush();
+                cs.write(static_cast<buffer>(data).subbuf(1000));
+            }
+            expect(throws([&] { zstd::decompressed_size(compressed); }));
+            expect_equal(data, zstd::decompress_parallel(compressed, sched));
+            // the limit applies even though the frames do not record their sizes
+            uint8_vector out {};
+            expect(throws([&] { zstd::decompress_parallel(out, compressed, sched, data.size() - 1); }));
+            zstd::decompress_parallel(out, compressed, sched, data.size());
+            expect_equal(data, out);
+            uint8_vector bomb {};
+            {
+                zstd::compress_stream cs { [&](const buffer chunk) { bomb << chunk; }, 1 };
+                cs.write(uint8_vector(1 << 20, 0));
+            }
+            expect(bomb.size() < 1000U);
+            expect(throws([&] { zstd::decompress_parallel(out, bomb, sched, 1000); }));
+        };
+        "concurrent callers"_test = [&] {
+            // the callers share the scheduler and each waits only for its own frames
+            std::atomic_size_t num_ok = 0;
+            std::vector<std::thread> threads {};
+            for (size_t t = 0; t < 4; ++t) {
+                threads.emplace_back([&] {
+                    for (size_t i = 0; i < 8; ++i) {
+                        const auto compressed = zstd::compress_parallel(static_cast<buffer>(data).subbuf(0, 300'000), 1, sched, 10'000);
+                        if (zstd::decompress_parallel(compressed, sched) == static_cast<buffer>(data).subbuf(0, 300'000))
+                            num_ok.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+            }
+            for (auto &th: threads)
+                th.join();
+            expect_equal(size_t { 32 }, num_ok.load());
+        };
+        "within a task"_test = [&] {
+            uint8_vector compressed {};
+            sched.submit("compress-in-task", 0, [&] {
+                compressed = zstd::compress_parallel(data, 1, sched, 100'000);
+            });
+            sched.process(false);
+            expect_equal(data, zstd::decompress_parallel(compressed, sched));
+        };
+        "a failure leaves no tasks behind"_test = [&] {
+            // the failing frame is the first one, so most of the others have not been started when run() throws
+            std::atomic_size_t num_started = 0;
+            {
+                zstd::parallel_runner runner { sched, "test:runner" };
+                for (size_t i = 0; i < 1000; ++i) {
+                    runner.submit(0, [&, i] {
+                        num_started.fetch_add(1, std::memory_order_relaxed);
+                        if (i == 0)
+                            throw error("the first task failed");
+                        std::this_thread::sleep_for(std::chrono::milliseconds { 1 });
+                    });
+                }
+                expect(throws([&] { runner.run(); }));
+            }
+            const auto started = num_started.load();
+            expect(started < 1000_ull);
+            sched.process(false);
+            expect_equal(started, num_started.load());
+        };
+        "errors"_test = [&] {
+            auto compressed = zstd::compress_parallel(data, 1, sched, 1 << 20);
+            compressed.resize(compressed.size() - 1);
+            expect(throws([&] { zstd::decompress_parallel(compressed, sched); }));
+            compressed = zstd::compress_parallel(data, 1, sched, 1 << 20);
+            compressed << std::string_view { "not a zstd frame" };
+            expect(throws([&] { zstd::decompress_parallel(compressed, sched); }));
+            uint8_vector out {};
+            expect(throws([&] { zstd::decompress_parallel(out, zstd::compress_parallel(data, 1, sched), sched, 1000); }));
+            expect(throws([&] { zstd::compress_parallel(data, 1, sched, 0); }));
+        };
+    };
+};
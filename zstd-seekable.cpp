@@ -0,0 +1,250 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <algorithm>
+#include <cstring>
+#include "logger.hpp"
+#include "zstd-seekable.hpp"
+
+namespace turbo::zstd {
+    namespace {
+        static constexpr uint32_t seek_table_magic = 0x184D2A5EU;
+        static constexpr uint32_t seekable_magic = 0x8F92EAB1U;
+        static constexpr size_t skippable_header_size = 8;
+        // number of frames, descriptor, seekable magic
+        static constexpr size_t seek_table_footer_size = 9;
+        static constexpr uint8_t checksum_flag = 0x80;
+        static constexpr uint8_t reserved_bits = 0x7C;
+        // the format limits the decompressed size of a frame
+        static constexpr size_t max_frame_size = size_t { 1 } << 30U;
+
+        void append_u32(uint8_vector &out, const uint32_t val)
+        {
+            // the format is little-endian, which is what all supported platforms use
+            out << buffer::from(val);
+        }
+
+        uint32_t read_u32(const buffer data, const size_t offset)
+        {
+            uint32_t val;
+            memcpy(&val, data.subbuf(offset, sizeof(val)).data(), sizeof(val));
+            return val;
+        }
+
+        void check_frame_size(const size_t frame_size)
+        {
+            if (frame_size == 0 || frame_size > max_frame_size) [[unlikely]]
+                throw error(fmt::format("the frame size of a seekable file must be between 1 and {} but got {}", max_frame_size, frame_size));
+        }
+
+        // validates the arguments before the temporary file is created, so that invalid ones leave nothing behind
+        std::string checked_tmp_path(const std::string &path, const size_t frame_size)
+        {
+            check_frame_size(frame_size);
+            return fmt::format("{}.tmp", path);
+        }
+
+        void append_entry(uint8_vector &seek_table, const size_t compressed_size, const size_t size)
+        {
+            if (compressed_size > std::numeric_limits<uint32_t>::max()) [[unlikely]]
+                throw error(fmt::format("a compressed frame of {} bytes does not fit the seek table", compressed_size));
+            append_u32(seek_table, static_cast<uint32_t>(compressed_size));
+            append_u32(seek_table, static_cast<uint32_t>(size));
+        }
+
+        void append_seek_table(uint8_vector &out, const buffer entries, const uint32_t num_frames)
+        {
+            append_u32(out, seek_table_magic);
+            append_u32(out, static_cast<uint32_t>(entries.size() + seek_table_footer_size));
+            out << entries;
+            append_u32(out, num_frames);
+            out << uint8_t { 0 };
+            append_u32(out, seekable_magic);
+        }
+    }
+
+    seekable_writer::seekable_writer(const std::string &path, const int level, const size_t frame_size):
+        _path { path }, _tmp_path { checked_tmp_path(path, frame_size) }, _os { _tmp_path }, _level { level }, _frame_size { frame_size }
+    {
+        _frame.reserve(_frame_size);
+    }
+
+    seekable_writer::~seekable_writer()
+    {
+        if (!_finished) {
+            logger::run_log_errors([&] {
+                _os.close();
+                std::filesystem::remove(_tmp_path);
+            });
+        }
+    }
+
+    void seekable_writer::write(buffer data)
+    {
+        if (_finished) [[unlikely]]
+            throw error(fmt::format("seekable file {} has already been finished", _path));
+        while (!data.empty()) {
+            const auto num_bytes = std::min(data.size(), _frame_size - _frame.size());
+            _frame << data.subbuf(0, num_bytes);
+            data = data.subbuf(num_bytes);
+            if (_frame.size() == _frame_size)
+                _write_frame();
+        }
+    }
+
+    void seekable_writer::finish()
+    {
+        if (_finished)
+            return;
+        if (!_frame.empty())
+            _write_frame();
+        uint8_vector tail {};
+        append_seek_table(tail, _seek_table, _num_frames);
+        _os.write(tail);
+        _os.close();
+        std::filesystem::rename(_tmp_path, _path);
+        // a failure above leaves the temporary file to the destructor
+        _finished = true;
+    }
+
+    void seekable_writer::_write_frame()
+    {
+        compress(_compressed, _frame, _level);
+        _os.write(_compressed);
+        append_entry(_seek_table, _compressed.size(), _frame.size());
+        ++_num_frames;
+        _frame.clear();
+    }
+
+    void write_seekable(const std::string &path, const buffer data, const int level, scheduler &sched, const size_t frame_size)
+    {
+        check_frame_size(frame_size);
+        uint8_vector out {};
+        compress_parallel(out, data, level, sched, frame_size);
+        uint8_vector entries {};
+        uint32_t num_frames = 0;
+        for (size_t off = 0, data_off = 0; off < out.size(); ++num_frames) {
+            const auto frame_compressed_size = zstd::frame_size(static_cast<buffer>(out).subbuf(off));
+            const auto frame_data_size = std::min(frame_size, data.size() - data_off);
+            append_entry(entries, frame_compressed_size, frame_data_size);
+            off += frame_compressed_size;
+            data_off += frame_data_size;
+        }
+        append_seek_table(out, entries, num_frames);
+        file::write(path, out);
+    }
+
+    seekable_reader::seekable_reader(const std::string &path):
+        _mmap { std::in_place, path, file::access_advice::random }, _data { *_mmap }
+    {
+        _parse();
+    }
+
+    seekable_reader::seekable_reader(const buffer data):
+        _data { data }
+    {
+        _parse();
+    }
+
+    void seekable_reader::_parse()
+    {
+        if (_data.size() < skippable_header_size + seek_table_footer_size) [[unlikely]]
+            throw error(fmt::format("the data of {} bytes is too small to be a seekable zstd file", _data.size()));
+        const auto footer_off = _data.size() - seek_table_footer_size;
+        if (read_u32(_data, footer_off + 5) != seekable_magic) [[unlikely]]
+            throw error("the data does not end with a zstd seek table");
+        const auto num_frames = read_u32(_data, footer_off);
+        const auto descriptor = _data[footer_off + 4];
+        if (descriptor & reserved_bits) [[unlikely]]
+            throw error(fmt::format("the seek table descriptor has reserved bits set: {:02X}", descriptor));
+        const size_t entry_size = descriptor & checksum_flag ? 12 : 8;
+        const auto entries_size = static_cast<uint64_t>(num_frames) * entry_size;
+        if (entries_size > footer_off - skippable_header_size) [[unlikely]]
+            throw error(fmt::format("the seek table with {} frames does not fit the data", num_frames));
+        const auto table_off = footer_off - entries_size - skippable_header_size;
+        if (read_u32(_data, table_off) != seek_table_magic || read_u32(_data, table_off + 4) != entries_size + seek_table_footer_size) [[unlikely]]
+            throw error("the zstd seek table has an invalid header");
+        _frames.reserve(num_frames);
+        uint64_t compressed_offset = 0;
+        for (size_t i = 0; i < num_frames; ++i) {
+            const auto entry_off = table_off + skippable_header_size + i * entry_size;
+            // the optional checksums are not verified, the frames are validated by zstd itself
+            auto &f = _frames.emplace_back(compressed_offset, _size, read_u32(_data, entry_off), read_u32(_data, entry_off + 4));
+            compressed_offset += f.compressed_size;
+            _size += f.size;
+        }
+        if (compressed_offset != table_off) [[unlikely]]
+            throw error(fmt::format("the seek table describes {} bytes of frames but the data has {}", compressed_offset, table_off));
+    }
+
+    size_t seekable_reader::_first_frame(const uint64_t offset, const size_t num_bytes) const
+    {
+        if (offset > _size || num_bytes > _size - offset) [[unlikely]]
+            throw error(fmt::format("the requested range at offset {} of {} bytes ends past the data size {}", offset, num_bytes, _size));
+        // the last frame starting at or before the offset
+        const auto it = std::upper_bound(_frames.begin(), _frames.end(), offset, [](const uint64_t off, const frame &f) {
+            return off < f.offset;
+        });
+        return static_cast<size_t>(it - _frames.begin()) - 1;
+    }
+
+    void seekable_reader::_read_frame(const frame &f, const uint64_t offset, const write_buffer out) const
+    {
+        const auto compressed = _data.subbuf(f.compressed_offset, f.compressed_size);
+        thread_local decompress_context ctx {};
+        // whole frames are decompressed straight into the output
+        if (offset == f.offset && out.size() == f.size) {
+            ctx.reset();
+            const auto res = ZSTD_decompressDCtx(ctx.get(), out.data(), out.size(), compressed.data(), compressed.size());
+            if (ZSTD_isError(res)) [[unlikely]]
+                throw error(fmt::format("zstd decompression error: {}", ZSTD_getErrorName(res)));
+            if (res != f.size) [[unlikely]]
+                throw error(fmt::format("the frame at offset {} decompressed into {} bytes instead of {}", f.compressed_offset, res, f.size));
+            return;
+        }
+        thread_local uint8_vector frame_data {};
+        frame_data.resize(f.size);
+        _read_frame(f, f.offset, frame_data);
+        memcpy(out.data(), frame_data.data() + (offset - f.offset), out.size());
+    }
+
+    void seekable_reader::read(uint64_t offset, const write_buffer out) const
+    {
+        for (size_t i = _first_frame(offset, out.size()), out_off = 0; out_off < out.size(); ++i) {
+            const auto &f = _frames[i];
+            const auto num_bytes = std::min(out.size() - out_off, static_cast<size_t>(f.offset + f.size - offset));
+            _read_frame(f, offset, write_buffer { out.data() + out_off, num_bytes });
+            out_off += num_bytes;
+            offset += num_bytes;
+        }
+    }
+
+    void seekable_reader::read(uint64_t offset, const write_buffer out, scheduler &sched) const
+    {
+        parallel_runner runner { sched, "zstd:seekable-read" };
+        for (size_t i = _first_frame(offset, out.size()), out_off = 0; out_off < out.size(); ++i) {
+            const auto &f = _frames[i];
+            const auto num_bytes = std::min(out.size() - out_off, static_cast<size_t>(f.offset + f.size - offset));
+            runner.submit(-static_cast<int64_t>(i), [this, &f, offset, frame_out=write_buffer { out.data() + out_off, num_bytes }] {
+                _read_frame(f, offset, frame_out);
+            });
+            out_off += num_bytes;
+            offset += num_bytes;
+        }
+        runner.run();
+    }
+
+    uint8_vector seekable_reader::read(const uint64_t offset, const size_t num_bytes) const
+    {
+        uint8_vector out(num_bytes);
+        read(offset, out);
+        return out;
+    }
+
+    uint8_vector seekable_reader::read_all(scheduler &sched) const
+    {
+        uint8_vector out(_size);
+        read(0, out, sched);
+        return out;
+    }
+}
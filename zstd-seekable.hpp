@@ -0,0 +1,83 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <optional>
+#include "zstd-parallel.hpp"
+
+namespace turbo::zstd {
+    // Seekable files follow zstd's seekable format: a sequence of independent frames followed by a seek table
+    // stored in a skippable frame, so regular zstd decoders still read them as a whole.
+    static constexpr size_t default_seekable_frame_size = size_t { 1 } << 20U;
+
+    // Compresses a stream of data into a seekable file. The file is written under a temporary name
+    // and renamed only by an explicit finish(). A writer destroyed before that, e.g., during stack unwinding,
+    // removes the temporary file, so that an incomplete file is never published.
+    struct seekable_writer {
+        explicit seekable_writer(const std::string &path, int level=3, size_t frame_size=default_seekable_frame_size);
+        seekable_writer(const seekable_writer &) =delete;
+        ~seekable_writer();
+
+        void write(buffer data);
+        void finish();
+    private:
+        std::string _path;
+        std::string _tmp_path;
+        file::write_stream _os;
+        const int _level;
+        const size_t _frame_size;
+        uint8_vector _frame {};
+        uint8_vector _compressed {};
+        uint8_vector _seek_table {};
+        uint32_t _num_frames = 0;
+        bool _finished = false;
+
+        void _write_frame();
+    };
+
+    // compresses the frames on the scheduler's workers; may be called concurrently and from within a task of the same scheduler
+    extern void write_seekable(const std::string &path, buffer data, int level=3, scheduler &sched=scheduler::get(),
+        size_t frame_size=default_seekable_frame_size);
+
+    // Random access to the logical data of a seekable file: only the frames overlapping a requested range are decompressed.
+    struct seekable_reader {
+        struct frame {
+            uint64_t compressed_offset;
+            uint64_t offset;
+            uint32_t compressed_size;
+            uint32_t size;
+        };
+
+        // maps the file; advised for random access since point lookups touch only a few frames
+        explicit seekable_reader(const std::string &path);
+        // the data must stay valid for the lifetime of the reader
+        explicit seekable_reader(buffer data);
+
+        [[nodiscard]] uint64_t size() const noexcept
+        {
+            return _size;
+        }
+
+        [[nodiscard]] const std::vector<frame> &frames() const noexcept
+        {
+            return _frames;
+        }
+
+        // fills the whole buffer with the data starting at offset; throws if the range ends past the data
+        void read(uint64_t offset, write_buffer out) const;
+        // the same as above but the frames are decompressed on the scheduler's workers;
+        // concurrent reads of the same reader may share a scheduler, also from within its tasks
+        void read(uint64_t offset, write_buffer out, scheduler &sched) const;
+        uint8_vector read(uint64_t offset, size_t num_bytes) const;
+        uint8_vector read_all(scheduler &sched=scheduler::get()) const;
+    private:
+        std::optional<file::mmap_view> _mmap {};
+        buffer _data;
+        std::vector<frame> _frames {};
+        uint64_t _size = 0;
+
+        void _parse();
+        size_t _first_frame(uint64_t offset, size_t num_bytes) const;
+        void _read_frame(const frame &f, uint64_t offset, write_buffer out) const;
+    };
+}
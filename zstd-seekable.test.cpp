@@ -0,0 +1,100 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <thread>
+#include <turbo/common/test.hpp>
+#include "zstd-seekable.hpp"
+#include "zstd-stream.hpp"
+
+using namespace turbo;
+
+suite turbo_common_zstd_seekable_suite = [] {
+    "turbo::common::zstd_seekable"_test = [] {
+        const auto data = test_data(800'000);
+        const file::tmp tmp_f { "turbo-zstd-seekable-test.zstd" };
+        "writer"_test = [&] {
+            {
+                zstd::seekable_writer w { tmp_f.path(), 1, 100'000 };
+                for (size_t off = 0; off < data.size(); off += 33'333)
+                    w.write(static_cast<buffer>(data).subbuf(off, std::min(size_t { 33'333 }, data.size() - off)));
+                w.finish();
+            }
+            const zstd::seekable_reader r { tmp_f.path() };
+            expect_equal(static_cast<uint64_t>(data.size()), r.size());
+            expect_equal(size_t { 8 }, r.frames().size());
+            expect_equal(data, r.read(0, data.size()));
+            // regular decoders skip the seek table
+            expect_equal(data, zstd::decompress_all(file::read(tmp_f.path())));
+        };
+        "random access"_test = [&] {
+            const zstd::seekable_reader r { tmp_f.path() };
+            for (const auto &[off, sz]: std::initializer_list<std::pair<uint64_t, size_t>> {
+                { 0, 1 }, { 99'999, 2 }, { 100'000, 100'000 }, { 150'000, 300'000 }, { data.size() - 7, 7 }, { 12345, 0 } })
+            {
+                expect_equal(static_cast<buffer>(data).subbuf(off, sz), r.read(off, sz));
+            }
+            expect(throws([&] { r.read(data.size() - 7, 8); }));
+            expect(throws([&] { r.read(data.size() + 1, 0); }));
+        };
+        "parallel"_test = [&] {
+            scheduler sched { 4 };
+            zstd::write_seekable(tmp_f.path(), data, 1, sched, 65'536);
+            const zstd::seekable_reader r { tmp_f.path() };
+            expect_equal(size_t { 13 }, r.frames().size());
+            expect_equal(data, r.read_all(sched));
+            uint8_vector part(200'001);
+            r.read(123'457, part, sched);
+            expect_equal(static_cast<buffer>(data).subbuf(123'457, part.size()), part);
+            // concurrent readers share the reader and the scheduler
+            std::atomic_size_t num_ok = 0;
+            std::vector<std::thread> threads {};
+            for (size_t t = 0; t < 4; ++t) {
+                threads.emplace_back([&, t] {
+                    for (size_t i = 0; i < 16; ++i) {
+                        const auto off = (t * 16 + i) * 3'001;
+                        uint8_vector out(150'000);
+                        r.read(off, out, sched);
+                        if (out == static_cast<buffer>(data).subbuf(off, out.size()))
+                            num_ok.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+            }
+            for (auto &th: threads)
+                th.join();
+            expect_equal(size_t { 64 }, num_ok.load());
+        };
+        "empty"_test = [&] {
+            {
+                zstd::seekable_writer w { tmp_f.path() };
+                w.finish();
+            }
+            const zstd::seekable_reader r { tmp_f.path() };
+            expect_equal(uint64_t { 0 }, r.size());
+            expect(r.frames().empty());
+            expect(r.read(0, 0).empty());
+        };
+        "errors"_test = [&] {
+            expect(throws([] { zstd::seekable_reader { zstd::compress(std::string_view { "some text" }, 3) }; }));
+            zstd::write_seekable(tmp_f.path(), data, 1, scheduler::get(), 65'536);
+            auto bytes = file::read(tmp_f.path());
+            bytes[bytes.size() - 5] ^= 0x04;
+            expect(throws([&] { zstd::seekable_reader { bytes }; }));
+            bytes[bytes.size() - 5] ^= 0x04;
+            bytes[bytes.size() - 9] ^= 0x01;
+            expect(throws([&] { zstd::seekable_reader { bytes }; }));
+            expect(throws([&] { zstd::seekable_writer { tmp_f.path(), 3, 0 }; }));
+            expect(!std::filesystem::exists(tmp_f.path() + ".tmp"));
+        };
+        "unfinished"_test = [&] {
+            // a writer abandoned by an exception does not replace the existing file
+            const auto prev = file::read(tmp_f.path());
+            expect(throws([&] {
+                zstd::seekable_writer w { tmp_f.path(), 1, 1000 };
+                w.write(static_cast<buffer>(data).subbuf(0, 5000));
+                throw error("interrupted");
+            }));
+            expect(file::read(tmp_f.path()) == prev);
+            expect(!std::filesystem::exists(tmp_f.path() + ".tmp"));
+        };
+    };
+};
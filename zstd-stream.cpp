@@ -0,0 +1,196 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <cstring>
+#include <exception>
+#include "logger.hpp"
+#include "zstd-stream.hpp"
+
+namespace turbo::zstd {
+    namespace {
+        // a failure removes the temporary file, so that neither it nor a partial result at dst_path is left behind
+        template<typename F>
+        void write_via_tmp(const std::string &dst_path, const F &write)
+        {
+            const auto tmp_path = fmt::format("{}.tmp", dst_path);
+            try {
+                {
+                    file::write_stream os { tmp_path };
+                    write(os);
+                }
+                std::filesystem::rename(tmp_path, dst_path);
+            } catch (...) {
+                std::error_code ec {};
+                std::filesystem::remove(tmp_path, ec);
+                throw;
+            }
+        }
+    }
+
+    compress_stream::compress_stream(sink_t sink, const int level):
+        _sink { std::move(sink) }, _out(ZSTD_CStreamOutSize())
+    {
+        _ctx.set_level(level);
+    }
+
+    compress_stream::compress_stream(file::write_stream &os, const int level):
+        compress_stream { [&os](const buffer chunk) { os.write(chunk); }, level }
+    {
+    }
+
+    compress_stream::~compress_stream()
+    {
+        // a frame finished during unwinding would make the truncated data look complete
+        if (std::uncaught_exceptions() > _uncaught_exceptions)
+            return;
+        logger::run_log_errors([&] {
+            if (_frame_open)
+                finish();
+        });
+    }
+
+    void compress_stream::write(const buffer data)
+    {
+        if (data.empty())
+            return;
+        ZSTD_inBuffer in { data.data(), data.size(), 0 };
+        while (in.pos < in.size) {
+            ZSTD_outBuffer out { _out.data(), _out.size(), 0 };
+            const auto res = ZSTD_compressStream2(_ctx.get(), &out, &in, ZSTD_e_continue);
+            if (ZSTD_isError(res)) [[unlikely]]
+                throw error(fmt::format("zstd compression error: {}", ZSTD_getErrorName(res)));
+            if (out.pos) {
+                _bytes_out += out.pos;
+                _sink(buffer { _out.data(), out.pos });
+            }
+        }
+        _bytes_in += data.size();
+        _frame_open = true;
+    }
+
+    void compress_stream::write(const buffer_chain &chain)
+    {
+        for (const auto &s: chain)
+            write(s.data);
+    }
+
+    void compress_stream::flush()
+    {
+        _end(ZSTD_e_flush);
+    }
+
+    void compress_stream::finish()
+    {
+        _end(ZSTD_e_end);
+        _frame_open = false;
+    }
+
+    void compress_stream::_end(const ZSTD_EndDirective mode)
+    {
+        ZSTD_inBuffer in { nullptr, 0, 0 };
+        for (;;) {
+            ZSTD_outBuffer out { _out.data(), _out.size(), 0 };
+            // the result is the number of bytes that are still to be flushed
+            const auto left = ZSTD_compressStream2(_ctx.get(), &out, &in, mode);
+            if (ZSTD_isError(left)) [[unlikely]]
+                throw error(fmt::format("zstd compression error: {}", ZSTD_getErrorName(left)));
+            if (out.pos) {
+                _bytes_out += out.pos;
+                _sink(buffer { _out.data(), out.pos });
+            }
+            if (left == 0)
+                break;
+        }
+    }
+
+    decompress_stream::decompress_stream(source_t source):
+        _source { std::move(source) }, _in_buf(ZSTD_DStreamInSize())
+    {
+    }
+
+    decompress_stream::decompress_stream(file::read_stream &is):
+        decompress_stream { [&is](const write_buffer buf) { return is.try_read(buf); } }
+    {
+    }
+
+    decompress_stream::decompress_stream(const buffer compressed):
+        _in { compressed.data(), compressed.size(), 0 }, _source_eof { true }
+    {
+    }
+
+    size_t decompress_stream::try_read(const write_buffer buf)
+    {
+        ZSTD_outBuffer out { buf.data(), buf.size(), 0 };
+        while (out.pos < out.size && !_eof) {
+            if (_in.pos == _in.size && !_source_eof) {
+                const auto num_read = _source(_in_buf);
+                _source_eof = num_read == 0;
+                _in = { _in_buf.data(), num_read, 0 };
+            }
+            const auto prev_in = _in.pos;
+            const auto prev_out = out.pos;
+            // continues with the next frame once the current one is complete
+            const auto res = ZSTD_decompressStream(_ctx.get(), &out, &_in);
+            if (ZSTD_isError(res)) [[unlikely]]
+                throw error(fmt::format("zstd decompression error: {}", ZSTD_getErrorName(res)));
+            if (_in.pos != prev_in || out.pos != prev_out)
+                _frame_done = res == 0;
+            else if (_source_eof && _in.pos == _in.size) {
+                if (!_frame_done) [[unlikely]]
+                    throw error("zstd decompression error: the compressed data is truncated");
+                _eof = true;
+            }
+        }
+        return out.pos;
+    }
+
+    void decompress_stream::read(void *data, const size_t num_bytes)
+    {
+        if (const auto num_read = try_read(write_buffer { static_cast<uint8_t *>(data), num_bytes }); num_read != num_bytes) [[unlikely]]
+            throw error(fmt::format("could decompress only {} bytes instead of {}", num_read, num_bytes));
+    }
+
+    void decompress_stream::read_all(uint8_vector &out, const size_t max_size)
+    {
+        const auto chunk_size = ZSTD_DStreamOutSize();
+        const auto start_size = out.size();
+        while (!_eof) {
+            const auto prev_size = out.size();
+            out.resize(prev_size + chunk_size);
+            out.resize(prev_size + try_read(write_buffer { out.data() + prev_size, chunk_size }));
+            if (out.size() - start_size > max_size) [[unlikely]]
+                throw error(fmt::format("decompressed data size {} is greater than the maximum allowed: {}!", out.size() - start_size, max_size));
+        }
+    }
+
+    uint8_vector decompress_all(const buffer compressed, const size_t max_size)
+    {
+        uint8_vector out {};
+        decompress_stream ds { compressed };
+        ds.read_all(out, max_size);
+        return out;
+    }
+
+    void compress_file(const std::string &src_path, const std::string &dst_path, const int level)
+    {
+        file::read_stream is { src_path };
+        write_via_tmp(dst_path, [&](file::write_stream &os) {
+            compress_stream cs { os, level };
+            uint8_vector buf(ZSTD_CStreamInSize());
+            while (const auto num_read = is.try_read(buf))
+                cs.write(buffer { buf.data(), num_read });
+            cs.finish();
+        });
+    }
+
+    void decompress_file(const std::string &src_path, const std::string &dst_path)
+    {
+        file::read_stream is { src_path };
+        write_via_tmp(dst_path, [&](file::write_stream &os) {
+            decompress_stream ds { is };
+            uint8_vector buf(ZSTD_DStreamOutSize());
+            while (const auto num_read = ds.try_read(buf))
+                os.write(buf.data(), num_read);
+        });
+    }
+}
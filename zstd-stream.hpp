@@ -0,0 +1,88 @@
+#pragma once
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <exception>
+#include <functional>
+#include <limits>
+#include "buffer-chain.hpp"
+#include "zstd.hpp"
+
+namespace turbo::zstd {
+    // Compresses data of any size with constant memory, passing the output to the sink in chunks
+    // of at most ZSTD_CStreamOutSize bytes. Each finish() completes a frame, so a stream can produce
+    // a sequence of frames. The destructor finishes the current frame if there is one unless it runs
+    // during the unwinding of an exception, so that a failed producer does not leave a valid frame of partial data.
+    struct compress_stream {
+        using sink_t = std::function<void(buffer)>;
+
+        explicit compress_stream(sink_t sink, int level=3);
+        explicit compress_stream(file::write_stream &os, int level=3);
+        compress_stream(const compress_stream &) =delete;
+        ~compress_stream();
+
+        void write(buffer data);
+        void write(const buffer_chain &chain);
+        // makes all data written so far decompressable without ending the frame
+        void flush();
+        void finish();
+
+        [[nodiscard]] uint64_t bytes_in() const noexcept
+        {
+            return _bytes_in;
+        }
+
+        [[nodiscard]] uint64_t bytes_out() const noexcept
+        {
+            return _bytes_out;
+        }
+    private:
+        compress_context _ctx {};
+        sink_t _sink;
+        uint8_vector _out;
+        uint64_t _bytes_in = 0;
+        uint64_t _bytes_out = 0;
+        bool _frame_open = false;
+        const int _uncaught_exceptions = std::uncaught_exceptions();
+
+        void _end(ZSTD_EndDirective mode);
+    };
+
+    // Decompresses a sequence of one or more frames, with or without a recorded content size,
+    // pulling the compressed data from the source in chunks of ZSTD_DStreamInSize bytes.
+    struct decompress_stream {
+        // returns the number of bytes placed into the buffer, zero at the end of the input
+        using source_t = std::function<size_t(write_buffer)>;
+
+        explicit decompress_stream(source_t source);
+        explicit decompress_stream(file::read_stream &is);
+        // the data must stay valid for the lifetime of the stream
+        explicit decompress_stream(buffer compressed);
+        decompress_stream(const decompress_stream &) =delete;
+
+        [[nodiscard]] bool eof() const noexcept
+        {
+            return _eof;
+        }
+
+        // fills the buffer unless the end of the data is reached; returns the number of bytes placed into it
+        size_t try_read(write_buffer out);
+        void read(void *data, size_t num_bytes);
+        // appends all remaining decompressed data to out; throws once more than max_size bytes have been decompressed
+        void read_all(uint8_vector &out, size_t max_size=std::numeric_limits<size_t>::max());
+    private:
+        decompress_context _ctx {};
+        source_t _source {};
+        uint8_vector _in_buf {};
+        ZSTD_inBuffer _in { nullptr, 0, 0 };
+        bool _source_eof = false;
+        bool _frame_done = true;
+        bool _eof = false;
+    };
+
+    // decompresses data which may consist of several frames and which may not record its content size;
+    // since the size is not known in advance, max_size is enforced while the data is being decompressed
+    extern uint8_vector decompress_all(buffer compressed, size_t max_size=std::numeric_limits<size_t>::max());
+    extern void compress_file(const std::string &src_path, const std::string &dst_path, int level=3);
+    extern void decompress_file(const std::string &src_path, const std::string &dst_path);
+}
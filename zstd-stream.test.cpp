@@ -0,0 +1,107 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include <turbo/common/test.hpp>
+#include "zstd-stream.hpp"
+
+using namespace turbo;
+
+suite turbo_common_zstd_stream_suite = [] {
+    "turbo::common::zstd_stream"_test = [] {
+        const auto data = test_data(8'000'000);
+        "round trip"_test = [&] {
+            uint8_vector compressed {};
+            {
+                zstd::compress_stream cs { [&](const buffer chunk) { compressed << chunk; }, 1 };
+                // uneven writes spanning the internal buffers
+                for (size_t off = 0; off < data.size(); off += 100'003)
+                    cs.write(static_cast<buffer>(data).subbuf(off, std::min(size_t { 100'003 }, data.size() - off)));
+                cs.finish();
+                expect_equal(static_cast<uint64_t>(data.size()), cs.bytes_in());
+                expect_equal(static_cast<uint64_t>(compressed.size()), cs.bytes_out());
+            }
+            // streamed frames do not record their content size
+            expect(throws([&] { zstd::decompress(compressed); }));
+            expect(zstd::decompress_all(compressed) == data);
+            zstd::decompress_stream ds { compressed };
+            uint8_vector out(data.size());
+            for (size_t off = 0; off < out.size(); off += 77'777)
+                ds.read(out.data() + off, std::min(size_t { 77'777 }, out.size() - off));
+            expect(out == data);
+            uint8_t extra;
+            expect_equal(size_t { 0 }, ds.try_read(write_buffer { &extra, 1 }));
+            expect(ds.eof());
+        };
+        "multiple frames"_test = [&] {
+            uint8_vector compressed {};
+            {
+                zstd::compress_stream cs { [&](const buffer chunk) { compressed << chunk; } };
+                cs.write(static_cast<buffer>(data).subbuf(0, 1000));
+                cs.finish();
+                cs.write(static_cast<buffer>(data).subbuf(1000, 2000));
+                // the destructor finishes the second frame
+            }
+            // whole-buffer frames mixed with streamed ones
+            compressed << zstd::compress(static_cast<buffer>(data).subbuf(3000, 5000), 3);
+            expect(zstd::decompress_all(compressed) == uint8_vector { static_cast<buffer>(data).subbuf(0, 8000) });
+        };
+        "flush"_test = [&] {
+            uint8_vector compressed {};
+            zstd::compress_stream cs { [&](const buffer chunk) { compressed << chunk; } };
+            cs.write(static_cast<buffer>(data).subbuf(0, 4096));
+            cs.flush();
+            zstd::decompress_stream ds { compressed };
+            uint8_vector out(4096);
+            ds.read(out.data(), out.size());
+            expect(out == uint8_vector { static_cast<buffer>(data).subbuf(0, 4096) });
+            // the frame is not finished yet
+            expect(throws([&] { ds.try_read(out); }));
+        };
+        "files"_test = [&] {
+            const file::tmp raw_f { "turbo-zstd-stream-raw.bin" };
+            const file::tmp compressed_f { "turbo-zstd-stream-compressed.zstd" };
+            const file::tmp out_f { "turbo-zstd-stream-out.bin" };
+            file::write(raw_f.path(), data);
+            zstd::compress_file(raw_f.path(), compressed_f.path(), 3);
+            zstd::decompress_file(compressed_f.path(), out_f.path());
+            expect(file::read(out_f.path()) == data);
+            file::read_stream is { compressed_f.path() };
+            zstd::decompress_stream ds { is };
+            uint8_vector out {};
+            ds.read_all(out);
+            expect(out == data);
+            // a failure leaves neither the output nor its temporary file
+            const file::tmp bad_out_f { "turbo-zstd-stream-bad-out.bin" };
+            expect(throws([&] { zstd::decompress_file(raw_f.path(), bad_out_f.path()); }));
+            expect(!std::filesystem::exists(bad_out_f.path()));
+            expect(!std::filesystem::exists(bad_out_f.path() + ".tmp"));
+        };
+        "producer failure"_test = [&] {
+            // an exception leaves the frame unfinished, so the truncated data cannot pass for complete
+            uint8_vector compressed {};
+            expect(throws([&] {
+                zstd::compress_stream cs { [&](const buffer chunk) { compressed << chunk; }, 1 };
+                cs.write(static_cast<buffer>(data).subbuf(0, 100'000));
+                cs.flush();
+                throw error("producer failure");
+            }));
+            expect(!compressed.empty());
+            expect(throws([&] { zstd::decompress_all(compressed); }));
+            // empty writes do not start a frame
+            uint8_vector empty {};
+            {
+                zstd::compress_stream cs { [&](const buffer chunk) { empty << chunk; } };
+                cs.write(buffer {});
+            }
+            expect(empty.empty());
+        };
+        "errors"_test = [&] {
+            auto compressed = zstd::compress(static_cast<buffer>(data).subbuf(0, 100'000), 3);
+            compressed.resize(compressed.size() / 2);
+            expect(throws([&] { zstd::decompress_all(compressed); }));
+            const uint8_vector garbage(100, 0x55);
+            expect(throws([&] { zstd::decompress_all(garbage); }));
+            expect(zstd::decompress_all(uint8_vector {}).empty());
+        };
+    };
+};
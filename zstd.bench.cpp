@@ -1,8 +1,11 @@
 /* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
- * Copyright (c) 2024-2025 R2 Rationality OÜ (info at r2rationality dot com) */
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
 
 #include <turbo/common/benchmark.hpp>
-#include "zstd.hpp"
+#include "zstd-dict.hpp"
+#include "zstd-parallel.hpp"
+#include "zstd-seekable.hpp"
+#include "zstd-stream.hpp"
 
 using namespace turbo;
 
@@ -36,9 +39,119 @@ suite zstd_bench_suite = [] {
         benchmark("zstd::read", [] {
             ankerl::nanobench::doNotOptimizeAway(zstd::read("./data/chunk-registry/compressed/chunk/977E9BB3D15A5CFF5C5E48617288C5A731DB654C0B42D63627C690CEADC9E1F3.zstd"));
         }, data.size());
+        // a fresh output per run, so that both variants pay for the page faults of a new allocation
+        benchmark("zstd::read into default_init_uint8_vector", [] {
+            default_init_uint8_vector out {};
+            zstd::read("./data/chunk-registry/compressed/chunk/977E9BB3D15A5CFF5C5E48617288C5A731DB654C0B42D63627C690CEADC9E1F3.zstd", out);
+            ankerl::nanobench::doNotOptimizeAway(out);
+        }, data.size());
         file::tmp tmp_f { "zstd-write.tmp" };
         benchmark("zstd::write", [&] {
             zstd::write(tmp_f.path(), data);
         }, data.size());
+        benchmark("zstd::compress_stream level 3", [&] {
+            uint64_t compressed_size = 0;
+            zstd::compress_stream cs { [&](const buffer chunk) { compressed_size += chunk.size(); }, 3 };
+            cs.write(data);
+            cs.finish();
+            ankerl::nanobench::doNotOptimizeAway(compressed_size);
+        }, data.size());
+        // decompresses the output of the streaming compressor
+        uint8_vector streamed {};
+        {
+            zstd::compress_stream cs { [&](const buffer chunk) { streamed << chunk; }, 3 };
+            cs.write(data);
+            cs.finish();
+        }
+        benchmark("zstd::decompress_stream", [&] {
+            zstd::decompress_stream ds { streamed };
+            uint8_vector chunk(ZSTD_DStreamOutSize());
+            while (ds.try_read(chunk) > 0)
+                ankerl::nanobench::doNotOptimizeAway(chunk);
+        }, data.size());
+        {
+            file::tmp seekable_f { "zstd-seekable.tmp" };
+            zstd::write_seekable(seekable_f.path(), data, 3);
+            zstd::write(tmp_f.path(), data);
+            const zstd::seekable_reader reader { seekable_f.path() };
+            uint8_vector record(256);
+            uint64_t offset = 0;
+            benchmark("zstd::seekable_reader point lookup", [&] {
+                offset = (offset + 7'777'777) % (data.size() - record.size());
+                reader.read(offset, record);
+            });
+            benchmark("zstd::read point lookup", [&] {
+                offset = (offset + 7'777'777) % (data.size() - record.size());
+                const auto all = zstd::read(tmp_f.path());
+                memcpy(record.data(), all.data() + offset, record.size());
+            });
+        }
+        {
+            static constexpr size_t record_size = 2048;
+            std::vector<buffer> records {};
+            for (size_t off = 0; off + record_size <= data.size(); off += record_size)
+                records.emplace_back(static_cast<buffer>(data).subbuf(off, record_size));
+            const auto dict = zstd::dictionary::train(records, zstd::dictionary::default_max_size, 3);
+            uint64_t plain_size = 0, dict_size = 0;
+            for (const auto &r: records) {
+                plain_size += zstd::compress(r, 3).size();
+                dict_size += zstd::compress(r, dict).size();
+            }
+            logger::info("zstd {}-byte records: ratio without a dictionary: {:0.2f} with a dictionary: {:0.2f}", record_size,
+                static_cast<double>(records.size() * record_size) / plain_size, static_cast<double>(records.size() * record_size) / dict_size);
+            uint8_vector compressed {};
+            benchmark("zstd::compress small records level 3", [&] {
+                for (const auto &r: records)
+                    zstd::compress(compressed, r, 3);
+            }, records.size() * record_size);
+            benchmark("zstd::compress small records with dictionary level 3", [&] {
+                for (const auto &r: records)
+                    zstd::compress(compressed, r, dict);
+            }, records.size() * record_size);
+            std::vector<uint8_vector> plain {}, with_dict {};
+            for (const auto &r: records) {
+                plain.emplace_back(zstd::compress(r, 3));
+                with_dict.emplace_back(zstd::compress(r, dict));
+            }
+            benchmark("zstd::decompress small records", [&] {
+                uint8_vector out_data {};
+                for (const auto &c: plain)
+                    zstd::decompress(out_data, c);
+            }, records.size() * record_size);
+            benchmark("zstd::decompress small records with dictionary", [&] {
+                uint8_vector out_data {};
+                for (const auto &c: with_dict)
+                    zstd::decompress(out_data, c, dict);
+            }, records.size() * record_size);
+        }
+        {
+            const auto small = static_cast<buffer>(data).subbuf(0, 4096);
+            uint8_vector compressed {};
+            zstd::compress_context thread_ctx {};
+            benchmark("zstd 4 KiB level 3 context reset and set_level", [&] {
+                compressed.resize(ZSTD_compressBound(small.size()));
+                thread_ctx.reset();
+                thread_ctx.set_level(3);
+                ankerl::nanobench::doNotOptimizeAway(ZSTD_compress2(thread_ctx.get(), compressed.data(), compressed.size(), small.data(), small.size()));
+            }, small.size());
+            benchmark("zstd::compress_with 4 KiB level 3 pooled context", [&] {
+                zstd::compress_with(compressed, small, zstd::compress_params { .level=3 });
+            }, small.size());
+            benchmark("zstd::compress_with 4 KiB level 3 long distance", [&] {
+                zstd::compress_with(compressed, small, zstd::compress_params { .level=3, .window_log=27, .long_distance=true });
+            }, small.size());
+            logger::info("zstd context pool: {}", zstd::context_pool::get().stats());
+        }
+        for (const size_t num_workers: { 1, 2, 4, 8, 16, 32 }) {
+            scheduler sched { num_workers };
+            uint8_vector compressed {};
+            benchmark(fmt::format("zstd::compress_parallel level 22 workers {}", num_workers), [&] {
+                zstd::compress_parallel(compressed, data, 22, sched);
+            }, data.size());
+            benchmark(fmt::format("zstd::decompress_parallel workers {}", num_workers), [&] {
+                uint8_vector out_data {};
+                zstd::decompress_parallel(out_data, compressed, sched);
+            }, data.size());
+        }
     };
 };
\ No newline at end of file
@@ -0,0 +1,109 @@
+/* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
+
+#include "logger.hpp"
+#include "zstd.hpp"
+
+namespace turbo::zstd {
+    context_pool::lease::~lease()
+    {
+        logger::run_log_errors([&] {
+            _pool._release(_params, std::move(_ctx));
+        });
+    }
+
+    context_pool::context_pool(const size_t max_idle_memory):
+        _max_idle_memory { max_idle_memory }
+    {
+    }
+
+    context_pool::lease context_pool::acquire(const compress_params &params)
+    {
+        std::unique_ptr<compress_context> ctx {};
+        {
+            mutex::scoped_lock lk { _mutex };
+            // the most recently returned context is the most likely to be still in the CPU caches
+            for (auto it = _idle.rbegin(); it != _idle.rend(); ++it) {
+                if (it->params == params) {
+                    ctx = std::move(it->ctx);
+                    _stats.idle_memory -= it->memory;
+                    --_stats.idle;
+                    ++_stats.reused;
+                    _idle.erase(std::next(it).base());
+                    break;
+                }
+            }
+        }
+        if (ctx) {
+            // keeps the parameters, so only the session needs to be reset
+            ctx->reset();
+        } else {
+            ctx = std::make_unique<compress_context>();
+            ctx->set_level(params.level);
+            if (params.window_log)
+                ctx->set_parameter(ZSTD_c_windowLog, params.window_log);
+            if (params.long_distance)
+                ctx->set_parameter(ZSTD_c_enableLongDistanceMatching, 1);
+            if (params.strategy)
+                ctx->set_parameter(ZSTD_c_strategy, params.strategy);
+            mutex::scoped_lock lk { _mutex };
+            ++_stats.created;
+        }
+        return { *this, params, std::move(ctx) };
+    }
+
+    void context_pool::clear()
+    {
+        mutex::scoped_lock lk { _mutex };
+        _stats.evicted += _idle.size();
+        _stats.idle = 0;
+        _stats.idle_memory = 0;
+        _idle.clear();
+    }
+
+    context_pool::stats_t context_pool::stats() const
+    {
+        mutex::scoped_lock lk { _mutex };
+        return _stats;
+    }
+
+    void context_pool::_release(const compress_params &params, std::unique_ptr<compress_context> ctx)
+    {
+        if (!ctx)
+            return;
+        const auto memory = ZSTD_sizeof_CCtx(ctx->get());
+        // the evicted contexts are freed once the lock is released
+        std::vector<idle_context> evicted {};
+        {
+            mutex::scoped_lock lk { _mutex };
+            if (memory > _max_idle_memory) {
+                ++_stats.evicted;
+            } else {
+                size_t num_evicted = 0;
+                while (_stats.idle_memory + memory > _max_idle_memory)
+                    _stats.idle_memory -= _idle[num_evicted++].memory;
+                if (num_evicted) {
+                    evicted.reserve(num_evicted);
+                    std::move(_idle.begin(), _idle.begin() + num_evicted, std::back_inserter(evicted));
+                    _idle.erase(_idle.begin(), _idle.begin() + num_evicted);
+                    _stats.evicted += num_evicted;
+                }
+                _idle.emplace_back(params, std::move(ctx), memory);
+                _stats.idle = _idle.size();
+                _stats.idle_memory += memory;
+            }
+        }
+    }
+
+    void compress_with(uint8_vector &compressed, const buffer &orig, const compress_params &params, const size_t max_buffer)
+    {
+        if (orig.size() > max_buffer)
+            throw error(fmt::format("data size {} is greater than the maximum allowed: {}!", orig.size(), max_buffer));
+        compressed.resize(ZSTD_compressBound(orig.size()));
+        const auto ctx = context_pool::get().acquire(params);
+        const size_t compressed_size = ZSTD_compress2(ctx.get(), compressed.data(), compressed.size(), reinterpret_cast<const void *>(orig.data()), orig.size());
+        if (ZSTD_isError(compressed_size))
+            throw error(fmt::format("zstd compression error: {}", ZSTD_getErrorName(compressed_size)));
+        compressed.resize(compressed_size);
+    }
+}
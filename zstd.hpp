@@ -1,12 +1,14 @@
 #pragma once
 /* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
- * Copyright (c) 2024-2025 R2 Rationality OÜ (info at r2rationality dot com) */
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
 
 extern "C" {
 #   include <zstd.h>
 #   include <zstd_errors.h>
 };
 #include "file.hpp"
+#include <memory>
+#include "mutex.hpp"
 
 namespace turbo::zstd {
     static constexpr size_t max_zstd_buffer = static_cast<size_t>(1) << 28;
@@ -41,10 +43,100 @@ namespace turbo::zstd {
             if (ZSTD_isError(res))
                 throw error(fmt::format("ZSTD: failed to change the compression level to {}: {}", level, ZSTD_getErrorName(res)));
         }
+
+        void set_parameter(ZSTD_cParameter param, int value)
+        {
+            auto res = ZSTD_CCtx_setParameter(_ctx, param, value);
+            if (ZSTD_isError(res))
+                throw error(fmt::format("ZSTD: failed to set compression parameter {} to {}: {}", static_cast<int>(param), value, ZSTD_getErrorName(res)));
+        }
     private:
         ZSTD_CCtx* _ctx;
     };
 
+    struct compress_params {
+        int level = 22;
+        // zero keeps the default of the level
+        int window_log = 0;
+        bool long_distance = false;
+        // zero keeps the default of the level, otherwise one of ZSTD_strategy
+        int strategy = 0;
+
+        auto operator<=>(const compress_params &) const =default;
+    };
+
+    // Keeps the idle compression contexts of each parameter set, so that a call only resets the session
+    // instead of setting up a context, and so that the memory of high-level contexts is bounded
+    // instead of being held by every thread that ever compressed at that level.
+    // Once the memory of idle contexts exceeds the limit, the least recently returned ones are freed.
+    struct context_pool {
+        static constexpr size_t default_max_idle_memory = size_t { 1 } << 28U;
+
+        struct stats_t {
+            size_t created = 0;
+            size_t reused = 0;
+            size_t evicted = 0;
+            size_t idle = 0;
+            size_t idle_memory = 0;
+        };
+
+        // returns the context to the pool when destroyed
+        struct lease {
+            lease(context_pool &pool, const compress_params &params, std::unique_ptr<compress_context> ctx):
+                _pool { pool }, _params { params }, _ctx { std::move(ctx) }
+            {
+            }
+
+            lease(const lease &) =delete;
+            ~lease();
+
+            ZSTD_CCtx *get() const
+            {
+                return _ctx->get();
+            }
+        private:
+            context_pool &_pool;
+            const compress_params _params;
+            std::unique_ptr<compress_context> _ctx;
+        };
+
+        static context_pool &get()
+        {
+            static context_pool pool {};
+            return pool;
+        }
+
+        explicit context_pool(size_t max_idle_memory=default_max_idle_memory);
+        context_pool(const context_pool &) =delete;
+
+        // the context has the parameters applied and its session reset
+        [[nodiscard]] lease acquire(const compress_params &params);
+        void clear();
+        [[nodiscard]] stats_t stats() const;
+
+        [[nodiscard]] size_t max_idle_memory() const noexcept
+        {
+            return _max_idle_memory;
+        }
+    private:
+        struct idle_context {
+            compress_params params;
+            std::unique_ptr<compress_context> ctx;
+            size_t memory;
+        };
+
+        const size_t _max_idle_memory;
+        mutable mutex::unique_lock::mutex_type _mutex alignas(mutex::alignment) {};
+        // ordered from the least to the most recently returned
+        std::vector<idle_context> _idle {};
+        stats_t _stats {};
+
+        void _release(const compress_params &params, std::unique_ptr<compress_context> ctx);
+    };
+
+    // compresses with a context from context_pool::get()
+    extern void compress_with(uint8_vector &compressed, const buffer &orig, const compress_params &params, size_t max_buffer=max_zstd_buffer);
+
     struct decompress_context {
         decompress_context(): _ctx { ZSTD_createDCtx() }
         {
@@ -74,16 +166,7 @@ namespace turbo::zstd {
 
     inline void compress(uint8_vector &compressed, const buffer &orig, const int level=22, const size_t max_buffer=max_zstd_buffer)
     {
-        if (orig.size() > max_buffer)
-            throw error(fmt::format("data size {} is greater than the maximum allowed: {}!", orig.size(), max_buffer));
-        compressed.resize(ZSTD_compressBound(orig.size()));
-        thread_local compress_context ctx {};
-        ctx.reset();
-        ctx.set_level(level);
-        const size_t compressed_size = ZSTD_compress2(ctx.get(), compressed.data(), compressed.size(), reinterpret_cast<const void *>(orig.data()), orig.size());
-        if (ZSTD_isError(compressed_size))
-            throw error(fmt::format("zstd compression error: {}", ZSTD_getErrorName(compressed_size)));
-        compressed.resize(compressed_size);
+        compress_with(compressed, orig, compress_params { .level=level }, max_buffer);
     }
 
     inline uint8_vector compress(const buffer &orig, int level=22)
@@ -161,7 +244,14 @@ namespace turbo::zstd {
 
     inline void read(const std::string &path, uint8_vector &out)
     {
-        const auto compressed = file::read(path);
+        const file::mmap_view compressed { path, file::access_advice::sequential };
+        decompress(out, compressed);
+    }
+
+    // decompresses into a buffer that is not zero-filled beforehand
+    inline void read(const std::string &path, default_init_uint8_vector &out)
+    {
+        const file::mmap_view compressed { path, file::access_advice::sequential };
         decompress(out, compressed);
     }
 
@@ -176,4 +266,14 @@ namespace turbo::zstd {
     {
         file::write(path, compress(buffer, level));
     }
+}
+
+namespace fmt {
+    template<>
+    struct formatter<turbo::zstd::context_pool::stats_t>: formatter<int> {
+        template<typename FormatContext>
+        auto format(const auto &v, FormatContext &ctx) const -> decltype(ctx.out()) {
+            return fmt::format_to(ctx.out(), "created: {} reused: {} evicted: {} idle: {} idle_memory: {}", v.created, v.reused, v.evicted, v.idle, v.idle_memory);
+        }
+    };
 }
\ No newline at end of file
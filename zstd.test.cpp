@@ -1,5 +1,5 @@
 /* Copyright (c) 2022-2023 Alex Sierkov (alex dot sierkov at gmail dot com)
- * Copyright (c) 2024-2025 R2 Rationality OÜ (info at r2rationality dot com) */
+ * Copyright (c) 2024-2026 R2 Rationality OÜ (info at r2rationality dot com) */
 
 #include <turbo/common/test.hpp>
 #include "zstd.hpp"
@@ -41,6 +41,19 @@ suite turbo_common_zstd_suite = [] {
             auto decompressed = zstd::decompress(compressed);
             expect(decompressed == raw);
         };
+        "read/write"_test = [] {
+            const file::tmp tmp_f { "turbo-zstd-read-write.zstd" };
+            uint8_vector raw {};
+            for (size_t i = 0; i < 100'000; ++i)
+                raw << buffer::from(i);
+            zstd::write(tmp_f.path(), raw);
+            expect(zstd::read(tmp_f.path()) == raw);
+            default_init_uint8_vector out {};
+            zstd::read(tmp_f.path(), out);
+            expect(out == raw);
+            file::read(tmp_f.path(), out);
+            expect(out == zstd::compress(raw, 3));
+        };
         "errors"_test = [&] {
             uint8_vector out {};
             compressed.clear();
@@ -58,5 +71,65 @@ suite turbo_common_zstd_suite = [] {
              byte_array<13> buf_too_big {};
             expect(throws([&] { zstd::decompress(buf_too_big, compressed); }));
         };
+        "compress_with"_test = [] {
+            uint8_vector raw {};
+            for (size_t i = 0; i < 100'000; ++i)
+                raw << buffer::from(i);
+            for (const auto &params: {
+                zstd::compress_params { .level=1 },
+                zstd::compress_params { .level=3, .window_log=20 },
+                zstd::compress_params { .level=3, .long_distance=true },
+                zstd::compress_params { .level=5, .strategy=ZSTD_btlazy2 }
+            }) {
+                uint8_vector compressed {};
+                zstd::compress_with(compressed, raw, params);
+                expect_equal(raw, zstd::decompress(compressed));
+            }
+            uint8_vector compressed {};
+            expect(throws([&] { zstd::compress_with(compressed, raw, zstd::compress_params { .level=3, .window_log=100 }); }));
+        };
+        "context_pool"_test = [] {
+            zstd::context_pool pool {};
+            const zstd::compress_params p1 { .level=1 };
+            const zstd::compress_params p3 { .level=3 };
+            {
+                const auto ctx1 = pool.acquire(p1);
+                const auto ctx2 = pool.acquire(p1);
+                expect(ctx1.get() != ctx2.get());
+            }
+            expect_equal(size_t { 2 }, pool.stats().created);
+            expect_equal(size_t { 2 }, pool.stats().idle);
+            {
+                const auto ctx = pool.acquire(p1);
+                expect_equal(size_t { 1 }, pool.stats().reused);
+                const auto ctx3 = pool.acquire(p3);
+                expect_equal(size_t { 3 }, pool.stats().created);
+            }
+            pool.clear();
+            expect_equal(size_t { 0 }, pool.stats().idle);
+            expect_equal(size_t { 0 }, pool.stats().idle_memory);
+        };
+        "context_pool memory limit"_test = [] {
+            zstd::context_pool pool { 1 };
+            {
+                const auto ctx = pool.acquire(zstd::compress_params { .level=1 });
+            }
+            // a context never fits into a one-byte budget
+            expect_equal(size_t { 0 }, pool.stats().idle);
+            expect_equal(size_t { 1 }, pool.stats().evicted);
+            zstd::context_pool pool2 {};
+            {
+                const auto ctx = pool2.acquire(zstd::compress_params { .level=1 });
+            }
+            const auto one_ctx = pool2.stats().idle_memory;
+            expect(one_ctx > 0_ull);
+            zstd::context_pool pool3 { one_ctx };
+            {
+                const auto ctx1 = pool3.acquire(zstd::compress_params { .level=1 });
+                const auto ctx2 = pool3.acquire(zstd::compress_params { .level=1 });
+            }
+            expect_equal(size_t { 1 }, pool3.stats().idle);
+            expect_equal(size_t { 1 }, pool3.stats().evicted);
+        };
     };
 };
\ No newline at end of file